@@ -0,0 +1,247 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "benchmark.hpp"
+#include "encoders/codecs/hevc.hpp"
+#include "encoders/encoder-ffmpeg.hpp"
+#include "ffmpeg/converter.hpp"
+#include "ffmpeg/swscale.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+using namespace streamfx::benchmark;
+
+static constexpr AVPixelFormat formats[] = {
+	AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV444P, AV_PIX_FMT_P010LE, AV_PIX_FMT_BGRA,
+};
+
+static constexpr std::pair<AVPixelFormat, AVPixelFormat> conversions[] = {
+	{AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P},
+	{AV_PIX_FMT_YUV420P, AV_PIX_FMT_NV12},
+	{AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV420P},
+	{AV_PIX_FMT_BGRA, AV_PIX_FMT_NV12},
+	{AV_PIX_FMT_NV12, AV_PIX_FMT_P010},
+	{AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10},
+	{AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P10},
+	{AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV444P10},
+};
+
+static std::shared_ptr<AVFrame> make_frame(AVPixelFormat format, int width, int height)
+{
+	auto frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* ptr) { av_frame_free(&ptr); });
+	frame->format = format;
+	frame->width  = width;
+	frame->height = height;
+	if (av_frame_get_buffer(frame.get(), 32) < 0) {
+		throw std::runtime_error("Failed to allocate frame.");
+	}
+	for (std::size_t idx = 0; (idx < AV_NUM_DATA_POINTERS) && frame->buf[idx]; idx++) {
+		memset(frame->buf[idx]->data, 0x40, frame->buf[idx]->size);
+	}
+	return frame;
+}
+
+/** Arguments: format index, width, height, extra bytes per row in the source. */
+static void copy_data(state& state)
+{
+	AVPixelFormat format  = formats[state.range(0)];
+	int           width   = static_cast<int>(state.range(1));
+	int           height  = static_cast<int>(state.range(2));
+	int           padding = static_cast<int>(state.range(3));
+
+	// OBS hands us tightly packed planes, which only match FFmpeg's layout if the width is suitably aligned.
+	int linesizes[4] = {0};
+	av_image_fill_linesizes(linesizes, format, width);
+
+	int                                h_shift, v_shift;
+	std::vector<std::vector<uint8_t>> planes;
+	encoder_frame                     frame{};
+	av_pix_fmt_get_chroma_sub_sample(format, &h_shift, &v_shift);
+	for (std::size_t idx = 0; (idx < 4) && (linesizes[idx] > 0); idx++) {
+		std::size_t stride = static_cast<std::size_t>(linesizes[idx] + padding);
+		std::size_t rows   = static_cast<std::size_t>(height) >> (idx ? v_shift : 0);
+		planes.emplace_back(stride * rows, uint8_t(0x80));
+		frame.data[idx]     = planes.back().data();
+		frame.linesize[idx] = static_cast<uint32_t>(stride);
+	}
+
+	auto     vframe = make_frame(format, width, height);
+	uint64_t bytes  = 0;
+	for (auto& plane : planes) {
+		bytes += plane.size();
+	}
+
+	while (state.keep_running()) {
+		streamfx::encoder::ffmpeg::copy_data(&frame, vframe.get());
+		do_not_optimize(vframe->data[0][0]);
+	}
+	state.set_bytes_processed(state.iterations() * bytes);
+	state.set_label(av_get_pix_fmt_name(format));
+}
+ST_BENCHMARK(copy_data, {0, 1920, 1080, 0}, {0, 1920, 1080, 64}, {1, 1920, 1080, 0}, {2, 1920, 1080, 0},
+			 {3, 1920, 1080, 0}, {4, 1920, 1080, 0}, {0, 3840, 2160, 0}, {4, 3840, 2160, 0});
+
+/** Arguments: conversion index, width, height. */
+static void swscale_convert(state& state)
+{
+	auto& conversion = conversions[state.range(0)];
+	int   width      = static_cast<int>(state.range(1));
+	int   height     = static_cast<int>(state.range(2));
+
+	// Same setup as the encoder uses, which only ever converts between formats of the same size.
+	streamfx::ffmpeg::swscale scaler;
+	scaler.set_source_size(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+	scaler.set_source_color(false, AVCOL_SPC_BT709);
+	scaler.set_source_format(conversion.first);
+	scaler.set_target_size(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+	scaler.set_target_color(false, AVCOL_SPC_BT709);
+	scaler.set_target_format(conversion.second);
+	if (!scaler.initialize(SWS_POINT)) {
+		throw std::runtime_error("Failed to initialize scaler.");
+	}
+
+	auto source = make_frame(conversion.first, width, height);
+	auto target = make_frame(conversion.second, width, height);
+	int  bytes  = av_image_get_buffer_size(conversion.first, width, height, 1);
+
+	while (state.keep_running()) {
+		scaler.convert(source->data, source->linesize, 0, height, target->data, target->linesize);
+		do_not_optimize(target->data[0][0]);
+	}
+	state.set_bytes_processed(state.iterations() * static_cast<uint64_t>(bytes));
+	state.set_label(std::string(av_get_pix_fmt_name(conversion.first)) + " -> "
+					+ av_get_pix_fmt_name(conversion.second));
+}
+ST_BENCHMARK(swscale_convert, {0, 1920, 1080}, {1, 1920, 1080}, {2, 1920, 1080}, {3, 1920, 1080},
+			 {3, 3840, 2160}, {4, 1920, 1080}, {5, 1920, 1080}, {6, 1920, 1080}, {7, 1920, 1080});
+
+/** Arguments: conversion index, width, height, full range. */
+static void ffmpeg_converter(state& state)
+{
+	auto& conversion = conversions[state.range(0)];
+	int   width      = static_cast<int>(state.range(1));
+	int   height     = static_cast<int>(state.range(2));
+	bool  full_range = state.range(3) != 0;
+
+	streamfx::ffmpeg::swscale scaler;
+	scaler.set_source_size(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+	scaler.set_source_color(full_range, AVCOL_SPC_BT709);
+	scaler.set_source_format(conversion.first);
+	scaler.set_target_size(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+	scaler.set_target_color(full_range, AVCOL_SPC_BT709);
+	scaler.set_target_format(conversion.second);
+	if (!scaler.initialize(SWS_POINT)) {
+		throw std::runtime_error("Failed to initialize scaler.");
+	}
+
+	// Refuses conversions that don't match swscale with this version of FFmpeg.
+	streamfx::ffmpeg::converter converter;
+	if (!converter.initialize(scaler)) {
+		state.skip_with_message("No converter for this conversion.");
+		return;
+	}
+
+	// Noise rather than a flat color, so that every bit of every sample takes part in the comparison.
+	auto source = make_frame(conversion.first, width, height);
+	for (std::size_t idx = 0; (idx < AV_NUM_DATA_POINTERS) && source->buf[idx]; idx++) {
+		for (std::size_t pos = 0; pos < static_cast<std::size_t>(source->buf[idx]->size); pos++) {
+			source->buf[idx]->data[pos] = static_cast<uint8_t>((pos * 2654435761u) >> 13);
+		}
+	}
+
+	// The converter is only used in place of swscale if both agree on every sample.
+	auto expected = make_frame(conversion.second, width, height);
+	auto target   = make_frame(conversion.second, width, height);
+	scaler.convert(source->data, source->linesize, 0, height, expected->data, expected->linesize);
+	converter.convert(source->data, source->linesize, target->data, target->linesize);
+	{
+		int linesizes[4] = {0};
+		int h_shift, v_shift;
+		av_image_fill_linesizes(linesizes, conversion.second, width);
+		av_pix_fmt_get_chroma_sub_sample(conversion.second, &h_shift, &v_shift);
+		for (std::size_t idx = 0; (idx < 4) && (linesizes[idx] > 0); idx++) {
+			int rows = height >> (idx ? v_shift : 0);
+			for (int y = 0; y < rows; y++) {
+				if (memcmp(expected->data[idx] + y * expected->linesize[idx],
+						   target->data[idx] + y * target->linesize[idx], static_cast<std::size_t>(linesizes[idx]))
+					!= 0) {
+					state.skip_with_error("Plane " + std::to_string(idx) + " differs from swscale in row "
+										  + std::to_string(y) + ".");
+					return;
+				}
+			}
+		}
+	}
+
+	int bytes = av_image_get_buffer_size(conversion.first, width, height, 1);
+	while (state.keep_running()) {
+		converter.convert(source->data, source->linesize, target->data, target->linesize);
+		do_not_optimize(target->data[0][0]);
+	}
+	state.set_bytes_processed(state.iterations() * static_cast<uint64_t>(bytes));
+	state.set_label(converter.get_name());
+}
+ST_BENCHMARK(ffmpeg_converter, {0, 1920, 1080, 0}, {0, 1920, 1080, 1}, {4, 1920, 1080, 0}, {4, 1920, 1080, 1},
+			 {5, 1920, 1080, 0}, {5, 1920, 1080, 1}, {6, 1920, 1080, 0}, {6, 1920, 1080, 1}, {7, 1920, 1080, 0},
+			 {7, 1920, 1080, 1}, {7, 3840, 2160, 0});
+
+static void append_nal(std::vector<uint8_t>& packet, uint8_t type, std::size_t size)
+{
+	packet.insert(packet.end(), {0x00, 0x00, 0x00, 0x01, static_cast<uint8_t>(type << 1), 0x01});
+
+	// Filler without any zero bytes, so that it can never be mistaken for a start code.
+	for (std::size_t idx = 0; idx < size; idx++) {
+		packet.push_back(static_cast<uint8_t>(0x11 + (idx % 0xE0)));
+	}
+}
+
+/** Arguments: size of the picture data in bytes. */
+static void hevc_extract_header_sei(state& state)
+{
+	// A typical key frame: parameter sets, SEI and one large slice.
+	std::vector<uint8_t> packet;
+	append_nal(packet, 32, 24);
+	append_nal(packet, 33, 48);
+	append_nal(packet, 34, 8);
+	append_nal(packet, 39, 32);
+	append_nal(packet, 19, static_cast<std::size_t>(state.range(0)));
+
+	std::vector<uint8_t> header;
+	std::vector<uint8_t> sei;
+	while (state.keep_running()) {
+		header.clear();
+		sei.clear();
+		streamfx::encoder::codec::hevc::extract_header_sei(packet.data(), packet.size(), header, sei);
+		do_not_optimize(header.data());
+	}
+	state.set_bytes_processed(state.iterations() * packet.size());
+}
+ST_BENCHMARK(hevc_extract_header_sei, {16384}, {262144}, {2097152});
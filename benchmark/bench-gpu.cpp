@@ -0,0 +1,734 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Renders every filter of a StreamFX build on a synthetic source inside a minimal libobs, and reports what each
+// frame cost on the CPU and GPU along with a checksum of the final image. Only the OpenGL renderer is used, so this
+// runs without a GPU on Mesa llvmpipe. On Linux it needs an X server, such as the one from 'xvfb-run'.
+//
+// With '--replay', the input captured from a filter by obs::capture is fed back into that filter instead, frame by
+// frame and with the captured settings, so that a problem seen live can be profiled offline and repeatably.
+
+#include "config.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4201)
+#endif
+#include <obs-module.h>
+#include <obs.h>
+#ifdef D_PLATFORM_LINUX
+#include <obs-nix-platform.h>
+#include <X11/Xlib.h>
+#endif
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include "glad/gl.h"
+
+// Frames rendered before measuring, which absorb shader compilation and resource creation.
+#define ST_WARMUP_FRAMES 10
+
+#define ST_SOURCE_PATTERN "streamfx-benchmark-pattern"
+#define ST_SOURCE_REPLAY "streamfx-benchmark-replay"
+
+struct options {
+	std::string           module;
+	std::string           data;
+	std::string           filter;
+	std::string           out_file;
+	std::string           golden;
+	std::string           write_golden;
+	std::string           replay;
+	std::vector<uint32_t> heights = {1080, 2160};
+	uint32_t              frames  = 300;
+};
+
+struct scenario {
+	std::string                                      name;
+	std::string                                      id;
+	std::function<void(obs_data_t*, options const&)> setup;
+	std::string                                      source = ST_SOURCE_PATTERN;
+	uint32_t                                         width  = 0; // Fixed size of the source, if not zero.
+	uint32_t                                         height = 0;
+
+	// Called before each frame within the graphics context, returns the time to tick by.
+	std::function<float_t(uint32_t)> prepare;
+};
+
+struct result {
+	std::string name;
+	uint32_t    width;
+	uint32_t    height;
+	uint32_t    frames;
+	double_t    cpu_mean;
+	double_t    cpu_p50;
+	double_t    cpu_p99;
+	double_t    gpu_mean;
+	double_t    gpu_p50;
+	double_t    gpu_p99;
+	uint64_t    checksum;
+};
+
+static std::function<void(obs_data_t*, options const&)> blur(const char* type, const char* subtype)
+{
+	return [type, subtype](obs_data_t* data, options const&) {
+		obs_data_set_string(data, "Filter.Blur.Type", type);
+		obs_data_set_string(data, "Filter.Blur.SubType", subtype);
+		obs_data_set_double(data, "Filter.Blur.Size", 15.);
+		obs_data_set_double(data, "Filter.Blur.Angle", 45.);
+	};
+}
+
+static std::vector<scenario> scenarios()
+{
+	return {
+		{"blur/box/area", "streamfx-filter-blur", blur("box", "area")},
+		{"blur/box_linear/area", "streamfx-filter-blur", blur("box_linear", "area")},
+		{"blur/gaussian/area", "streamfx-filter-blur", blur("gaussian", "area")},
+		{"blur/gaussian_linear/area", "streamfx-filter-blur", blur("gaussian_linear", "area")},
+		{"blur/dual_filtering/area", "streamfx-filter-blur", blur("dual_filtering", "area")},
+		{"blur/gaussian/directional", "streamfx-filter-blur", blur("gaussian", "directional")},
+		{"blur/box/rotational", "streamfx-filter-blur", blur("box", "rotational")},
+		{"blur/box/zoom", "streamfx-filter-blur", blur("box", "zoom")},
+		{"sdf-effects/shadow", "streamfx-filter-sdf-effects",
+		 [](obs_data_t* data, options const&) {
+			 obs_data_set_bool(data, "Filter.SDFEffects.Shadow.Outer", true);
+			 obs_data_set_bool(data, "Filter.SDFEffects.Shadow.Inner", true);
+		 }},
+		{"sdf-effects/glow", "streamfx-filter-sdf-effects",
+		 [](obs_data_t* data, options const&) {
+			 obs_data_set_bool(data, "Filter.SDFEffects.Glow.Outer", true);
+			 obs_data_set_bool(data, "Filter.SDFEffects.Glow.Inner", true);
+		 }},
+		{"sdf-effects/outline", "streamfx-filter-sdf-effects",
+		 [](obs_data_t* data, options const&) { obs_data_set_bool(data, "Filter.SDFEffects.Outline", true); }},
+		{"color-grade", "streamfx-filter-color-grade", [](obs_data_t*, options const&) {}},
+		{"transform", "streamfx-filter-transform",
+		 [](obs_data_t* data, options const&) {
+			 obs_data_set_double(data, "Rotation.Z", 15.);
+			 obs_data_set_double(data, "Scale.X", 90.);
+			 obs_data_set_double(data, "Scale.Y", 90.);
+		 }},
+		{"displacement", "streamfx-filter-displacement",
+		 [](obs_data_t* data, options const& opt) {
+			 // Any of the shipped normal maps will do, the cost does not depend on the content.
+			 std::filesystem::path maps = std::filesystem::u8path(opt.data) / "examples" / "normal-maps";
+			 if (std::filesystem::exists(maps)) {
+				 for (auto& entry : std::filesystem::directory_iterator(maps)) {
+					 obs_data_set_string(data, "Filter.Displacement.File", entry.path().u8string().c_str());
+					 break;
+				 }
+			 }
+		 }},
+		{"dynamic-mask", "streamfx-filter-dynamic-mask", [](obs_data_t*, options const&) {}},
+		{"shader/fxaa", "streamfx-filter-shader",
+		 [](obs_data_t* data, options const& opt) {
+			 auto file = std::filesystem::u8path(opt.data) / "examples" / "shaders" / "filter" / "fxaa.effect";
+			 obs_data_set_string(data, "Shader.Shader.File", file.u8string().c_str());
+			 obs_data_set_string(data, "Shader.Shader.Technique", "Draw");
+		 }},
+	};
+}
+
+//------------------------------------------------------------------------------
+// Synthetic Source
+//------------------------------------------------------------------------------
+
+struct pattern {
+	uint32_t      width;
+	uint32_t      height;
+	gs_texture_t* texture;
+};
+
+static void* pattern_create(obs_data_t* settings, obs_source_t*)
+{
+	auto self     = new pattern();
+	self->width   = static_cast<uint32_t>(obs_data_get_int(settings, "Width"));
+	self->height  = static_cast<uint32_t>(obs_data_get_int(settings, "Height"));
+	self->texture = nullptr;
+	return self;
+}
+
+static void pattern_destroy(void* data)
+{
+	auto self = reinterpret_cast<pattern*>(data);
+	if (self->texture) {
+		obs_enter_graphics();
+		gs_texture_destroy(self->texture);
+		obs_leave_graphics();
+	}
+	delete self;
+}
+
+static uint32_t pattern_width(void* data)
+{
+	return reinterpret_cast<pattern*>(data)->width;
+}
+
+static uint32_t pattern_height(void* data)
+{
+	return reinterpret_cast<pattern*>(data)->height;
+}
+
+static void pattern_render(void* data, gs_effect_t*)
+{
+	auto self = reinterpret_cast<pattern*>(data);
+
+	if (!self->texture) {
+		// Gradients with a checkerboard for detail, and a transparent border so that edge effects have something to do.
+		std::vector<uint8_t> pixels(static_cast<std::size_t>(self->width) * self->height * 4);
+		uint32_t             border_x = self->width / 10;
+		uint32_t             border_y = self->height / 10;
+		for (uint32_t y = 0; y < self->height; y++) {
+			for (uint32_t x = 0; x < self->width; x++) {
+				uint8_t* px = &pixels[(static_cast<std::size_t>(y) * self->width + x) * 4];
+				bool     in = (x >= border_x) && (x < self->width - border_x) && (y >= border_y)
+						  && (y < self->height - border_y);
+				px[0] = static_cast<uint8_t>(x * 255 / self->width);
+				px[1] = static_cast<uint8_t>(y * 255 / self->height);
+				px[2] = (((x / 64) + (y / 64)) & 1) ? 255 : 32;
+				px[3] = in ? 255 : 0;
+			}
+		}
+		const uint8_t* planes[] = {pixels.data()};
+		self->texture           = gs_texture_create(self->width, self->height, GS_RGBA, 1, planes, 0);
+	}
+
+	gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), self->texture);
+	while (gs_effect_loop(effect, "Draw")) {
+		gs_draw_sprite(self->texture, 0, self->width, self->height);
+	}
+}
+
+static void register_pattern()
+{
+	static obs_source_info info = {};
+	info.id                     = ST_SOURCE_PATTERN;
+	info.type                   = OBS_SOURCE_TYPE_INPUT;
+	info.output_flags           = OBS_SOURCE_VIDEO;
+	info.get_name               = [](void*) { return "Benchmark Pattern"; };
+	info.create                 = pattern_create;
+	info.destroy                = pattern_destroy;
+	info.get_width              = pattern_width;
+	info.get_height             = pattern_height;
+	info.video_render           = pattern_render;
+	obs_register_source(&info);
+}
+
+//------------------------------------------------------------------------------
+// Captured Source
+//------------------------------------------------------------------------------
+
+struct replay {
+	uint32_t                          width   = 0;
+	uint32_t                          height  = 0;
+	gs_texture_t*                     texture = nullptr;
+	std::vector<std::vector<uint8_t>> frames;
+	std::vector<float_t>              ticks;
+};
+
+// There is only ever one capture being replayed, which the source and the scenario share.
+static replay captured;
+
+static uint32_t replay_width(void*)
+{
+	return captured.width;
+}
+
+static uint32_t replay_height(void*)
+{
+	return captured.height;
+}
+
+static void replay_render(void*, gs_effect_t*)
+{
+	if (!captured.texture) {
+		return;
+	}
+
+	gs_effect_t* effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_effect_set_texture(gs_effect_get_param_by_name(effect, "image"), captured.texture);
+	while (gs_effect_loop(effect, "Draw")) {
+		gs_draw_sprite(captured.texture, 0, captured.width, captured.height);
+	}
+}
+
+static void register_replay()
+{
+	static obs_source_info info = {};
+	info.id                     = ST_SOURCE_REPLAY;
+	info.type                   = OBS_SOURCE_TYPE_INPUT;
+	info.output_flags           = OBS_SOURCE_VIDEO;
+	info.get_name               = [](void*) { return "Benchmark Replay"; };
+	info.create                 = [](obs_data_t*, obs_source_t*) { return reinterpret_cast<void*>(&captured); };
+	info.destroy                = [](void*) {};
+	info.get_width              = replay_width;
+	info.get_height             = replay_height;
+	info.video_render           = replay_render;
+	obs_register_source(&info);
+}
+
+static float_t replay_prepare(uint32_t frame)
+{
+	// Upload outside of the measured section, so that only the filter itself is timed.
+	std::size_t index = frame % captured.frames.size();
+	if (!captured.texture) {
+		captured.texture = gs_texture_create(captured.width, captured.height, GS_RGBA, 1, nullptr, GS_DYNAMIC);
+	}
+	gs_texture_set_image(captured.texture, captured.frames[index].data(), captured.width * 4, false);
+	return captured.ticks[index];
+}
+
+static scenario load_replay(std::string const& file)
+{
+	obs_data_t* manifest = obs_data_create_from_json_file(file.c_str());
+	if (!manifest) {
+		throw std::runtime_error("Failed to read '" + file + "'.");
+	}
+
+	scenario scene;
+	scene.id        = obs_data_get_string(manifest, "id");
+	scene.name      = "replay/" + scene.id;
+	scene.source    = ST_SOURCE_REPLAY;
+	scene.prepare   = replay_prepare;
+	captured.width  = static_cast<uint32_t>(obs_data_get_int(manifest, "width"));
+	captured.height = static_cast<uint32_t>(obs_data_get_int(manifest, "height"));
+	scene.width     = captured.width;
+	scene.height    = captured.height;
+
+	std::string settings = "{}";
+	if (obs_data_t* data = obs_data_get_obj(manifest, "settings"); data) {
+		settings = obs_data_get_json(data);
+		obs_data_release(data);
+	}
+	scene.setup = [settings](obs_data_t* data, options const&) {
+		obs_data_t* captured_settings = obs_data_create_from_json(settings.c_str());
+		obs_data_apply(data, captured_settings);
+		obs_data_release(captured_settings);
+	};
+
+	std::string format = obs_data_get_string(manifest, "format");
+	double_t    fps    = obs_data_get_double(manifest, "fps");
+	if ((format != "rgba8") || (captured.width == 0) || (captured.height == 0)) {
+		obs_data_release(manifest);
+		throw std::runtime_error("Capture '" + file + "' is not in a supported format.");
+	}
+
+	// Frames are all loaded up front, so that the disk is not part of the measurement.
+	auto              directory = std::filesystem::u8path(file).parent_path();
+	obs_data_array_t* frames    = obs_data_get_array(manifest, "frames");
+	int64_t           previous  = 0;
+	for (std::size_t idx = 0, end = obs_data_array_count(frames); idx < end; idx++) {
+		obs_data_t* item = obs_data_array_item(frames, idx);
+		auto        path = directory / std::filesystem::u8path(obs_data_get_string(item, "file"));
+		int64_t     time = obs_data_get_int(item, "time_ns");
+		obs_data_release(item);
+
+		std::vector<uint8_t> pixels(static_cast<std::size_t>(captured.width) * captured.height * 4);
+		std::ifstream        stream(path, std::ios::binary);
+		stream.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+		if (!stream) {
+			obs_data_array_release(frames);
+			obs_data_release(manifest);
+			throw std::runtime_error("Failed to read '" + path.u8string() + "'.");
+		}
+
+		captured.frames.push_back(std::move(pixels));
+		if (idx == 0) {
+			captured.ticks.push_back(fps > 0. ? static_cast<float_t>(1. / fps) : 1.f / 60.f);
+		} else {
+			captured.ticks.push_back(static_cast<float_t>(static_cast<double_t>(time - previous) / 1000000000.));
+		}
+		previous = time;
+	}
+	obs_data_array_release(frames);
+	obs_data_release(manifest);
+
+	if (captured.frames.empty()) {
+		throw std::runtime_error("Capture '" + file + "' has no frames.");
+	}
+	return scene;
+}
+
+//------------------------------------------------------------------------------
+// Measurement
+//------------------------------------------------------------------------------
+
+static void summarize(std::vector<double_t> samples, double_t& mean, double_t& p50, double_t& p99)
+{
+	mean = p50 = p99 = 0;
+	if (samples.empty()) {
+		return;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	for (auto sample : samples) {
+		mean += sample;
+	}
+	mean /= static_cast<double_t>(samples.size());
+	p50 = samples[(samples.size() - 1) / 2];
+	p99 = samples[static_cast<std::size_t>(static_cast<double_t>(samples.size() - 1) * 0.99)];
+}
+
+static uint64_t checksum(gs_texture_t* texture, uint32_t width, uint32_t height)
+{
+	uint64_t        hash  = 14695981039346656037ull; // FNV-1a
+	gs_stagesurf_t* stage = gs_stagesurface_create(width, height, GS_RGBA);
+	gs_stage_texture(stage, texture);
+
+	uint8_t* data     = nullptr;
+	uint32_t linesize = 0;
+	if (gs_stagesurface_map(stage, &data, &linesize)) {
+		for (uint32_t y = 0; y < height; y++) {
+			uint8_t* row = data + static_cast<std::size_t>(y) * linesize;
+			for (uint32_t x = 0; x < width * 4; x++) {
+				hash = (hash ^ row[x]) * 1099511628211ull;
+			}
+		}
+		gs_stagesurface_unmap(stage);
+	}
+	gs_stagesurface_destroy(stage);
+	return hash;
+}
+
+static result measure(scenario const& scene, options const& opt, uint32_t width, uint32_t height)
+{
+	// libobs still creates a source for an unknown id, it just does nothing, so check the registered types instead.
+	if (!obs_source_get_display_name(scene.id.c_str())) {
+		throw std::runtime_error("Filter '" + scene.id + "' is not available in this build.");
+	}
+
+	obs_data_t* settings = obs_data_create();
+	obs_data_set_int(settings, "Width", width);
+	obs_data_set_int(settings, "Height", height);
+	obs_source_t* source = obs_source_create_private(scene.source.c_str(), "Input", settings);
+	obs_data_release(settings);
+
+	obs_data_t* filter_settings = obs_data_create();
+	scene.setup(filter_settings, opt);
+	obs_source_t* filter = obs_source_create_private(scene.id.c_str(), scene.name.c_str(), filter_settings);
+	obs_data_release(filter_settings);
+	obs_source_filter_add(source, filter);
+	obs_source_inc_showing(source);
+
+	std::vector<double_t> cpu;
+	std::vector<GLuint>   queries(opt.frames);
+	result                res{scene.name, width, height, opt.frames};
+
+	obs_enter_graphics();
+	gs_texrender_t* target = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+
+	for (uint32_t frame = 0; frame < ST_WARMUP_FRAMES + opt.frames; frame++) {
+		bool measured = frame >= ST_WARMUP_FRAMES;
+
+		// Tick right before rendering like libobs does, as some filters only redo their work after a tick.
+		float_t seconds = scene.prepare ? scene.prepare(frame) : 1.f / 60.f;
+		obs_source_video_tick(source, seconds);
+		obs_source_video_tick(filter, seconds);
+
+		gs_texrender_reset(target);
+		if (gs_texrender_begin(target, width, height)) {
+			vec4 black = {};
+			gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+			gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1, 1);
+
+			if (measured) {
+				glBeginQuery(GL_TIME_ELAPSED, queries[frame - ST_WARMUP_FRAMES]);
+			}
+			auto start = std::chrono::high_resolution_clock::now();
+			obs_source_video_render(source);
+			auto end = std::chrono::high_resolution_clock::now();
+			if (measured) {
+				glEndQuery(GL_TIME_ELAPSED);
+				cpu.push_back(std::chrono::duration<double_t, std::milli>(end - start).count());
+			}
+
+			gs_texrender_end(target);
+		}
+
+		// Give the rest of libobs a chance at the context, as it would have during normal operation.
+		obs_leave_graphics();
+		obs_enter_graphics();
+	}
+
+	// Results are read only once everything was submitted, so that reading them never stalls the loop above.
+	std::vector<double_t> gpu;
+	for (auto query : queries) {
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+		gpu.push_back(static_cast<double_t>(elapsed) / 1000000.);
+	}
+	glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+
+	res.checksum = checksum(gs_texrender_get_texture(target), width, height);
+	gs_texrender_destroy(target);
+	obs_leave_graphics();
+
+	obs_source_dec_showing(source);
+	obs_source_filter_remove(source, filter);
+	obs_source_release(filter);
+	obs_source_release(source);
+
+	summarize(cpu, res.cpu_mean, res.cpu_p50, res.cpu_p99);
+	summarize(gpu, res.gpu_mean, res.gpu_p50, res.gpu_p99);
+	return res;
+}
+
+//------------------------------------------------------------------------------
+// Output
+//------------------------------------------------------------------------------
+
+static std::string full_name(result const& res)
+{
+	return res.name + "/" + std::to_string(res.width) + "x" + std::to_string(res.height);
+}
+
+static std::string to_json(std::vector<result> const& results)
+{
+	// Same layout as the CPU benchmarks, with the GPU time and checksum as extra fields.
+	std::stringstream sstr;
+	sstr.precision(17);
+	sstr << "{\n  \"context\": {\n    \"renderer\": \"opengl\"\n  },\n  \"benchmarks\": [";
+	for (std::size_t idx = 0; idx < results.size(); idx++) {
+		auto& res = results[idx];
+		char  hash[17];
+		snprintf(hash, sizeof(hash), "%016" PRIx64, res.checksum);
+
+		sstr << (idx > 0 ? "," : "") << "\n    {\n";
+		sstr << "      \"name\": \"" << full_name(res) << "\",\n";
+		sstr << "      \"run_name\": \"" << full_name(res) << "\",\n";
+		sstr << "      \"run_type\": \"iteration\",\n";
+		sstr << "      \"iterations\": " << res.frames << ",\n";
+		sstr << "      \"real_time\": " << res.cpu_mean << ",\n";
+		sstr << "      \"cpu_time\": " << res.cpu_mean << ",\n";
+		sstr << "      \"cpu_time_p50\": " << res.cpu_p50 << ",\n";
+		sstr << "      \"cpu_time_p99\": " << res.cpu_p99 << ",\n";
+		sstr << "      \"gpu_time\": " << res.gpu_mean << ",\n";
+		sstr << "      \"gpu_time_p50\": " << res.gpu_p50 << ",\n";
+		sstr << "      \"gpu_time_p99\": " << res.gpu_p99 << ",\n";
+		sstr << "      \"time_unit\": \"ms\",\n";
+		sstr << "      \"checksum\": \"" << hash << "\"\n";
+		sstr << "    }";
+	}
+	sstr << "\n  ]\n}\n";
+	return sstr.str();
+}
+
+static std::map<std::string, std::string> read_golden(std::string const& file)
+{
+	std::map<std::string, std::string> golden;
+	std::ifstream                      stream(file);
+	std::string                        name, hash;
+	while (stream >> name >> hash) {
+		golden[name] = hash;
+	}
+	return golden;
+}
+
+//------------------------------------------------------------------------------
+// Main
+//------------------------------------------------------------------------------
+
+static bool parse(int argc, const char* argv[], options& opt)
+{
+	for (int idx = 1; idx < argc; idx++) {
+		std::string_view arg   = argv[idx];
+		auto             split = arg.find('=');
+		std::string_view key   = arg.substr(0, split);
+		std::string      value = (split != std::string_view::npos) ? std::string(arg.substr(split + 1)) : "";
+
+		if (key == "--module") {
+			opt.module = value;
+		} else if (key == "--data") {
+			opt.data = value;
+		} else if (key == "--filter") {
+			opt.filter = value;
+		} else if (key == "--frames") {
+			opt.frames = static_cast<uint32_t>(std::stoul(value));
+		} else if (key == "--height") {
+			opt.heights = {static_cast<uint32_t>(std::stoul(value))};
+		} else if (key == "--out") {
+			opt.out_file = value;
+		} else if (key == "--golden") {
+			opt.golden = value;
+		} else if (key == "--write-golden") {
+			opt.write_golden = value;
+		} else if (key == "--replay") {
+			opt.replay = value;
+		} else {
+			return false;
+		}
+	}
+	return !opt.module.empty() && !opt.data.empty() && (opt.frames > 0);
+}
+
+int main(int argc, const char* argv[])
+{
+	options opt;
+	if (!parse(argc, argv, opt)) {
+		fprintf(stderr,
+				"Usage: %s --module=<StreamFX module> --data=<StreamFX data directory> [--frames=<count>]\n"
+				"          [--height=<1080|2160>] [--filter=<substring>] [--out=<json file>]\n"
+				"          [--golden=<file>] [--write-golden=<file>] [--replay=<capture manifest>]\n",
+				argv[0]);
+		return 1;
+	}
+
+	std::vector<scenario> list;
+	try {
+		list = opt.replay.empty() ? scenarios() : std::vector<scenario>{load_replay(opt.replay)};
+	} catch (std::exception const& ex) {
+		fprintf(stderr, "%s\n", ex.what());
+		return 1;
+	}
+	if (!opt.replay.empty()) {
+		opt.heights = {list.front().height};
+	}
+
+#ifdef D_PLATFORM_LINUX
+	Display* display = XOpenDisplay(nullptr);
+	if (!display) {
+		fprintf(stderr, "No X server available, try running through 'xvfb-run'.\n");
+		return 1;
+	}
+	obs_set_nix_platform(OBS_NIX_PLATFORM_X11_EGL);
+	obs_set_nix_platform_display(display);
+#endif
+
+	if (!obs_startup("en-US", nullptr, nullptr)) {
+		fprintf(stderr, "Failed to start libobs.\n");
+		return 1;
+	}
+
+	int code = 0;
+	{
+		uint32_t       max_height = *std::max_element(opt.heights.begin(), opt.heights.end());
+		obs_video_info ovi        = {};
+		ovi.graphics_module       = "libobs-opengl";
+		ovi.fps_num               = 60;
+		ovi.fps_den               = 1;
+		ovi.base_width = ovi.output_width = max_height * 16 / 9;
+		ovi.base_height = ovi.output_height = max_height;
+		ovi.output_format                   = VIDEO_FORMAT_NV12;
+		ovi.colorspace                      = VIDEO_CS_709;
+		ovi.range                           = VIDEO_RANGE_PARTIAL;
+		ovi.gpu_conversion                  = true;
+		ovi.scale_type                      = OBS_SCALE_BICUBIC;
+		if (obs_reset_video(&ovi) != OBS_VIDEO_SUCCESS) {
+			fprintf(stderr, "Failed to initialize OpenGL rendering.\n");
+			obs_shutdown();
+			return 1;
+		}
+
+		obs_enter_graphics();
+		bool have_gl = gladLoaderLoadGL() != 0;
+		obs_leave_graphics();
+		if (!have_gl) {
+			fprintf(stderr, "Failed to load OpenGL functions.\n");
+			obs_shutdown();
+			return 1;
+		}
+
+		obs_module_t* module = nullptr;
+		if ((obs_open_module(&module, opt.module.c_str(), opt.data.c_str()) != MODULE_SUCCESS)
+			|| !obs_init_module(module)) {
+			fprintf(stderr, "Failed to load '%s'.\n", opt.module.c_str());
+			obs_shutdown();
+			return 1;
+		}
+		register_pattern();
+		register_replay();
+
+		auto                golden = read_golden(opt.golden);
+		std::vector<result> results;
+		printf("%-40s %10s %10s %10s %10s %10s %10s  %s\n", "Benchmark", "CPU ms", "CPU p50", "CPU p99", "GPU ms",
+			   "GPU p50", "GPU p99", "Checksum");
+		for (auto& scene : list) {
+			if (!opt.filter.empty() && (scene.name.find(opt.filter) == std::string::npos)) {
+				continue;
+			}
+
+			for (auto height : opt.heights) {
+				result res;
+				try {
+					res = measure(scene, opt, scene.width ? scene.width : height * 16 / 9, height);
+				} catch (std::exception const& ex) {
+					fprintf(stderr, "%s: %s\n", scene.name.c_str(), ex.what());
+					continue;
+				}
+
+				char hash[17];
+				snprintf(hash, sizeof(hash), "%016" PRIx64, res.checksum);
+				printf("%-40s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f  %s", full_name(res).c_str(), res.cpu_mean,
+					   res.cpu_p50, res.cpu_p99, res.gpu_mean, res.gpu_p50, res.gpu_p99, hash);
+
+				if (auto kv = golden.find(full_name(res)); kv != golden.end()) {
+					if (kv->second != hash) {
+						printf("  MISMATCH (expected %s)", kv->second.c_str());
+						code = 2;
+					}
+				}
+				printf("\n");
+				fflush(stdout);
+
+				results.push_back(std::move(res));
+			}
+		}
+
+		if (!opt.out_file.empty()) {
+			std::ofstream(opt.out_file, std::ios::binary | std::ios::trunc) << to_json(results);
+		}
+		if (!opt.write_golden.empty()) {
+			std::ofstream stream(opt.write_golden, std::ios::trunc);
+			for (auto& res : results) {
+				char hash[17];
+				snprintf(hash, sizeof(hash), "%016" PRIx64, res.checksum);
+				stream << full_name(res) << " " << hash << "\n";
+			}
+		}
+	}
+
+	if (captured.texture) {
+		obs_enter_graphics();
+		gs_texture_destroy(captured.texture);
+		obs_leave_graphics();
+	}
+	obs_shutdown();
+#ifdef D_PLATFORM_LINUX
+	XCloseDisplay(display);
+#endif
+	return code;
+}
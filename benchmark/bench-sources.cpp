@@ -0,0 +1,53 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "benchmark.hpp"
+#include "sources/source-mirror.hpp"
+
+using namespace streamfx::benchmark;
+
+/** Arguments: speaker layout, frames per packet. */
+static void mirror_audio_ring_write(state& state)
+{
+	speaker_layout layout   = static_cast<speaker_layout>(state.range(0));
+	uint32_t       frames   = static_cast<uint32_t>(state.range(1));
+	std::size_t    channels = get_audio_channels(layout);
+
+	std::vector<std::vector<float_t>> planes(channels, std::vector<float_t>(frames, 0.5f));
+	audio_data                        audio{};
+	for (std::size_t idx = 0; idx < channels; idx++) {
+		audio.data[idx] = reinterpret_cast<uint8_t*>(planes[idx].data());
+	}
+	audio.frames    = frames;
+	audio.timestamp = 0;
+
+	// OBS mixes in planar float, so that is what the audio capture callback of every mirror writes. The layout is left
+	// for the ring to detect, like it is by default.
+	streamfx::source::mirror::audio_ring ring;
+	ring.reset(AUDIO_FORMAT_FLOAT_PLANAR, layout, 48000, AUDIO_OUTPUT_FRAMES, 32);
+	while (state.keep_running()) {
+		ring.write(&audio, SPEAKERS_UNKNOWN);
+		ring.read([](obs_source_audio const& block) { do_not_optimize(block.data[0]); });
+	}
+	state.set_bytes_processed(state.iterations() * channels * frames * sizeof(float_t));
+}
+ST_BENCHMARK(mirror_audio_ring_write, {SPEAKERS_STEREO, 1024}, {SPEAKERS_5POINT1, 1024}, {SPEAKERS_7POINT1, 1024},
+			 {SPEAKERS_STEREO, 4096});
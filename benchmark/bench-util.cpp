@@ -0,0 +1,269 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "benchmark.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include "util/util-event.hpp"
+#include "util/util-memory.hpp"
+#include "util/util-profiler.hpp"
+#include "util/util-simd.hpp"
+#include "util/util-threadpool.hpp"
+
+using namespace streamfx::benchmark;
+
+// Values per run of a kernel, as many as the chroma plane of a 1080p NV12 frame has pairs.
+#define ST_KERNEL_COUNT (1920 * 1080 / 4)
+
+// Sizes every implementation is checked with before it is timed, chosen to cover the tails of each vector width.
+static constexpr std::size_t kernel_check_counts[] = {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 1921};
+
+static void profiler_track(state& state)
+{
+	auto    profiler = streamfx::util::profiler::create();
+	int64_t value    = 0;
+	while (state.keep_running()) {
+		profiler->track(std::chrono::nanoseconds(value));
+		value = (value + 7919) & 0xFFFFFF;
+	}
+	state.set_items_processed(state.iterations());
+}
+ST_BENCHMARK(profiler_track);
+
+static void profiler_track_scoped(state& state)
+{
+	auto profiler = streamfx::util::profiler::create();
+	while (state.keep_running()) {
+		auto instance = profiler->track();
+		do_not_optimize(instance);
+	}
+	state.set_items_processed(state.iterations());
+}
+ST_BENCHMARK(profiler_track_scoped);
+
+static void threadpool_push_round_trip(state& state)
+{
+	auto pool = std::make_shared<streamfx::util::threadpool>();
+
+	std::mutex              lock;
+	std::condition_variable cv;
+	bool                    done = false;
+
+	// Measures the full trip from push() on this thread to the task signalling completion back to it.
+	while (state.keep_running()) {
+		{
+			std::unique_lock<std::mutex> ul(lock);
+			done = false;
+		}
+		pool->push(
+			[&](streamfx::util::threadpool_data_t) {
+				std::unique_lock<std::mutex> ul(lock);
+				done = true;
+				cv.notify_one();
+			},
+			nullptr);
+
+		std::unique_lock<std::mutex> ul(lock);
+		cv.wait(ul, [&done]() { return done; });
+	}
+	state.set_items_processed(state.iterations());
+}
+ST_BENCHMARK(threadpool_push_round_trip);
+
+static void threadpool_submit_round_trip(state& state)
+{
+	auto pool = std::make_shared<streamfx::util::threadpool>();
+	while (state.keep_running()) {
+		auto result = pool->submit([](streamfx::util::threadpool::cancellation_token const&) { return 1; }).get();
+		do_not_optimize(result);
+	}
+	state.set_items_processed(state.iterations());
+}
+ST_BENCHMARK(threadpool_submit_round_trip);
+
+static void event_dispatch(state& state)
+{
+	streamfx::util::event<int64_t> event;
+	std::atomic<int64_t>           sum{0};
+	for (int64_t idx = 0; idx < state.range(0); idx++) {
+		event.add([&sum](int64_t value) { sum.fetch_add(value, std::memory_order_relaxed); });
+	}
+
+	int64_t value = 0;
+	while (state.keep_running()) {
+		event(value++);
+	}
+	do_not_optimize(sum);
+	state.set_items_processed(state.iterations() * static_cast<uint64_t>(state.range(0)));
+}
+ST_BENCHMARK(event_dispatch, {1}, {4}, {16}, {64});
+
+static void event_dispatch_while_registering(state& state)
+{
+	// Another thread keeps adding and removing a listener, like the UI does while the audio thread is calling.
+	streamfx::util::event<int64_t> event;
+	std::atomic<int64_t>           sum{0};
+	for (int64_t idx = 0; idx < state.range(0); idx++) {
+		event.add([&sum](int64_t value) { sum.fetch_add(value, std::memory_order_relaxed); });
+	}
+
+	std::atomic<bool> stop{false};
+	std::thread       registrar([&event, &stop]() {
+		while (!stop.load(std::memory_order_relaxed)) {
+			event.remove(event.add([](int64_t) {}));
+		}
+	});
+
+	int64_t value = 0;
+	while (state.keep_running()) {
+		event(value++);
+	}
+	stop.store(true);
+	registrar.join();
+	do_not_optimize(sum);
+	state.set_items_processed(state.iterations() * static_cast<uint64_t>(state.range(0)));
+}
+ST_BENCHMARK(event_dispatch_while_registering, {1}, {16});
+
+static void memory_arena_frame(state& state)
+{
+	// A frame worth of small transient buffers, all of which are released together when the scope ends.
+	auto& arena = streamfx::util::memory::frame_arena();
+	while (state.keep_running()) {
+		streamfx::util::memory::arena::scope scope{arena};
+		for (int64_t idx = 0; idx < state.range(0); idx++) {
+			do_not_optimize(arena.allocate(64));
+		}
+	}
+	state.set_items_processed(state.iterations() * static_cast<uint64_t>(state.range(0)));
+}
+ST_BENCHMARK(memory_arena_frame, {1}, {16}, {256});
+
+static void memory_pool_round_trip(state& state)
+{
+	streamfx::util::memory::pool_allocator<std::array<uint8_t, 128>> allocator;
+	while (state.keep_running()) {
+		auto block = allocator.allocate(1);
+		do_not_optimize(block);
+		allocator.deallocate(block, 1);
+	}
+	state.set_items_processed(state.iterations());
+}
+ST_BENCHMARK(memory_pool_round_trip);
+
+template<typename _function>
+static typename streamfx::util::cpu::kernel<_function>::implementation const*
+	kernel_implementation(state& state, streamfx::util::cpu::kernel<_function> const& kernel)
+{
+	auto& implementations = kernel.implementations();
+	if (static_cast<std::size_t>(state.range(0)) >= implementations.size()) {
+		state.skip_with_message("Not available on this architecture.");
+		return nullptr;
+	}
+
+	auto& implementation = implementations[static_cast<std::size_t>(state.range(0))];
+	state.set_label(implementation.name);
+	if (!kernel.is_supported(implementation)) {
+		state.skip_with_message(std::string(implementation.name) + " is not supported by this CPU.");
+		return nullptr;
+	}
+	return &implementation;
+}
+
+static std::vector<uint8_t> kernel_input(std::size_t size)
+{
+	std::vector<uint8_t> data(size);
+	std::mt19937         generator(size);
+	for (auto& value : data) {
+		value = static_cast<uint8_t>(generator());
+	}
+	return data;
+}
+
+static void simd_deinterleave_u8(state& state)
+{
+	auto& kernel         = streamfx::util::simd::deinterleave_u8;
+	auto  implementation = kernel_implementation(state, kernel);
+	if (!implementation) {
+		return;
+	}
+
+	// Offset by one byte, so that nothing relies on the input being aligned.
+	auto                 source = kernel_input(ST_KERNEL_COUNT * 2 + 1);
+	std::vector<uint8_t> target_a(ST_KERNEL_COUNT), target_b(ST_KERNEL_COUNT);
+	std::vector<uint8_t> expected_a(ST_KERNEL_COUNT), expected_b(ST_KERNEL_COUNT);
+	for (auto count : kernel_check_counts) {
+		implementation->function(source.data() + 1, target_a.data(), target_b.data(), count);
+		kernel.reference().function(source.data() + 1, expected_a.data(), expected_b.data(), count);
+		if (!std::equal(target_a.begin(), target_a.begin() + count, expected_a.begin())
+			|| !std::equal(target_b.begin(), target_b.begin() + count, expected_b.begin())) {
+			state.skip_with_error("Differs from the reference for " + std::to_string(count) + " values.");
+			return;
+		}
+	}
+
+	while (state.keep_running()) {
+		implementation->function(source.data() + 1, target_a.data(), target_b.data(), ST_KERNEL_COUNT);
+		do_not_optimize(target_a.data());
+		do_not_optimize(target_b.data());
+	}
+	state.set_bytes_processed(state.iterations() * ST_KERNEL_COUNT * 2);
+}
+ST_BENCHMARK(simd_deinterleave_u8, {0}, {1}, {2}, {3});
+
+static void simd_widen_u8_u16(state& state)
+{
+	// Every combination the encoder input paths use, see the kernel.
+	static constexpr std::pair<uint32_t, uint16_t> parameters[] = {
+		{2, 0x3FC}, {2, 0x3FF}, {8, 0xFF00}, {8, 0xFFC0}, {1, 0xFFFF}, {7, 0xFFFF},
+	};
+
+	auto& kernel         = streamfx::util::simd::widen_u8_u16;
+	auto  implementation = kernel_implementation(state, kernel);
+	if (!implementation) {
+		return;
+	}
+
+	auto                  source = kernel_input(ST_KERNEL_COUNT + 1);
+	std::vector<uint16_t> target(ST_KERNEL_COUNT), expected(ST_KERNEL_COUNT);
+	for (auto& parameter : parameters) {
+		for (auto count : kernel_check_counts) {
+			implementation->function(source.data() + 1, target.data(), count, parameter.first, parameter.second);
+			kernel.reference().function(source.data() + 1, expected.data(), count, parameter.first, parameter.second);
+			if (!std::equal(target.begin(), target.begin() + count, expected.begin())) {
+				state.skip_with_error("Differs from the reference for " + std::to_string(count) + " values.");
+				return;
+			}
+		}
+	}
+
+	while (state.keep_running()) {
+		implementation->function(source.data() + 1, target.data(), ST_KERNEL_COUNT, 2, 0x3FC);
+		do_not_optimize(target.data());
+	}
+	state.set_bytes_processed(state.iterations() * ST_KERNEL_COUNT);
+}
+ST_BENCHMARK(simd_widen_u8_u16, {0}, {1}, {2}, {3});
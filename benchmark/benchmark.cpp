@@ -0,0 +1,417 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "benchmark.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include "util/utility.hpp"
+
+// Minimum time a run has to take before its result is used.
+#define ST_MIN_TIME 0.5
+#define ST_MAX_ITERATIONS 1000000000ull
+
+struct entry {
+	std::string                     name;
+	streamfx::benchmark::function_t function;
+	std::vector<int64_t>            args;
+};
+
+struct result {
+	std::string name;
+	uint64_t    iterations;
+	double_t    real_time;
+	double_t    cpu_time;
+	double_t    bytes_per_second;
+	double_t    items_per_second;
+	double_t    allocations;
+	std::string label;
+	std::string message;
+	bool        error;
+};
+
+// Every heap allocation in this executable goes through the operators below, no matter which thread makes it.
+static std::atomic<uint64_t> _heap_allocations{0};
+
+void* operator new(std::size_t size)
+{
+	_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size > 0 ? size : 1); ptr) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+	_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const& tag) noexcept
+{
+	return ::operator new(size, tag);
+}
+
+void* operator new(std::size_t size, std::align_val_t align)
+{
+	_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = streamfx::util::malloc_aligned(static_cast<std::size_t>(align), size > 0 ? size : 1); ptr) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align)
+{
+	return ::operator new(size, align);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+	streamfx::util::free_aligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+	streamfx::util::free_aligned(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	streamfx::util::free_aligned(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+	streamfx::util::free_aligned(ptr);
+}
+
+static std::vector<entry>& registry()
+{
+	// Function local, so that registrations from other translation units never see it uninitialized.
+	static std::vector<entry> entries;
+	return entries;
+}
+
+streamfx::benchmark::state::state(std::vector<int64_t> args, uint64_t iterations)
+	: _args(args), _iterations(iterations), _remaining(iterations), _started(false), _real_start(), _real_time(0),
+	  _cpu_start(), _cpu_time(0), _allocations_start(0), _allocations(0), _bytes(0), _items(0), _label(), _message(),
+	  _error(false)
+{}
+
+int64_t streamfx::benchmark::state::range(std::size_t idx) const
+{
+	return _args.at(idx);
+}
+
+uint64_t streamfx::benchmark::state::iterations() const
+{
+	return _iterations;
+}
+
+void streamfx::benchmark::state::pause_timing()
+{
+	_real_time += std::chrono::high_resolution_clock::now() - _real_start;
+	_cpu_time += static_cast<double_t>(std::clock() - _cpu_start) / CLOCKS_PER_SEC;
+	_allocations += _heap_allocations.load(std::memory_order_relaxed) - _allocations_start;
+}
+
+void streamfx::benchmark::state::resume_timing()
+{
+	_allocations_start = _heap_allocations.load(std::memory_order_relaxed);
+	_real_start        = std::chrono::high_resolution_clock::now();
+	_cpu_start         = std::clock();
+}
+
+void streamfx::benchmark::state::set_bytes_processed(uint64_t bytes)
+{
+	_bytes = bytes;
+}
+
+void streamfx::benchmark::state::set_items_processed(uint64_t items)
+{
+	_items = items;
+}
+
+void streamfx::benchmark::state::set_label(std::string label)
+{
+	_label = label;
+}
+
+void streamfx::benchmark::state::skip_with_message(std::string message)
+{
+	_message = message;
+	_error   = false;
+}
+
+void streamfx::benchmark::state::skip_with_error(std::string message)
+{
+	_message = message;
+	_error   = true;
+}
+
+void streamfx::benchmark::state::start()
+{
+	_started = true;
+	resume_timing();
+}
+
+void streamfx::benchmark::state::stop()
+{
+	if (_started) {
+		pause_timing();
+		_started = false;
+	}
+}
+
+streamfx::benchmark::registration::registration(const char* name, function_t function,
+												 std::vector<std::vector<int64_t>> args)
+{
+	if (args.empty()) {
+		registry().push_back({name, function, {}});
+	}
+	for (auto& arg : args) {
+		std::string full_name = name;
+		for (auto value : arg) {
+			full_name.append("/").append(std::to_string(value));
+		}
+		registry().push_back({full_name, function, arg});
+	}
+}
+
+class streamfx::benchmark::runner {
+	public:
+	static result run(entry const& bench, double_t min_time);
+};
+
+result streamfx::benchmark::runner::run(entry const& bench, double_t min_time)
+{
+	uint64_t iterations = 1;
+	while (true) {
+		streamfx::benchmark::state state{bench.args, iterations};
+		bench.function(state);
+
+		if (!state._message.empty()) {
+			result res     = {};
+			res.name       = bench.name;
+			res.iterations = 0;
+			res.message    = state._message;
+			res.error      = state._error;
+			return res;
+		}
+
+		double_t seconds = std::chrono::duration<double_t>(state._real_time).count();
+		if ((seconds >= min_time) || (iterations >= ST_MAX_ITERATIONS)) {
+			result res;
+			res.name             = bench.name;
+			res.iterations       = iterations;
+			res.real_time        = seconds * 1e9 / static_cast<double_t>(iterations);
+			res.cpu_time         = state._cpu_time * 1e9 / static_cast<double_t>(iterations);
+			res.bytes_per_second = seconds > 0 ? static_cast<double_t>(state._bytes) / seconds : 0;
+			res.items_per_second = seconds > 0 ? static_cast<double_t>(state._items) / seconds : 0;
+			res.allocations      = static_cast<double_t>(state._allocations) / static_cast<double_t>(iterations);
+			res.label            = state._label;
+			res.error            = false;
+			return res;
+		}
+
+		// Same growth strategy as Google Benchmark: aim a bit past the goal, but never grow more than tenfold.
+		double_t multiplier = (seconds > 0) ? (min_time * 1.4 / seconds) : 10.;
+		multiplier          = std::clamp(multiplier, 2., 10.);
+		iterations = std::min<uint64_t>(static_cast<uint64_t>(static_cast<double_t>(iterations) * multiplier),
+										ST_MAX_ITERATIONS);
+	}
+}
+
+static std::string escape(std::string const& text)
+{
+	std::string out;
+	for (char chr : text) {
+		if ((chr == '"') || (chr == '\\')) {
+			out.push_back('\\');
+		}
+		out.push_back(chr);
+	}
+	return out;
+}
+
+static std::string to_json(std::vector<result> const& results, const char* executable)
+{
+	char        date[64] = {0};
+	std::time_t now      = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+	// Follows the layout of Google Benchmark, so that its compare.py and existing CI tooling can read it.
+	std::stringstream sstr;
+	sstr.precision(17);
+	sstr << "{\n";
+	sstr << "  \"context\": {\n";
+	sstr << "    \"date\": \"" << date << "\",\n";
+	sstr << "    \"executable\": \"" << escape(executable) << "\",\n";
+	sstr << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+	sstr << "    \"version\": \"" << STREAMFX_VERSION_STRING << "\",\n";
+#ifdef _DEBUG
+	sstr << "    \"library_build_type\": \"debug\"\n";
+#else
+	sstr << "    \"library_build_type\": \"release\"\n";
+#endif
+	sstr << "  },\n";
+	sstr << "  \"benchmarks\": [";
+	for (std::size_t idx = 0; idx < results.size(); idx++) {
+		auto& res = results[idx];
+		sstr << (idx > 0 ? "," : "") << "\n    {\n";
+		sstr << "      \"name\": \"" << escape(res.name) << "\",\n";
+		sstr << "      \"run_name\": \"" << escape(res.name) << "\",\n";
+		sstr << "      \"run_type\": \"iteration\",\n";
+		sstr << "      \"iterations\": " << res.iterations << ",\n";
+		sstr << "      \"real_time\": " << res.real_time << ",\n";
+		sstr << "      \"cpu_time\": " << res.cpu_time << ",\n";
+		sstr << "      \"time_unit\": \"ns\"";
+		if (res.message.empty()) {
+			sstr << ",\n      \"allocs_per_iter\": " << res.allocations;
+		}
+		if (res.bytes_per_second > 0) {
+			sstr << ",\n      \"bytes_per_second\": " << res.bytes_per_second;
+		}
+		if (res.items_per_second > 0) {
+			sstr << ",\n      \"items_per_second\": " << res.items_per_second;
+		}
+		if (!res.label.empty()) {
+			sstr << ",\n      \"label\": \"" << escape(res.label) << "\"";
+		}
+		if (!res.message.empty()) {
+			sstr << ",\n      \"error_occurred\": " << (res.error ? "true" : "false");
+			sstr << ",\n      \"error_message\": \"" << escape(res.message) << "\"";
+		}
+		sstr << "\n    }";
+	}
+	sstr << "\n  ]\n}\n";
+	return sstr.str();
+}
+
+int main(int argc, const char* argv[])
+{
+	std::string filter;
+	std::string out_file;
+	std::string format   = "console";
+	double_t    min_time = ST_MIN_TIME;
+
+	for (int idx = 1; idx < argc; idx++) {
+		std::string_view arg = argv[idx];
+		if (arg.substr(0, 19) == "--benchmark_filter=") {
+			filter = arg.substr(19);
+		} else if (arg.substr(0, 16) == "--benchmark_out=") {
+			out_file = arg.substr(16);
+		} else if (arg.substr(0, 19) == "--benchmark_format=") {
+			format = arg.substr(19);
+		} else if (arg.substr(0, 21) == "--benchmark_min_time=") {
+			min_time = std::stod(std::string(arg.substr(21)));
+		} else if (arg == "--benchmark_list_tests") {
+			for (auto& bench : registry()) {
+				printf("%s\n", bench.name.c_str());
+			}
+			return 0;
+		} else {
+			fprintf(stderr,
+					"Usage: %s [--benchmark_filter=<substring>] [--benchmark_min_time=<seconds>]\n"
+					"          [--benchmark_format=<console|json>] [--benchmark_out=<file>] [--benchmark_list_tests]\n",
+					argv[0]);
+			return 1;
+		}
+	}
+
+	bool console = (format != "json");
+	if (console) {
+		printf("%-56s %15s %15s %12s %12s\n", "Benchmark", "Time", "CPU", "Iterations", "Allocs/Iter");
+	}
+
+	std::vector<result> results;
+	bool                failed = false;
+	for (auto& bench : registry()) {
+		if (!filter.empty() && (bench.name.find(filter) == std::string::npos)) {
+			continue;
+		}
+
+		auto res = streamfx::benchmark::runner::run(bench, min_time);
+		failed   = failed || res.error;
+		if (console && !res.message.empty()) {
+			printf("%-56s %s: %s\n", res.name.c_str(), res.error ? "ERROR" : "SKIPPED", res.message.c_str());
+			fflush(stdout);
+		} else if (console) {
+			printf("%-56s %12.1f ns %12.1f ns %12" PRIu64 " %12.2f", res.name.c_str(), res.real_time, res.cpu_time,
+				   res.iterations, res.allocations);
+			if (res.bytes_per_second > 0) {
+				printf(" %10.2f MiB/s", res.bytes_per_second / 1048576.);
+			}
+			if (res.items_per_second > 0) {
+				printf(" %10.2f M items/s", res.items_per_second / 1000000.);
+			}
+			printf(" %s\n", res.label.c_str());
+			fflush(stdout);
+		}
+		results.push_back(std::move(res));
+	}
+
+	std::string json = to_json(results, argv[0]);
+	if (!console) {
+		fwrite(json.data(), 1, json.size(), stdout);
+	}
+	if (!out_file.empty()) {
+		std::ofstream file(out_file, std::ios::binary | std::ios::trunc);
+		file << json;
+		if (!file) {
+			fprintf(stderr, "Failed to write results to '%s'.\n", out_file.c_str());
+			return 1;
+		}
+	}
+
+	return failed ? 1 : 0;
+}
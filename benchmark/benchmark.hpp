@@ -0,0 +1,127 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "common.hpp"
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace streamfx::benchmark {
+	class runner;
+
+	/** Controls a single run of a benchmark, modelled after Google Benchmark.
+	 *
+	 * Benchmarks loop on 'keep_running()', which times the loop and stops after the amount of iterations the runner
+	 * asked for. The runner keeps increasing that amount until a run takes long enough to be meaningful. Heap
+	 * allocations made by any thread while the clock runs are counted, and reported per iteration.
+	 */
+	class state {
+		std::vector<int64_t> _args;
+		uint64_t             _iterations;
+		uint64_t             _remaining;
+		bool                 _started;
+
+		std::chrono::high_resolution_clock::time_point _real_start;
+		std::chrono::nanoseconds                       _real_time;
+		std::clock_t                                   _cpu_start;
+		double_t                                       _cpu_time;
+		uint64_t                                       _allocations_start;
+		uint64_t                                       _allocations;
+
+		uint64_t    _bytes;
+		uint64_t    _items;
+		std::string _label;
+		std::string _message;
+		bool        _error;
+
+		public:
+		state(std::vector<int64_t> args, uint64_t iterations);
+
+		inline bool keep_running()
+		{
+			if (_remaining > 0 && _message.empty()) {
+				if (!_started) {
+					start();
+				}
+				_remaining--;
+				return true;
+			}
+			stop();
+			return false;
+		}
+
+		int64_t range(std::size_t idx = 0) const;
+
+		uint64_t iterations() const;
+
+		/** Stop the clock for setup work inside the loop, such as resetting inputs. */
+		void pause_timing();
+
+		void resume_timing();
+
+		void set_bytes_processed(uint64_t bytes);
+
+		void set_items_processed(uint64_t items);
+
+		void set_label(std::string label);
+
+		/** Don't run at all, for example because the CPU lacks the instructions needed. Call before the loop. */
+		void skip_with_message(std::string message);
+
+		/** Don't run at all and make the whole run fail, for example because the output is wrong. */
+		void skip_with_error(std::string message);
+
+		private:
+		void start();
+
+		void stop();
+
+		friend class runner;
+	};
+
+	typedef void (*function_t)(state&);
+
+	/** Registers a benchmark at static initialization, once for every set of arguments. */
+	class registration {
+		public:
+		registration(const char* name, function_t function, std::vector<std::vector<int64_t>> args = {});
+	};
+
+	/** Keep the compiler from removing work whose result is otherwise unused. */
+	template<typename T>
+	inline void do_not_optimize(T const& value)
+	{
+#if defined(_MSC_VER)
+		static volatile char const* sink;
+		sink = reinterpret_cast<char const volatile*>(&value);
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+} // namespace streamfx::benchmark
+
+#define ST_BENCHMARK_CONCAT_(a, b) a##b
+#define ST_BENCHMARK_CONCAT(a, b) ST_BENCHMARK_CONCAT_(a, b)
+#define ST_BENCHMARK(FUNCTION, ...)                                  \
+	static ::streamfx::benchmark::registration ST_BENCHMARK_CONCAT( \
+		_benchmark_, __LINE__){#FUNCTION, FUNCTION, {__VA_ARGS__}}
@@ -20,6 +20,8 @@
 
 #include "av1.hpp"
 
+#define ST_OBU_SEQUENCE_HEADER 1
+
 const char* streamfx::encoder::codec::av1::profile_to_string(profile p)
 {
 	switch (p) {
@@ -33,3 +35,43 @@ const char* streamfx::encoder::codec::av1::profile_to_string(profile p)
 		return "Unknown";
 	}
 }
+
+void streamfx::encoder::codec::av1::extract_sequence_header(uint8_t const* data, std::size_t size,
+															 std::vector<uint8_t>& header)
+{
+	header.clear();
+
+	uint8_t const* ptr = data;
+	uint8_t const* end = data + size;
+	while (ptr < end) {
+		uint8_t const* obu      = ptr;
+		uint8_t        type     = (ptr[0] >> 3) & 0xF;
+		bool           has_ext  = (ptr[0] & 0x04) != 0;
+		bool           has_size = (ptr[0] & 0x02) != 0;
+		if (!has_size) {
+			return;
+		}
+		ptr += has_ext ? 2 : 1;
+
+		// leb128 encoded payload size.
+		uint64_t length = 0;
+		for (std::size_t idx = 0; idx < 8; idx++) {
+			if (ptr >= end) {
+				return;
+			}
+			length |= static_cast<uint64_t>(*ptr & 0x7F) << (idx * 7);
+			if ((*ptr++ & 0x80) == 0) {
+				break;
+			}
+		}
+		if (length > static_cast<uint64_t>(end - ptr)) {
+			return;
+		}
+		ptr += length;
+
+		if (type == ST_OBU_SEQUENCE_HEADER) {
+			header.assign(obu, ptr);
+			return;
+		}
+	}
+}
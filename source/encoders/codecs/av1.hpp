@@ -33,4 +33,10 @@ namespace streamfx::encoder::codec::av1 {
 	};
 
 	const char* profile_to_string(profile p);
+
+	/** Copy the sequence header OBU out of a temporal unit, leaves 'header' empty if there is none.
+	 *
+	 * Only understands OBUs which carry their own size, which is all that encoders produce for storage formats.
+	 */
+	void extract_sequence_header(uint8_t const* data, std::size_t size, std::vector<uint8_t>& header);
 } // namespace streamfx::encoder::codec::av1
@@ -106,6 +106,9 @@
 #define ST_I18N_ADVANCED ST_I18N ".Advanced"
 #define ST_I18N_ADVANCED_THREADS ST_I18N_ADVANCED ".Threads"
 #define ST_KEY_ADVANCED_THREADS "Advanced.Threads"
+#define ST_I18N_ADVANCED_PARALLELGOPS ST_I18N_ADVANCED ".ParallelGOPs"
+#define ST_I18N_ADVANCED_PARALLELGOPS_DESCRIPTION ST_I18N_ADVANCED_PARALLELGOPS ".Description"
+#define ST_KEY_ADVANCED_PARALLELGOPS "Advanced.ParallelGOPs"
 #define ST_I18N_ADVANCED_ROWMULTITHREADING ST_I18N_ADVANCED ".RowMultiThreading"
 #define ST_KEY_ADVANCED_ROWMULTITHREADING "Advanced.RowMultiThreading"
 #define ST_I18N_ADVANCED_TILE_COLUMNS ST_I18N_ADVANCED ".Tile.Columns"
@@ -305,7 +308,7 @@ const char* aom_tune_content_to_string(aom_tune_content tune)
 
 aom_av1_instance::aom_av1_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw)
 	: obs::encoder_instance(settings, self, is_hw), _factory(aom_av1_factory::get()), _iface(nullptr), _ctx(), _cfg(),
-	  _image_index(0), _images(), _global_headers(nullptr), _initialized(false), _settings()
+	  _image_index(0), _images(), _global_headers(nullptr), _initialized(false), _settings(), _chunked()
 {
 	if (is_hw) {
 		throw std::runtime_error("Hardware encoding isn't even registered, how did you get here?");
@@ -412,10 +415,15 @@ aom_av1_instance::aom_av1_instance(obs_data_t* settings, obs_encoder_t* self, bo
 		}
 
 		{ // Threading
+			_settings.parallel_gops = static_cast<int32_t>(obs_data_get_int(settings, ST_KEY_ADVANCED_PARALLELGOPS));
 			if (auto threads = obs_data_get_int(settings, ST_KEY_ADVANCED_THREADS); threads > 0) {
-				_settings.threads = static_cast<int8_t>(threads);
+				_settings.threads = static_cast<int32_t>(threads);
+			} else if (_settings.parallel_gops > 0) {
+				// Every chunk runs its own encoder, so share the automatic thread count between them.
+				_settings.threads = static_cast<int32_t>(std::max<unsigned int>(
+					std::thread::hardware_concurrency() / static_cast<unsigned int>(_settings.parallel_gops), 1));
 			} else {
-				_settings.threads = std::thread::hardware_concurrency();
+				_settings.threads = static_cast<int32_t>(std::thread::hardware_concurrency());
 			}
 			_settings.rowmultithreading =
 				static_cast<int8_t>(obs_data_get_int(settings, ST_KEY_ADVANCED_ROWMULTITHREADING));
@@ -438,148 +446,60 @@ aom_av1_instance::aom_av1_instance(obs_data_t* settings, obs_encoder_t* self, bo
 	// Apply Settings
 	update(settings);
 
-	// Initialize Encoder
-	if (auto error = _factory->libaom_codec_enc_init_ver(&_ctx, _iface, &_cfg, 0, AOM_ENCODER_ABI_VERSION);
-		error != AOM_CODEC_OK) {
-		const char* errstr = _factory->libaom_codec_err_to_string(error);
-		D_LOG_ERROR("Failed to initialize codec, unexpected error: %s (code %" PRIu32 ")", errstr, error);
-		throw std::runtime_error(errstr);
-	}
-
-	{ // Apply Static Control Settings
-
-		{ // Color Information
-#ifdef AOM_CTRL_AV1E_SET_COLOR_PRIMARIES
-			if (auto error = _factory->libaom_codec_control(&_ctx, AV1E_SET_COLOR_PRIMARIES, _settings.color_primaries);
-				error != AOM_CODEC_OK) {
-				const char* errstr = _factory->libaom_codec_err_to_string(error);
-				const char* err    = _factory->libaom_codec_error(&_ctx);
-				const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-							  "AV1E_SET_COLOR_PRIMARIES",                             //
-							  (errstr ? errstr : ""), error,                          //
-							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-				);
-			}
-#else
-			D_LOG_ERROR("AOM library was built without AV1E_SET_COLOR_PRIMARIES, behavior is unknown.");
-#endif
-
-#ifdef AOM_CTRL_AV1E_SET_TRANSFER_CHARACTERISTICS
-			if (auto error =
-					_factory->libaom_codec_control(&_ctx, AV1E_SET_TRANSFER_CHARACTERISTICS, _settings.color_trc);
-				error != AOM_CODEC_OK) {
-				const char* errstr = _factory->libaom_codec_err_to_string(error);
-				const char* err    = _factory->libaom_codec_error(&_ctx);
-				const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-							  "AV1E_SET_TRANSFER_CHARACTERISTICS",                    //
-							  (errstr ? errstr : ""), error,                          //
-							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-				);
-			}
-#else
-			D_LOG_ERROR("AOM library was built without AV1E_SET_TRANSFER_CHARACTERISTICS, behavior is unknown.");
-#endif
+	// Parallel GOP Encoding
+	if (_settings.parallel_gops > 0) {
+		std::size_t length = static_cast<size_t>(std::max<int32_t>(_settings.kf_distance_max, 0));
+		if (_cfg.g_usage == AOM_USAGE_ALL_INTRA) {
+			// Every frame is a key frame, so any length works. Stick to roughly one second.
+			length = std::max<size_t>(_settings.fps.num / _settings.fps.den, 1);
+		}
 
-#ifdef AOM_CTRL_AV1E_SET_MATRIX_COEFFICIENTS
-			if (auto error =
-					_factory->libaom_codec_control(&_ctx, AV1E_SET_MATRIX_COEFFICIENTS, _settings.color_matrix);
-				error != AOM_CODEC_OK) {
-				const char* errstr = _factory->libaom_codec_err_to_string(error);
-				const char* err    = _factory->libaom_codec_error(&_ctx);
-				const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-							  "AV1E_SET_MATRIX_COEFFICIENTS",                         //
-							  (errstr ? errstr : ""), error,                          //
-							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-				);
-			}
-#else
-			D_LOG_ERROR("AOM library was built without AV1E_SET_MATRIX_COEFFICIENTS, behavior is unknown.");
-#endif
+		if (length == 0) {
+			D_LOG_WARNING("Parallel GOP encoding requires a fixed key frame interval, ignoring.", "");
+		} else if (!::streamfx::encoder::chunked::is_tail_disposable(_self)) {
+			D_LOG_WARNING("Parallel GOP encoding loses the end of recordings, ignoring.", "");
+		} else {
+			// Chunks are configured identically, so the first one provides the headers for all of them.
+			auto first      = std::make_shared<aom_av1_chunk_encoder>(this);
+			_global_headers = _factory->libaom_codec_get_global_headers(&first->_ctx);
+
+			_chunked = std::make_shared<::streamfx::encoder::chunked::scheduler>(
+				length, static_cast<size_t>(_settings.parallel_gops),
+				[this, first]() mutable -> std::shared_ptr<::streamfx::encoder::chunked::chunk_encoder> {
+					if (first) {
+						return std::move(first);
+					}
+					return std::make_shared<aom_av1_chunk_encoder>(this);
+				});
+		}
+	}
 
-#ifdef AOM_CTRL_AV1E_SET_COLOR_RANGE
-			if (auto error = _factory->libaom_codec_control(&_ctx, AV1E_SET_COLOR_RANGE, _settings.color_range);
-				error != AOM_CODEC_OK) {
-				const char* errstr = _factory->libaom_codec_err_to_string(error);
-				const char* err    = _factory->libaom_codec_error(&_ctx);
-				const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-							  "AV1E_SET_COLOR_RANGE",                                 //
-							  (errstr ? errstr : ""), error,                          //
-							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-				);
-			}
-#else
-			D_LOG_ERROR("AOM library was built without AV1_SET_COLOR_RANGE, behavior is unknown.");
-#endif
+	// Initialize Encoder, unless chunks bring their own.
+	if (!_chunked) {
+		if (auto error = _factory->libaom_codec_enc_init_ver(&_ctx, _iface, &_cfg, 0, AOM_ENCODER_ABI_VERSION);
+			error != AOM_CODEC_OK) {
+			const char* errstr = _factory->libaom_codec_err_to_string(error);
+			D_LOG_ERROR("Failed to initialize codec, unexpected error: %s (code %" PRIu32 ")", errstr, error);
+			throw std::runtime_error(errstr);
+		}
 
-#ifdef AOM_CTRL_AV1E_SET_CHROMA_SAMPLE_POSITION
-			// !TODO: Consider making this user-controlled. At the moment, this follows the H.264 chroma standard.
-			if (auto error = _factory->libaom_codec_control(&_ctx, AV1E_SET_CHROMA_SAMPLE_POSITION, AOM_CSP_VERTICAL);
-				error != AOM_CODEC_OK) {
-				const char* errstr = _factory->libaom_codec_err_to_string(error);
-				const char* err    = _factory->libaom_codec_error(&_ctx);
-				const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-							  "AV1E_SET_CHROMA_SAMPLE_POSITION",                      //
-							  (errstr ? errstr : ""), error,                          //
-							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-				);
-			}
-#endif
+		{ // Apply Static Control Settings
+			apply_static_controls(&_ctx);
 
-#ifdef AOM_CTRL_AV1E_SET_RENDER_SIZE
-			int32_t size[2] = {_settings.width, _settings.height};
-			if (auto error = _factory->libaom_codec_control(&_ctx, AV1E_SET_RENDER_SIZE, &size);
-				error != AOM_CODEC_OK) {
-				const char* errstr = _factory->libaom_codec_err_to_string(error);
-				const char* err    = _factory->libaom_codec_error(&_ctx);
-				const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-							  "AV1E_SET_RENDER_SIZE",                                 //
-							  (errstr ? errstr : ""), error,                          //
-							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-				);
+			// Apply Dynamic Control Settings
+			if (!update(settings)) {
+				throw std::runtime_error("Unexpected error during configuration.");
 			}
-#endif
 		}
 
-		// Apply Dynamic Control Settings
-		if (!update(settings)) {
-			throw std::runtime_error("Unexpected error during configuration.");
-		}
-	}
-
-	// Preallocate global headers.
-	_global_headers = _factory->libaom_codec_get_global_headers(&_ctx);
+		// Preallocate global headers.
+		_global_headers = _factory->libaom_codec_get_global_headers(&_ctx);
 
-	// Allocate frames.
-	_images.resize(_cfg.g_threads);
-	for (auto& image : _images) {
-		_factory->libaom_img_alloc(&image, _settings.color_format, _settings.width, _settings.height, 8);
-
-		// Color Information.
-		image.fmt        = _settings.color_format;
-		image.cp         = _settings.color_primaries;
-		image.tc         = _settings.color_trc;
-		image.mc         = _settings.color_matrix;
-		image.range      = _settings.color_range;
-		image.monochrome = _settings.monochrome ? 1 : 0;
-		image.csp        = AOM_CSP_VERTICAL; // !TODO: Consider making this user-controlled.
-
-		// Size
-		image.r_w = image.d_w;
-		image.r_h = image.d_h;
-		image.r_w = image.w;
-		image.r_h = image.h;
+		// Allocate frames.
+		_images.resize(_cfg.g_threads);
+		for (auto& image : _images) {
+			initialize_image(image);
+		}
 	}
 
 	// Log Settings
@@ -591,28 +511,34 @@ aom_av1_instance::aom_av1_instance(obs_data_t* settings, obs_encoder_t* self, bo
 
 aom_av1_instance::~aom_av1_instance()
 {
+	// Outstanding chunks still use our configuration and library.
+	_chunked.reset();
+
 #ifdef ENABLE_PROFILING
 	// Profiling
 	D_LOG_INFO("Timings | Avg. µs       | 99.9ile µs    | 99.0ile µs    | 95.0ile µs    | Samples  ", "");
 	D_LOG_INFO("--------+---------------+---------------+---------------+---------------+----------", "");
+	auto copy = _profiler_copy->capture();
 	D_LOG_INFO("Copy    | %13.1f | %13" PRId64 " | %13" PRId64 " | %13" PRId64 " | %9" PRIu64,
-			   _profiler_copy->average_duration() / 1000.,
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_copy->percentile(0.999)).count(),
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_copy->percentile(0.990)).count(),
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_copy->percentile(0.950)).count(),
-			   _profiler_copy->count());
+			   copy.average_duration() / 1000.,
+			   std::chrono::duration_cast<std::chrono::microseconds>(copy.percentile(0.999)).count(),
+			   std::chrono::duration_cast<std::chrono::microseconds>(copy.percentile(0.990)).count(),
+			   std::chrono::duration_cast<std::chrono::microseconds>(copy.percentile(0.950)).count(),
+			   copy.count());
+	auto encode = _profiler_encode->capture();
 	D_LOG_INFO("Encode  | %13.1f | %13" PRId64 " | %13" PRId64 " | %13" PRId64 " | %9" PRIu64,
-			   _profiler_encode->average_duration() / 1000.,
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_encode->percentile(0.999)).count(),
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_encode->percentile(0.990)).count(),
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_encode->percentile(0.950)).count(),
-			   _profiler_encode->count());
+			   encode.average_duration() / 1000.,
+			   std::chrono::duration_cast<std::chrono::microseconds>(encode.percentile(0.999)).count(),
+			   std::chrono::duration_cast<std::chrono::microseconds>(encode.percentile(0.990)).count(),
+			   std::chrono::duration_cast<std::chrono::microseconds>(encode.percentile(0.950)).count(),
+			   encode.count());
+	auto packet = _profiler_packet->capture();
 	D_LOG_INFO("Packet  | %13.1f | %13" PRId64 " | %13" PRId64 " | %13" PRId64 " | %9" PRIu64,
-			   _profiler_packet->average_duration() / 1000.,
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_packet->percentile(0.999)).count(),
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_packet->percentile(0.990)).count(),
-			   std::chrono::duration_cast<std::chrono::microseconds>(_profiler_packet->percentile(0.950)).count(),
-			   _profiler_packet->count());
+			   packet.average_duration() / 1000.,
+			   std::chrono::duration_cast<std::chrono::microseconds>(packet.percentile(0.999)).count(),
+			   std::chrono::duration_cast<std::chrono::microseconds>(packet.percentile(0.990)).count(),
+			   std::chrono::duration_cast<std::chrono::microseconds>(packet.percentile(0.950)).count(),
+			   packet.count());
 #endif
 
 	// Deallocate global buffer.
@@ -641,6 +567,10 @@ void aom_av1_instance::migrate(obs_data_t* settings, uint64_t version) {}
 
 bool aom_av1_instance::update(obs_data_t* settings)
 {
+	// Chunks read the configuration while they encode, which therefore must stay as it is.
+	if (_chunked)
+		return true;
+
 	video_t*                        obsVideo      = obs_encoder_video(_self);
 	const struct video_output_info* obsVideoInfo  = video_output_get_info(obsVideo);
 	uint32_t                        obsFPSnum     = obsVideoInfo->fps_num;
@@ -805,139 +735,249 @@ bool aom_av1_instance::update(obs_data_t* settings)
 	}
 
 	if (_ctx.iface) { // Control
+		apply_dynamic_controls(&_ctx);
+	}
 
-		{ // Encoder
+#undef SET_IF_NOT_DEFAULT
+
+	// Log the changed settings.
+	if (_initialized) {
+		log();
+	}
+
+	return true;
+}
+
+void aom_av1_instance::apply_static_controls(aom_codec_ctx_t* ctx)
+{
+	{ // Color Information
+#ifdef AOM_CTRL_AV1E_SET_COLOR_PRIMARIES
+		if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_COLOR_PRIMARIES, _settings.color_primaries);
+			error != AOM_CODEC_OK) {
+			const char* errstr = _factory->libaom_codec_err_to_string(error);
+			const char* err    = _factory->libaom_codec_error(ctx);
+			const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+			D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+						  "AV1E_SET_COLOR_PRIMARIES",                             //
+						  (errstr ? errstr : ""), error,                          //
+						  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+						  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+			);
+		}
+#else
+		D_LOG_ERROR("AOM library was built without AV1E_SET_COLOR_PRIMARIES, behavior is unknown.");
+#endif
+
+#ifdef AOM_CTRL_AV1E_SET_TRANSFER_CHARACTERISTICS
+		if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_TRANSFER_CHARACTERISTICS, _settings.color_trc);
+			error != AOM_CODEC_OK) {
+			const char* errstr = _factory->libaom_codec_err_to_string(error);
+			const char* err    = _factory->libaom_codec_error(ctx);
+			const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+			D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+						  "AV1E_SET_TRANSFER_CHARACTERISTICS",                    //
+						  (errstr ? errstr : ""), error,                          //
+						  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+						  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+			);
+		}
+#else
+		D_LOG_ERROR("AOM library was built without AV1E_SET_TRANSFER_CHARACTERISTICS, behavior is unknown.");
+#endif
+
+#ifdef AOM_CTRL_AV1E_SET_MATRIX_COEFFICIENTS
+		if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_MATRIX_COEFFICIENTS, _settings.color_matrix);
+			error != AOM_CODEC_OK) {
+			const char* errstr = _factory->libaom_codec_err_to_string(error);
+			const char* err    = _factory->libaom_codec_error(ctx);
+			const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+			D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+						  "AV1E_SET_MATRIX_COEFFICIENTS",                         //
+						  (errstr ? errstr : ""), error,                          //
+						  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+						  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+			);
+		}
+#else
+		D_LOG_ERROR("AOM library was built without AV1E_SET_MATRIX_COEFFICIENTS, behavior is unknown.");
+#endif
+
+#ifdef AOM_CTRL_AV1E_SET_COLOR_RANGE
+		if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_COLOR_RANGE, _settings.color_range);
+			error != AOM_CODEC_OK) {
+			const char* errstr = _factory->libaom_codec_err_to_string(error);
+			const char* err    = _factory->libaom_codec_error(ctx);
+			const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+			D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+						  "AV1E_SET_COLOR_RANGE",                                 //
+						  (errstr ? errstr : ""), error,                          //
+						  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+						  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+			);
+		}
+#else
+		D_LOG_ERROR("AOM library was built without AV1_SET_COLOR_RANGE, behavior is unknown.");
+#endif
+
+#ifdef AOM_CTRL_AV1E_SET_CHROMA_SAMPLE_POSITION
+		// !TODO: Consider making this user-controlled. At the moment, this follows the H.264 chroma standard.
+		if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_CHROMA_SAMPLE_POSITION, AOM_CSP_VERTICAL);
+			error != AOM_CODEC_OK) {
+			const char* errstr = _factory->libaom_codec_err_to_string(error);
+			const char* err    = _factory->libaom_codec_error(ctx);
+			const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+			D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+						  "AV1E_SET_CHROMA_SAMPLE_POSITION",                      //
+						  (errstr ? errstr : ""), error,                          //
+						  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+						  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+			);
+		}
+#endif
+
+#ifdef AOM_CTRL_AV1E_SET_RENDER_SIZE
+		int32_t size[2] = {_settings.width, _settings.height};
+		if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_RENDER_SIZE, &size);
+			error != AOM_CODEC_OK) {
+			const char* errstr = _factory->libaom_codec_err_to_string(error);
+			const char* err    = _factory->libaom_codec_error(ctx);
+			const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+			D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+						  "AV1E_SET_RENDER_SIZE",                                 //
+						  (errstr ? errstr : ""), error,                          //
+						  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+						  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+			);
+		}
+#endif
+	}
+}
+
+void aom_av1_instance::apply_dynamic_controls(aom_codec_ctx_t* ctx)
+{
+
+	{ // Encoder
 #ifdef AOM_CTRL_AOME_SET_CPUUSED
-			if (_settings.preset != -1) {
-				if (auto error = _factory->libaom_codec_control(&_ctx, AOME_SET_CPUUSED, _settings.preset);
-					error != AOM_CODEC_OK) {
-					const char* errstr = _factory->libaom_codec_err_to_string(error);
-					const char* err    = _factory->libaom_codec_error(&_ctx);
-					const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-					D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-								  "AOME_SET_CPUUSED",                                     //
-								  (errstr ? errstr : ""), error,                          //
-								  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-								  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-					);
-				}
+		if (_settings.preset != -1) {
+			if (auto error = _factory->libaom_codec_control(ctx, AOME_SET_CPUUSED, _settings.preset);
+				error != AOM_CODEC_OK) {
+				const char* errstr = _factory->libaom_codec_err_to_string(error);
+				const char* err    = _factory->libaom_codec_error(ctx);
+				const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+							  "AOME_SET_CPUUSED",                                     //
+							  (errstr ? errstr : ""), error,                          //
+							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+				);
 			}
-#endif
 		}
+#endif
+	}
 
-		{ // Rate Control
+	{ // Rate Control
 #ifdef AOM_CTRL_AOME_SET_CQ_LEVEL
-			if ((_settings.rc_quality != -1) && ((_settings.rc_mode == AOM_CQ) || (_settings.rc_mode == AOM_Q))) {
-				if (auto error = _factory->libaom_codec_control(&_ctx, AOME_SET_CQ_LEVEL, _settings.rc_quality);
-					error != AOM_CODEC_OK) {
-					const char* errstr = _factory->libaom_codec_err_to_string(error);
-					const char* err    = _factory->libaom_codec_error(&_ctx);
-					const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-					D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-								  "AOME_SET_CQ_LEVEL",                                    //
-								  (errstr ? errstr : ""), error,                          //
-								  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-								  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-					);
-				}
+		if ((_settings.rc_quality != -1) && ((_settings.rc_mode == AOM_CQ) || (_settings.rc_mode == AOM_Q))) {
+			if (auto error = _factory->libaom_codec_control(ctx, AOME_SET_CQ_LEVEL, _settings.rc_quality);
+				error != AOM_CODEC_OK) {
+				const char* errstr = _factory->libaom_codec_err_to_string(error);
+				const char* err    = _factory->libaom_codec_error(ctx);
+				const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+							  "AOME_SET_CQ_LEVEL",                                    //
+							  (errstr ? errstr : ""), error,                          //
+							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+				);
 			}
-#endif
 		}
+#endif
+	}
 
-		{ // Advanced
+	{ // Advanced
 #ifdef AOM_CTRL_AV1E_SET_ROW_MT
-			if (_settings.rowmultithreading != -1) {
-				if (auto error = _factory->libaom_codec_control(&_ctx, AV1E_SET_ROW_MT, _settings.rowmultithreading);
-					error != AOM_CODEC_OK) {
-					const char* errstr = _factory->libaom_codec_err_to_string(error);
-					const char* err    = _factory->libaom_codec_error(&_ctx);
-					const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-					D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-								  "AV1E_SET_ROW_MT",                                      //
-								  (errstr ? errstr : ""), error,                          //
-								  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-								  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-					);
-				}
+		if (_settings.rowmultithreading != -1) {
+			if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_ROW_MT, _settings.rowmultithreading);
+				error != AOM_CODEC_OK) {
+				const char* errstr = _factory->libaom_codec_err_to_string(error);
+				const char* err    = _factory->libaom_codec_error(ctx);
+				const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+							  "AV1E_SET_ROW_MT",                                      //
+							  (errstr ? errstr : ""), error,                          //
+							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+				);
 			}
+		}
 #endif
 
 #ifdef AOM_CTRL_AV1E_SET_TILE_COLUMNS
-			if (_settings.tile_columns != -1) {
-				if (auto error = _factory->libaom_codec_control(&_ctx, AV1E_SET_TILE_COLUMNS, _settings.tile_columns);
-					error != AOM_CODEC_OK) {
-					const char* errstr = _factory->libaom_codec_err_to_string(error);
-					const char* err    = _factory->libaom_codec_error(&_ctx);
-					const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-					D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-								  "AV1E_SET_TILE_COLUMNS",                                //
-								  (errstr ? errstr : ""), error,                          //
-								  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-								  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-					);
-				}
+		if (_settings.tile_columns != -1) {
+			if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_TILE_COLUMNS, _settings.tile_columns);
+				error != AOM_CODEC_OK) {
+				const char* errstr = _factory->libaom_codec_err_to_string(error);
+				const char* err    = _factory->libaom_codec_error(ctx);
+				const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+							  "AV1E_SET_TILE_COLUMNS",                                //
+							  (errstr ? errstr : ""), error,                          //
+							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+				);
 			}
+		}
 #endif
 
 #ifdef AOM_CTRL_AV1E_SET_TILE_ROWS
-			if (_settings.tile_rows != -1) {
-				if (auto error = _factory->libaom_codec_control(&_ctx, AV1E_SET_TILE_ROWS, _settings.tile_rows);
-					error != AOM_CODEC_OK) {
-					const char* errstr = _factory->libaom_codec_err_to_string(error);
-					const char* err    = _factory->libaom_codec_error(&_ctx);
-					const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-					D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-								  "AV1E_SET_TILE_ROWS",                                   //
-								  (errstr ? errstr : ""), error,                          //
-								  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-								  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-					);
-				}
+		if (_settings.tile_rows != -1) {
+			if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_TILE_ROWS, _settings.tile_rows);
+				error != AOM_CODEC_OK) {
+				const char* errstr = _factory->libaom_codec_err_to_string(error);
+				const char* err    = _factory->libaom_codec_error(ctx);
+				const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+							  "AV1E_SET_TILE_ROWS",                                   //
+							  (errstr ? errstr : ""), error,                          //
+							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+				);
 			}
+		}
 #endif
 #ifdef AOM_CTRL_AOME_SET_TUNING
-			if (_settings.tune_metric != -1) {
-				if (auto error = _factory->libaom_codec_control(&_ctx, AOME_SET_TUNING, _settings.tune_metric);
-					error != AOM_CODEC_OK) {
-					const char* errstr = _factory->libaom_codec_err_to_string(error);
-					const char* err    = _factory->libaom_codec_error(&_ctx);
-					const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-					D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-								  "AOME_SET_TUNING",                                      //
-								  (errstr ? errstr : ""), error,                          //
-								  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-								  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-					);
-				}
+		if (_settings.tune_metric != -1) {
+			if (auto error = _factory->libaom_codec_control(ctx, AOME_SET_TUNING, _settings.tune_metric);
+				error != AOM_CODEC_OK) {
+				const char* errstr = _factory->libaom_codec_err_to_string(error);
+				const char* err    = _factory->libaom_codec_error(ctx);
+				const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+							  "AOME_SET_TUNING",                                      //
+							  (errstr ? errstr : ""), error,                          //
+							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+				);
 			}
+		}
 #endif
 #ifdef AOM_CTRL_AV1E_SET_TUNE_CONTENT
-			if (_settings.tune_content != AOM_CONTENT_DEFAULT) {
-				if (auto error = _factory->libaom_codec_control(&_ctx, AV1E_SET_TUNE_CONTENT, _settings.tune_content);
-					error != AOM_CODEC_OK) {
-					const char* errstr = _factory->libaom_codec_err_to_string(error);
-					const char* err    = _factory->libaom_codec_error(&_ctx);
-					const char* errdtl = _factory->libaom_codec_error_detail(&_ctx);
-					D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
-								  "AV1E_SET_TUNE_CONTENT",                                //
-								  (errstr ? errstr : ""), error,                          //
-								  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
-								  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
-					);
-				}
+		if (_settings.tune_content != AOM_CONTENT_DEFAULT) {
+			if (auto error = _factory->libaom_codec_control(ctx, AV1E_SET_TUNE_CONTENT, _settings.tune_content);
+				error != AOM_CODEC_OK) {
+				const char* errstr = _factory->libaom_codec_err_to_string(error);
+				const char* err    = _factory->libaom_codec_error(ctx);
+				const char* errdtl = _factory->libaom_codec_error_detail(ctx);
+				D_LOG_WARNING("Error changing '%s': %s (code %" PRIu32 ")%s%s%s%s",   //
+							  "AV1E_SET_TUNE_CONTENT",                                //
+							  (errstr ? errstr : ""), error,                          //
+							  (err ? "\n\tMessage: " : ""), (err ? err : ""),         //
+							  (errdtl ? "\n\tDetails: " : ""), (errdtl ? errdtl : "") //
+				);
 			}
-#endif
 		}
+#endif
 	}
-
-#undef SET_IF_NOT_DEFAULT
-
-	// Log the changed settings.
-	if (_initialized) {
-		log();
-	}
-
-	return true;
 }
 
 void aom_av1_instance::log()
@@ -967,7 +1007,8 @@ void aom_av1_instance::log()
 
 	// Advanced
 	D_LOG_INFO("  Advanced: ", "");
-	D_LOG_INFO("   Threads: %" PRId8, _settings.threads);
+	D_LOG_INFO("   Threads: %" PRId32, _settings.threads);
+	D_LOG_INFO("   Parallel GOPs: %" PRId32, _settings.parallel_gops);
 	D_LOG_INFO("   Row-Multi-Threading: %s", _settings.rowmultithreading == -1  ? "Default"
 											 : _settings.rowmultithreading == 1 ? "Enabled"
 																				: "Disabled");
@@ -1048,9 +1089,42 @@ void aom_av1_instance::get_video_info(struct video_scale_info* info)
 	}
 }
 
+static inline void copy_image(encoder_frame* frame, aom_image_t& image)
+{
+	std::memcpy(image.planes[AOM_PLANE_Y], frame->data[0], frame->linesize[0] * image.h);
+	if (image.fmt == AOM_IMG_FMT_I420) {
+		std::memcpy(image.planes[AOM_PLANE_U], frame->data[1], frame->linesize[1] * image.h / 2);
+		std::memcpy(image.planes[AOM_PLANE_V], frame->data[2], frame->linesize[2] * image.h / 2);
+	} else {
+		std::memcpy(image.planes[AOM_PLANE_U], frame->data[1], frame->linesize[1] * image.h);
+		std::memcpy(image.planes[AOM_PLANE_V], frame->data[2], frame->linesize[2] * image.h);
+	}
+}
+
+static inline void get_packet_priority(bool keyframe, aom_codec_frame_flags_t flags, int& priority, int& drop_priority)
+{
+	if (keyframe) {
+		//
+		priority      = 3; // OBS_NAL_PRIORITY_HIGHEST
+		drop_priority = 3; // OBS_NAL_PRIORITY_HIGHEST
+	} else if ((flags & AOM_FRAME_IS_DROPPABLE) != AOM_FRAME_IS_DROPPABLE) {
+		// Dropping this frame breaks the bitstream.
+		priority      = 2; // OBS_NAL_PRIORITY_HIGH
+		drop_priority = 3; // OBS_NAL_PRIORITY_HIGHEST
+	} else {
+		// This frame can be dropped at will.
+		priority      = 0; // OBS_NAL_PRIORITY_DISPOSABLE
+		drop_priority = 0; // OBS_NAL_PRIORITY_DISPOSABLE
+	}
+}
+
 bool streamfx::encoder::aom::av1::aom_av1_instance::encode_video(encoder_frame* frame, encoder_packet* packet,
 																 bool* received_packet)
 {
+	if (_chunked) {
+		return encode_chunked(frame, packet, received_packet);
+	}
+
 	// Retrieve current indexed image.
 	auto& image = _images.at(_image_index);
 
@@ -1058,14 +1132,7 @@ bool streamfx::encoder::aom::av1::aom_av1_instance::encode_video(encoder_frame*
 #ifdef ENABLE_PROFILING
 		auto profile = _profiler_copy->track();
 #endif
-		std::memcpy(image.planes[AOM_PLANE_Y], frame->data[0], frame->linesize[0] * image.h);
-		if (image.fmt == AOM_IMG_FMT_I420) {
-			std::memcpy(image.planes[AOM_PLANE_U], frame->data[1], frame->linesize[1] * image.h / 2);
-			std::memcpy(image.planes[AOM_PLANE_V], frame->data[2], frame->linesize[2] * image.h / 2);
-		} else {
-			std::memcpy(image.planes[AOM_PLANE_U], frame->data[1], frame->linesize[1] * image.h);
-			std::memcpy(image.planes[AOM_PLANE_V], frame->data[2], frame->linesize[2] * image.h);
-		}
+		copy_image(frame, image);
 	}
 
 	{ // Try to encode the new image.
@@ -1123,19 +1190,7 @@ bool streamfx::encoder::aom::av1::aom_av1_instance::encode_video(encoder_frame*
 				packet->type     = OBS_ENCODER_VIDEO;
 				packet->keyframe = ((pkt->data.frame.flags & AOM_FRAME_IS_KEY) == AOM_FRAME_IS_KEY)
 								   || (_cfg.g_usage == AOM_USAGE_ALL_INTRA);
-				if (packet->keyframe) {
-					//
-					packet->priority      = 3; // OBS_NAL_PRIORITY_HIGHEST
-					packet->drop_priority = 3; // OBS_NAL_PRIORITY_HIGHEST
-				} else if ((pkt->data.frame.flags & AOM_FRAME_IS_DROPPABLE) != AOM_FRAME_IS_DROPPABLE) {
-					// Dropping this frame breaks the bitstream.
-					packet->priority      = 2; // OBS_NAL_PRIORITY_HIGH
-					packet->drop_priority = 3; // OBS_NAL_PRIORITY_HIGHEST
-				} else {
-					// This frame can be dropped at will.
-					packet->priority      = 0; // OBS_NAL_PRIORITY_DISPOSABLE
-					packet->drop_priority = 0; // OBS_NAL_PRIORITY_DISPOSABLE
-				}
+				get_packet_priority(packet->keyframe, pkt->data.frame.flags, packet->priority, packet->drop_priority);
 
 				// Data
 				packet->data = static_cast<uint8_t*>(pkt->data.frame.buf);
@@ -1175,6 +1230,142 @@ bool streamfx::encoder::aom::av1::aom_av1_instance::encode_video(encoder_frame*
 	return true;
 }
 
+void aom_av1_instance::initialize_image(aom_image_t& image)
+{
+	if (!_factory->libaom_img_alloc(&image, _settings.color_format, _settings.width, _settings.height, 8)) {
+		throw std::bad_alloc();
+	}
+
+	// Color Information.
+	image.fmt        = _settings.color_format;
+	image.cp         = _settings.color_primaries;
+	image.tc         = _settings.color_trc;
+	image.mc         = _settings.color_matrix;
+	image.range      = _settings.color_range;
+	image.monochrome = _settings.monochrome ? 1 : 0;
+	image.csp        = AOM_CSP_VERTICAL; // !TODO: Consider making this user-controlled.
+
+	// Size
+	image.r_w = image.d_w;
+	image.r_h = image.d_h;
+	image.r_w = image.w;
+	image.r_h = image.h;
+}
+
+bool aom_av1_instance::encode_chunked(encoder_frame* frame, encoder_packet* packet, bool* received_packet)
+{
+	// The chunk holds on to the image until it is encoded, so it can't be one of the shared ones.
+	auto                         factory = _factory;
+	std::shared_ptr<aom_image_t> image(new aom_image_t(), [factory](aom_image_t* v) {
+		factory->libaom_img_free(v);
+		delete v;
+	});
+	initialize_image(*image);
+
+	{ // Copy Image data.
+#ifdef ENABLE_PROFILING
+		auto profile = _profiler_copy->track();
+#endif
+		copy_image(frame, *image);
+	}
+
+	_chunked->push(image, frame->pts);
+
+	*received_packet = _chunked->pop(packet);
+	if (!*received_packet) {
+		packet->type = OBS_ENCODER_VIDEO;
+		packet->data = nullptr;
+		packet->size = 0;
+		packet->pts  = -1;
+		packet->dts  = -1;
+	}
+
+	return true;
+}
+
+aom_av1_chunk_encoder::aom_av1_chunk_encoder(aom_av1_instance* parent) : _parent(parent), _ctx(), _extra_data()
+{
+	auto& factory = _parent->_factory;
+
+	if (auto error = factory->libaom_codec_enc_init_ver(&_ctx, _parent->_iface, &_parent->_cfg, 0,
+														AOM_ENCODER_ABI_VERSION);
+		error != AOM_CODEC_OK) {
+		throw std::runtime_error(factory->libaom_codec_err_to_string(error));
+	}
+
+	_parent->apply_static_controls(&_ctx);
+	_parent->apply_dynamic_controls(&_ctx);
+}
+
+aom_av1_chunk_encoder::~aom_av1_chunk_encoder()
+{
+	_parent->_factory->libaom_codec_destroy(&_ctx);
+}
+
+void aom_av1_chunk_encoder::encode(std::shared_ptr<void> frame, int64_t pts, bool keyframe,
+								   std::list<::streamfx::encoder::chunked::packet>& packets)
+{
+	auto& factory = _parent->_factory;
+	auto  image   = std::static_pointer_cast<aom_image_t>(frame);
+
+	aom_enc_frame_flags_t flags = 0;
+	if (keyframe || (_parent->_cfg.g_usage == AOM_USAGE_ALL_INTRA)) {
+		flags = AOM_EFLAG_FORCE_KF;
+	}
+	if (auto error = factory->libaom_codec_encode(&_ctx, image.get(), pts, 1, flags); error != AOM_CODEC_OK) {
+		throw std::runtime_error(factory->libaom_codec_err_to_string(error));
+	}
+
+	drain(packets);
+}
+
+void aom_av1_chunk_encoder::flush(std::list<::streamfx::encoder::chunked::packet>& packets)
+{
+	auto& factory = _parent->_factory;
+
+	// The encoder keeps returning delayed frames for as long as we keep asking.
+	do {
+		if (auto error = factory->libaom_codec_encode(&_ctx, nullptr, 0, 1, 0); error != AOM_CODEC_OK) {
+			throw std::runtime_error(factory->libaom_codec_err_to_string(error));
+		}
+	} while (drain(packets));
+}
+
+std::vector<uint8_t> aom_av1_chunk_encoder::extra_data()
+{
+	return _extra_data;
+}
+
+bool aom_av1_chunk_encoder::drain(std::list<::streamfx::encoder::chunked::packet>& packets)
+{
+	auto& factory = _parent->_factory;
+	bool  found   = false;
+
+	aom_codec_iter_t iter = NULL;
+	for (auto* pkt = factory->libaom_codec_get_cx_data(&_ctx, &iter); pkt != nullptr;
+		 pkt       = factory->libaom_codec_get_cx_data(&_ctx, &iter)) {
+		if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) {
+			continue;
+		}
+
+		::streamfx::encoder::chunked::packet packet;
+		packet.keyframe = ((pkt->data.frame.flags & AOM_FRAME_IS_KEY) == AOM_FRAME_IS_KEY)
+						  || (_parent->_cfg.g_usage == AOM_USAGE_ALL_INTRA);
+		get_packet_priority(packet.keyframe, pkt->data.frame.flags, packet.priority, packet.drop_priority);
+		packet.data.assign(static_cast<uint8_t*>(pkt->data.frame.buf),
+						   static_cast<uint8_t*>(pkt->data.frame.buf) + pkt->data.frame.sz);
+		packet.pts = pkt->data.frame.pts;
+		packet.dts = pkt->data.frame.pts;
+		if (_extra_data.empty() && packet.keyframe) {
+			codec::av1::extract_sequence_header(packet.data.data(), packet.data.size(), _extra_data);
+		}
+		packets.push_back(std::move(packet));
+		found = true;
+	}
+
+	return found;
+}
+
 aom_av1_factory::aom_av1_factory()
 {
 	// Try and load the AOM library.
@@ -1334,6 +1525,7 @@ void aom_av1_factory::get_defaults2(obs_data_t* settings)
 
 	{ // Advanced Options
 		obs_data_set_default_int(settings, ST_KEY_ADVANCED_THREADS, 0);
+		obs_data_set_default_int(settings, ST_KEY_ADVANCED_PARALLELGOPS, 0);
 		obs_data_set_default_int(settings, ST_KEY_ADVANCED_ROWMULTITHREADING, -1);
 		obs_data_set_default_int(settings, ST_KEY_ADVANCED_TILE_COLUMNS, -1);
 		obs_data_set_default_int(settings, ST_KEY_ADVANCED_TILE_ROWS, -1);
@@ -1608,6 +1800,13 @@ obs_properties_t* aom_av1_factory::get_properties2(instance_t* data)
 											std::numeric_limits<int32_t>::max(), 1);
 		}
 
+		{ // Parallel GOPs
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_ADVANCED_PARALLELGOPS,
+												   D_TRANSLATE(ST_I18N_ADVANCED_PARALLELGOPS), 0,
+												   static_cast<int64_t>(std::thread::hardware_concurrency()), 1);
+			obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_ADVANCED_PARALLELGOPS_DESCRIPTION));
+		}
+
 #ifdef AOM_CTRL_AV1E_SET_ROW_MT
 		{ // Row-MT
 			auto p = streamfx::util::obs_properties_add_tristate(grp, ST_KEY_ADVANCED_ROWMULTITHREADING,
@@ -23,6 +23,7 @@
 #include <memory>
 #include <queue>
 #include "encoders/codecs/av1.hpp"
+#include "encoders/encoder-chunked.hpp"
 #include "obs/obs-encoder-factory.hpp"
 #include "util/util-library.hpp"
 #include "util/util-profiler.hpp"
@@ -31,6 +32,7 @@
 
 namespace streamfx::encoder::aom::av1 {
 	class aom_av1_factory;
+	class aom_av1_chunk_encoder;
 
 	class aom_av1_instance : public obs::encoder_instance {
 		std::shared_ptr<aom_av1_factory> _factory;
@@ -83,14 +85,21 @@ namespace streamfx::encoder::aom::av1 {
 			int32_t     kf_distance_max;
 
 			// Threads and Tiling (All Static)
-			int8_t           threads;
+			int32_t          threads;
 			int8_t           rowmultithreading;
 			int8_t           tile_columns;
 			int8_t           tile_rows;
 			aom_tune_metric  tune_metric;
 			aom_tune_content tune_content;
+
+			// Parallel GOP Encoding (Static)
+			int32_t parallel_gops;
 		} _settings;
 
+		std::shared_ptr<::streamfx::encoder::chunked::scheduler> _chunked;
+
+		friend class aom_av1_chunk_encoder;
+
 #ifdef ENABLE_PROFILING
 		std::shared_ptr<streamfx::util::profiler> _profiler_copy;
 		std::shared_ptr<streamfx::util::profiler> _profiler_encode;
@@ -114,6 +123,37 @@ namespace streamfx::encoder::aom::av1 {
 		virtual void get_video_info(struct video_scale_info* info);
 
 		virtual bool encode_video(encoder_frame* frame, encoder_packet* packet, bool* received_packet);
+
+		private:
+		void initialize_image(aom_image_t& image);
+
+		void apply_static_controls(aom_codec_ctx_t* ctx);
+
+		void apply_dynamic_controls(aom_codec_ctx_t* ctx);
+
+		bool encode_chunked(encoder_frame* frame, encoder_packet* packet, bool* received_packet);
+	};
+
+	class aom_av1_chunk_encoder : public ::streamfx::encoder::chunked::chunk_encoder {
+		aom_av1_instance*    _parent;
+		aom_codec_ctx_t      _ctx;
+		std::vector<uint8_t> _extra_data;
+
+		friend class aom_av1_instance;
+
+		public:
+		aom_av1_chunk_encoder(aom_av1_instance* parent);
+		virtual ~aom_av1_chunk_encoder();
+
+		void encode(std::shared_ptr<void> frame, int64_t pts, bool keyframe,
+					std::list<::streamfx::encoder::chunked::packet>& packets) override;
+
+		void flush(std::list<::streamfx::encoder::chunked::packet>& packets) override;
+
+		std::vector<uint8_t> extra_data() override;
+
+		private:
+		bool drain(std::list<::streamfx::encoder::chunked::packet>& packets);
 	};
 
 	class aom_av1_factory : public obs::encoder_factory<aom_av1_factory, aom_av1_instance> {
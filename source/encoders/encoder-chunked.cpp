@@ -0,0 +1,274 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "encoder-chunked.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<encoder::chunked> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+using namespace streamfx::encoder::chunked;
+
+bool streamfx::encoder::chunked::is_tail_disposable(obs_encoder_t* encoder)
+{
+	struct data_t {
+		obs_encoder_t* encoder;
+		bool           found;
+		bool           disposable;
+	} data = {encoder, false, true};
+
+	obs_enum_outputs(
+		[](void* param, obs_output_t* output) {
+			auto data = static_cast<data_t*>(param);
+			if (obs_output_get_video_encoder(output) != data->encoder) {
+				return true;
+			}
+
+			// Only outputs which hand everything to a service never write a file.
+			data->found = true;
+			if ((obs_output_get_flags(output) & OBS_OUTPUT_SERVICE) == 0) {
+				data->disposable = false;
+				return false;
+			}
+			return true;
+		},
+		&data);
+
+	// Outputs are assigned their encoders before starting them, so not finding any means we can't tell.
+	return data.found && data.disposable;
+}
+
+scheduler::scheduler(std::size_t gop_size, std::size_t concurrency, chunk_encoder_factory_t factory)
+	: _gop_size(gop_size), _concurrency(concurrency), _factory(factory), _lock(), _cv(), _chunks(), _current(),
+	  _spare(), _next_index(0), _in_flight(0), _failed(false), _abort(false), _extra_data(), _have_extra_data(false),
+	  _output(), _packet(), _last_dts(0), _have_dts(false)
+{
+	if (_gop_size == 0) {
+		throw std::invalid_argument("Parallel encoding requires a fixed key frame interval.");
+	}
+	if (_concurrency == 0) {
+		throw std::invalid_argument("Parallel encoding requires at least one concurrent chunk.");
+	}
+	if (!_factory) {
+		throw std::invalid_argument("Parallel encoding requires a way to create codec contexts.");
+	}
+
+	// The first chunk uses this context, which also reports configuration errors while they can still be shown.
+	_spare = _factory();
+
+	D_LOG_INFO("Encoding up to %" PRIuPTR " chunks of %" PRIuPTR " frames concurrently.", _concurrency, _gop_size);
+}
+
+scheduler::~scheduler()
+{
+	// Nothing retrieves packets anymore, so don't bother finishing outstanding chunks. They still reference us though.
+	_abort = true;
+
+	std::unique_lock<std::mutex> lock(_lock);
+	_cv.wait(lock, [this]() { return _in_flight == 0; });
+}
+
+void scheduler::push(std::shared_ptr<void> frame, int64_t pts)
+{
+	if (!_current) {
+		_current           = std::make_shared<chunk>();
+		_current->index    = _next_index++;
+		_current->complete = false;
+		_current->failed   = false;
+		_current->frames.reserve(_gop_size);
+	}
+
+	_current->frames.emplace_back(pts, frame);
+
+	if (_current->frames.size() >= _gop_size) {
+		submit();
+	}
+}
+
+bool scheduler::pop(struct encoder_packet* packet)
+{
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		if (_failed) {
+			throw std::runtime_error("One or more chunks failed to encode.");
+		}
+		collect();
+	}
+
+	if (_output.empty()) {
+		return false;
+	}
+
+	_packet = std::move(_output.front());
+	_output.pop_front();
+
+	// Only possible if a chunk reordered frames after all, which no muxer would accept.
+	if (_have_dts && (_packet.dts <= _last_dts)) {
+		throw std::runtime_error("Decode timestamps of consecutive chunks overlap.");
+	}
+	_last_dts = _packet.dts;
+	_have_dts = true;
+
+	packet->type          = OBS_ENCODER_VIDEO;
+	packet->data          = _packet.data.data();
+	packet->size          = _packet.data.size();
+	packet->pts           = _packet.pts;
+	packet->dts           = _packet.dts;
+	packet->keyframe      = _packet.keyframe;
+	packet->priority      = _packet.priority;
+	packet->drop_priority = _packet.drop_priority;
+	return true;
+}
+
+void scheduler::flush()
+{
+	if (_current && !_current->frames.empty()) {
+		submit();
+	}
+
+	std::unique_lock<std::mutex> lock(_lock);
+	_cv.wait(lock, [this]() { return _in_flight == 0; });
+	if (_failed) {
+		throw std::runtime_error("One or more chunks failed to encode.");
+	}
+	collect();
+}
+
+bool scheduler::extra_data(std::vector<uint8_t>& data)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	if (!_have_extra_data) {
+		return false;
+	}
+
+	data = _extra_data;
+	return true;
+}
+
+std::size_t scheduler::gop_size()
+{
+	return _gop_size;
+}
+
+std::size_t scheduler::concurrency()
+{
+	return _concurrency;
+}
+
+void scheduler::submit()
+{
+	std::shared_ptr<chunk> work = _current;
+	_current.reset();
+
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+
+		// Wait until a slot frees up, which bounds both memory usage and latency.
+		_cv.wait(lock, [this]() { return (_in_flight < _concurrency) || _failed; });
+		if (_failed) {
+			throw std::runtime_error("One or more chunks failed to encode.");
+		}
+
+		_chunks.push_back(work);
+		_in_flight++;
+	}
+
+	streamfx::threadpool()->push(std::bind(&scheduler::task, this, std::placeholders::_1), work);
+}
+
+void scheduler::collect()
+{
+	// Only move complete chunks in order, a later chunk may finish before an earlier one.
+	while (!_chunks.empty() && _chunks.front()->complete) {
+		_output.splice(_output.end(), _chunks.front()->packets);
+		_chunks.pop_front();
+	}
+}
+
+void scheduler::task(std::shared_ptr<void> data)
+{
+	auto work = std::static_pointer_cast<chunk>(data);
+
+	try {
+		std::shared_ptr<chunk_encoder> encoder;
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			encoder.swap(_spare);
+		}
+		if (!encoder) {
+			encoder = _factory();
+		}
+
+		bool first = true;
+		for (auto& kv : work->frames) {
+			// Once a chunk has failed, nothing after it can be delivered anymore.
+			if (_abort) {
+				break;
+			}
+
+			encoder->encode(kv.second, kv.first, first, work->packets);
+			kv.second.reset();
+			first = false;
+		}
+		encoder->flush(work->packets);
+
+		// Every chunk is decoded with the headers OBS was given, so they must not differ between chunks.
+		auto extra_data = encoder->extra_data();
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			if (!_have_extra_data) {
+				_extra_data      = std::move(extra_data);
+				_have_extra_data = true;
+			} else if (extra_data != _extra_data) {
+				throw std::runtime_error("Codec headers differ from those of previous chunks.");
+			}
+		}
+	} catch (std::exception const& ex) {
+		D_LOG_ERROR("Chunk %" PRIu64 " failed to encode: %s", work->index, ex.what());
+		work->failed = true;
+	} catch (...) {
+		D_LOG_ERROR("Chunk %" PRIu64 " failed to encode.", work->index);
+		work->failed = true;
+	}
+	work->frames.clear();
+
+	{
+		std::unique_lock<std::mutex> lock(_lock);
+		work->complete = true;
+		_failed        = _failed || work->failed;
+		_in_flight--;
+		if (_failed) {
+			_abort = true;
+		}
+	}
+	_cv.notify_all();
+}
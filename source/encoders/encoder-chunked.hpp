@@ -0,0 +1,152 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+
+namespace streamfx::encoder::chunked {
+	struct packet {
+		std::vector<uint8_t> data;
+		int64_t              pts;
+		int64_t              dts;
+		bool                 keyframe;
+		int32_t              priority;
+		int32_t              drop_priority;
+	};
+
+	/** A single codec context which encodes exactly one closed GOP.
+	 *
+	 * The scheduler creates a fresh instance for every chunk and destroys it once flushed, so no state can leak from
+	 * one GOP into the next. Implementations are only ever used from one thread at a time.
+	 */
+	class chunk_encoder {
+		public:
+		virtual ~chunk_encoder(){};
+
+		/** Encode a single frame and append any produced packets.
+		 *
+		 * @param frame Frame data as handed to scheduler::push().
+		 * @param pts Presentation timestamp of the frame.
+		 * @param keyframe Set for the first frame of a chunk, which must be encoded as a key frame.
+		 */
+		virtual void encode(std::shared_ptr<void> frame, int64_t pts, bool keyframe, std::list<packet>& packets) = 0;
+
+		/** Drain all delayed packets from the context. */
+		virtual void flush(std::list<packet>& packets) = 0;
+
+		/** Codec headers of the stream produced so far, which must be identical for every chunk.
+		 *
+		 * Only called after flush(). Empty if the codec has no headers or they weren't found.
+		 */
+		virtual std::vector<uint8_t> extra_data() = 0;
+	};
+	typedef std::function<std::shared_ptr<chunk_encoder>()> chunk_encoder_factory_t;
+
+	/** Check if every output fed by the encoder can do without the last few chunks.
+	 *
+	 * OBS never asks an encoder for delayed packets once an output stops, so up to 'concurrency' chunks are lost at
+	 * the end. Streams merely end a few seconds early, but recordings and replays would be missing their end.
+	 */
+	bool is_tail_disposable(obs_encoder_t* encoder);
+
+	/** Splits the input into closed GOPs and encodes several of them concurrently.
+	 *
+	 * Frames are collected into chunks of 'gop_size' frames, each of which is handed to the thread pool and encoded on
+	 * its own context. Packets are returned strictly in input order, so the output is indistinguishable from a single
+	 * encoder with a fixed key frame interval, just delayed by up to 'concurrency' chunks.
+	 *
+	 * Chunks must not reorder frames. A fresh context starts its decode timestamps anew, which would overlap with those
+	 * of the previous chunk, and there is no way to shift them that keeps them below the presentation timestamps.
+	 *
+	 * The first context is created right away, so that invalid configurations are reported by the constructor and not
+	 * by some later chunk.
+	 */
+	class scheduler {
+		struct chunk {
+			uint64_t                                               index;
+			std::vector<std::pair<int64_t, std::shared_ptr<void>>> frames;
+			std::list<packet>                                      packets;
+			bool                                                   complete;
+			bool                                                   failed;
+		};
+
+		std::size_t             _gop_size;
+		std::size_t             _concurrency;
+		chunk_encoder_factory_t _factory;
+
+		std::mutex                        _lock;
+		std::condition_variable           _cv;
+		std::list<std::shared_ptr<chunk>> _chunks;
+		std::shared_ptr<chunk>            _current;
+		std::shared_ptr<chunk_encoder>    _spare;
+		uint64_t                          _next_index;
+		std::size_t                       _in_flight;
+		bool                              _failed;
+		std::atomic<bool>                 _abort;
+		std::vector<uint8_t>              _extra_data;
+		bool                              _have_extra_data;
+		std::list<packet>                 _output;
+		packet                            _packet;
+		int64_t                           _last_dts;
+		bool                              _have_dts;
+
+		public:
+		scheduler(std::size_t gop_size, std::size_t concurrency, chunk_encoder_factory_t factory);
+		~scheduler();
+
+		/** Queue a frame for encoding.
+		 *
+		 * Blocks while 'concurrency' chunks are already being encoded, which keeps memory usage bounded and lets OBS
+		 * notice when the encoder can't keep up.
+		 */
+		void push(std::shared_ptr<void> frame, int64_t pts);
+
+		/** Retrieve the next packet in output order, if one is ready.
+		 *
+		 * The packet data remains valid until the next call.
+		 */
+		bool pop(struct encoder_packet* packet);
+
+		/** Encode everything queued so far, including a partial chunk, and wait until it is done.
+		 *
+		 * The resulting packets are returned by pop() as usual. Further frames start a new chunk.
+		 */
+		void flush();
+
+		/** Codec headers shared by all chunks, available once the first chunk is complete. */
+		bool extra_data(std::vector<uint8_t>& data);
+
+		std::size_t gop_size();
+
+		std::size_t concurrency();
+
+		private:
+		void submit();
+
+		void collect();
+
+		void task(std::shared_ptr<void> data);
+	};
+} // namespace streamfx::encoder::chunked
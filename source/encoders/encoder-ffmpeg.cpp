@@ -71,6 +71,9 @@ extern "C" {
 #define ST_KEY_FFMPEG_THREADS "FFmpeg.Threads"
 #define ST_I18N_FFMPEG_GPU ST_I18N_FFMPEG ".GPU"
 #define ST_KEY_FFMPEG_GPU "FFmpeg.GPU"
+#define ST_I18N_FFMPEG_PARALLELGOPS ST_I18N_FFMPEG ".ParallelGOPs"
+#define ST_I18N_FFMPEG_PARALLELGOPS_DESCRIPTION ST_I18N_FFMPEG_PARALLELGOPS ".Description"
+#define ST_KEY_FFMPEG_PARALLELGOPS "FFmpeg.ParallelGOPs"
 
 #define ST_I18N_KEYFRAMES ST_I18N_FFMPEG ".KeyFrames"
 #define ST_I18N_KEYFRAMES_INTERVALTYPE ST_I18N_KEYFRAMES ".IntervalType"
@@ -92,13 +95,15 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 
 	  _codec(_factory->get_avcodec()), _context(nullptr), _handler(ffmpeg_manager::get()->get_handler(_codec->name)),
 
-	  _scaler(), _packet(),
+	  _scaler(), _converter(), _packet(),
 
 	  _hwapi(), _hwinst(),
 
 	  _lag_in_frames(0), _sent_frames(0), _have_first_frame(false), _extra_data(), _sei_data(),
 
-	  _free_frames(), _used_frames(), _free_frames_last_used()
+	  _free_frames(), _used_frames(), _free_frames_last_used(),
+
+	  _chunked()
 {
 	// Initialize GPU Stuff
 	if (is_hw) {
@@ -143,20 +148,52 @@ ffmpeg_instance::ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool
 	// Update settings
 	update(settings);
 
-	// Initialize Encoder
-	auto gctx = streamfx::obs::gs::context();
-	int  res  = avcodec_open2(_context, _codec, NULL);
-	if (res < 0) {
-		throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+	// Parallel GOP Encoding
+	if (!is_hw && (_codec->type == AVMEDIA_TYPE_VIDEO)) {
+		int64_t     value  = obs_data_get_int(settings, ST_KEY_FFMPEG_PARALLELGOPS);
+		std::size_t chunks = static_cast<size_t>(std::max<int64_t>(value, 0));
+		if ((chunks > 0) && (_context->gop_size <= 0)) {
+			DLOG_WARNING("[%s] Parallel GOP encoding requires a fixed key frame interval, ignoring.", _codec->name);
+		} else if ((chunks > 0) && !::streamfx::encoder::chunked::is_tail_disposable(_self)) {
+			DLOG_WARNING("[%s] Parallel GOP encoding loses the end of recordings, ignoring.", _codec->name);
+		} else if (chunks > 0) {
+			// Each chunk gets its own context, so split the automatic thread count between them.
+			if ((obs_data_get_int(settings, ST_KEY_FFMPEG_THREADS) <= 0) && (_context->thread_type != 0)) {
+				_context->thread_count =
+					std::max<int>(static_cast<int>(std::thread::hardware_concurrency() / chunks), 1);
+			}
+
+			// Chunks can't be stitched together if they reorder frames.
+			if (_context->max_b_frames != 0) {
+				DLOG_INFO("[%s] Parallel GOP encoding disables B-Frames.", _codec->name);
+				_context->max_b_frames = 0;
+			}
+
+			_chunked = std::make_shared<::streamfx::encoder::chunked::scheduler>(
+				static_cast<size_t>(_context->gop_size), chunks,
+				[this]() { return std::make_shared<ffmpeg_chunk_encoder>(this); });
+		}
+	}
+
+	// Initialize Encoder, software encoders never touch the graphics context. Chunks open their own copies instead.
+	if (!_chunked) {
+		auto gctx = streamfx::obs::gs::context(static_cast<bool>(_hwinst));
+		int  res  = avcodec_open2(_context, _codec, NULL);
+		if (res < 0) {
+			throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+		}
 	}
 }
 
 ffmpeg_instance::~ffmpeg_instance()
 {
-	auto gctx = streamfx::obs::gs::context();
+	// Wait for outstanding chunks before taking the graphics context, they never need it.
+	_chunked.reset();
+
+	auto gctx = streamfx::obs::gs::context(static_cast<bool>(_hwinst));
 	if (_context) {
 		// Flush encoders that require it.
-		if ((_codec->capabilities & AV_CODEC_CAP_DELAY) != 0) {
+		if (((_codec->capabilities & AV_CODEC_CAP_DELAY) != 0) && avcodec_is_open(_context)) {
 			avcodec_send_frame(_context, nullptr);
 			while (avcodec_receive_packet(_context, &_packet) >= 0) {
 				avcodec_send_frame(_context, nullptr);
@@ -171,6 +208,7 @@ ffmpeg_instance::~ffmpeg_instance()
 
 	av_packet_unref(&_packet);
 
+	_converter.finalize();
 	_scaler.finalize();
 }
 
@@ -185,6 +223,7 @@ void ffmpeg_instance::get_properties(obs_properties_t* props)
 
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_THREADS), false);
 	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_GPU), false);
+	obs_property_set_enabled(obs_properties_get(props, ST_KEY_FFMPEG_PARALLELGOPS), false);
 }
 
 void ffmpeg_instance::migrate(obs_data_t* settings, uint64_t version)
@@ -195,6 +234,10 @@ void ffmpeg_instance::migrate(obs_data_t* settings, uint64_t version)
 
 bool ffmpeg_instance::update(obs_data_t* settings)
 {
+	// Chunks are opened from the template context as configured at creation, which therefore must stay as it is.
+	if (_chunked)
+		return true;
+
 	bool support_reconfig           = false;
 	bool support_reconfig_threads   = false;
 	bool support_reconfig_gpu       = false;
@@ -294,6 +337,9 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 				  ::streamfx::ffmpeg::tools::get_std_compliance_name(_context->strict_std_compliance));
 		DLOG_INFO("[%s]     Threading: %s (with %i threads)", _codec->name,
 				  ::streamfx::ffmpeg::tools::get_thread_type_name(_context->thread_type), _context->thread_count);
+		if (!_hwinst)
+			DLOG_INFO("[%s]     Parallel GOPs: %lli", _codec->name,
+					  obs_data_get_int(settings, ST_KEY_FFMPEG_PARALLELGOPS));
 
 		DLOG_INFO("[%s]   Video:", _codec->name);
 		if (_hwinst) {
@@ -312,6 +358,8 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 					  ::streamfx::ffmpeg::tools::get_pixel_format_name(_scaler.get_target_format()),
 					  ::streamfx::ffmpeg::tools::get_color_space_name(_scaler.get_target_colorspace()),
 					  _scaler.is_target_full_range() ? "Full" : "Partial");
+			DLOG_INFO("[%s]     Conversion: %s", _codec->name,
+					  _converter.is_available() ? _converter.get_name() : "swscale");
 			if (!_hwinst)
 				DLOG_INFO("[%s]     On GPU Index: %lli", _codec->name, obs_data_get_int(settings, ST_KEY_FFMPEG_GPU));
 		}
@@ -335,7 +383,7 @@ bool ffmpeg_instance::update(obs_data_t* settings)
 	return true;
 }
 
-static inline void copy_data(encoder_frame* frame, AVFrame* vframe)
+void streamfx::encoder::ffmpeg::copy_data(encoder_frame* frame, AVFrame* vframe)
 {
 	int h_chroma_shift, v_chroma_shift;
 	av_pix_fmt_get_chroma_sub_sample(static_cast<AVPixelFormat>(vframe->format), &h_chroma_shift, &v_chroma_shift);
@@ -372,7 +420,8 @@ bool ffmpeg_instance::encode_audio(struct encoder_frame* frame, struct encoder_p
 
 bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_packet* packet, bool* received_packet)
 {
-	std::shared_ptr<AVFrame> vframe = pop_free_frame(); // Retrieve an empty frame.
+	// Chunks hold on to their frames until they are encoded, so they can't come from the pool.
+	std::shared_ptr<AVFrame> vframe = _chunked ? allocate_frame() : pop_free_frame(); // Retrieve an empty frame.
 
 	// Convert frame.
 	{
@@ -388,6 +437,8 @@ bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_p
 			&& (_scaler.get_source_colorspace() == _scaler.get_target_colorspace())
 			&& (_scaler.get_source_format() == _scaler.get_target_format())) {
 			copy_data(frame, vframe.get());
+		} else if (_converter.is_available()) {
+			_converter.convert(frame->data, reinterpret_cast<int*>(frame->linesize), vframe->data, vframe->linesize);
 		} else {
 			int res = _scaler.convert(reinterpret_cast<uint8_t**>(frame->data), reinterpret_cast<int*>(frame->linesize),
 									  0, _context->height, vframe->data, vframe->linesize);
@@ -399,6 +450,9 @@ bool ffmpeg_instance::encode_video(struct encoder_frame* frame, struct encoder_p
 		}
 	}
 
+	if (_chunked)
+		return encode_chunked(vframe, packet, received_packet);
+
 	if (!encode_avframe(vframe, packet, received_packet))
 		return false;
 
@@ -482,6 +536,9 @@ void ffmpeg_instance::initialize_sw(obs_data_t* settings)
 				 << (_scaler.is_source_full_range() ? "full" : "partial") << " range.";
 			throw std::runtime_error(sstr.str());
 		}
+
+		// Common conversions have a faster path, which is only used if it produces the same result as swscale.
+		_converter.initialize(_scaler);
 	}
 }
 
@@ -534,6 +591,29 @@ void ffmpeg_instance::push_free_frame(std::shared_ptr<AVFrame> frame)
 	}
 }
 
+std::shared_ptr<AVFrame> ffmpeg_instance::allocate_frame()
+{
+	std::shared_ptr<AVFrame> frame;
+	if (_hwinst) {
+		frame = _hwinst->allocate_frame(_context->hw_frames_ctx);
+	} else {
+		frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) {
+			av_frame_unref(frame);
+			av_frame_free(&frame);
+		});
+
+		frame->width  = _context->width;
+		frame->height = _context->height;
+		frame->format = _context->pix_fmt;
+
+		int res = av_frame_get_buffer(frame.get(), 32);
+		if (res < 0) {
+			throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+		}
+	}
+	return frame;
+}
+
 std::shared_ptr<AVFrame> ffmpeg_instance::pop_free_frame()
 {
 	std::shared_ptr<AVFrame> frame;
@@ -542,23 +622,7 @@ std::shared_ptr<AVFrame> ffmpeg_instance::pop_free_frame()
 		frame = _free_frames.top();
 		_free_frames.pop();
 	} else {
-		if (_hwinst) {
-			frame = _hwinst->allocate_frame(_context->hw_frames_ctx);
-		} else {
-			frame = std::shared_ptr<AVFrame>(av_frame_alloc(), [](AVFrame* frame) {
-				av_frame_unref(frame);
-				av_frame_free(&frame);
-			});
-
-			frame->width  = _context->width;
-			frame->height = _context->height;
-			frame->format = _context->pix_fmt;
-
-			int res = av_frame_get_buffer(frame.get(), 32);
-			if (res < 0) {
-				throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
-			}
-		}
+		frame = allocate_frame();
 	}
 
 	return frame;
@@ -604,6 +668,53 @@ void ffmpeg_instance::get_video_info(struct video_scale_info* info)
 	}
 }
 
+static void get_packet_priority(AVPacket const& pkt, int& priority, int& drop_priority)
+{
+	priority      = (pkt.flags & AV_PKT_FLAG_KEY) ? 3 : 2;
+	drop_priority = 3;
+	for (size_t idx = 0, edx = pkt.side_data_elems; idx < edx; idx++) {
+		auto const& side_data = pkt.side_data[idx];
+		if (side_data.type == AV_PKT_DATA_QUALITY_STATS) {
+			// Decisions based on picture type, if present.
+			switch (side_data.data[sizeof(uint32_t)]) {
+			case AV_PICTURE_TYPE_I:  // I-Frame
+			case AV_PICTURE_TYPE_SI: // Switching I-Frame
+				if (pkt.flags & AV_PKT_FLAG_KEY) {
+					// Recovery only via IDR-Frame.
+					priority      = 3; // OBS_NAL_PRIORITY_HIGHEST
+					drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
+				} else {
+					// Recovery via I- or IDR-Frame.
+					priority      = 2; // OBS_NAL_PRIORITY_HIGH
+					drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
+				}
+				break;
+			case AV_PICTURE_TYPE_P:  // P-Frame
+			case AV_PICTURE_TYPE_SP: // Switching P-Frame
+				// Recovery via I- or IDR-Frame.
+				priority      = 1; // OBS_NAL_PRIORITY_LOW
+				drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
+				break;
+			case AV_PICTURE_TYPE_B: // B-Frame
+				// Recovery via I- or IDR-Frame.
+				priority      = 0; // OBS_NAL_PRIORITY_DISPOSABLE
+				drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
+				break;
+			case AV_PICTURE_TYPE_BI: // BI-Frame, theoretically identical to I-Frame.
+				// Recovery via I- or IDR-Frame.
+				priority      = 2; // OBS_NAL_PRIORITY_HIGH
+				drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
+				break;
+			default: // Unknown picture type.
+				// Recovery only via IDR-Frame
+				priority      = 2; // OBS_NAL_PRIORITY_HIGH
+				drop_priority = 3; // OBS_NAL_PRIORITY_HIGHEST
+				break;
+			}
+		}
+	}
+}
+
 int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet* packet)
 {
 	int res = 0;
@@ -611,7 +722,7 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 	av_packet_unref(&_packet);
 
 	{
-		auto gctx = streamfx::obs::gs::context();
+		auto gctx = streamfx::obs::gs::context(static_cast<bool>(_hwinst));
 		res       = avcodec_receive_packet(_context, &_packet);
 	}
 	if (res != 0) {
@@ -619,38 +730,7 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 	}
 
 	if (!_have_first_frame) {
-		if (_codec->id == AV_CODEC_ID_H264) {
-			uint8_t*    tmp_packet;
-			uint8_t*    tmp_header;
-			uint8_t*    tmp_sei;
-			std::size_t sz_packet, sz_header, sz_sei;
-
-			obs_extract_avc_headers(_packet.data, static_cast<size_t>(_packet.size), &tmp_packet, &sz_packet,
-									&tmp_header, &sz_header, &tmp_sei, &sz_sei);
-
-			if (sz_header) {
-				_extra_data.resize(sz_header);
-				std::memcpy(_extra_data.data(), tmp_header, sz_header);
-			}
-
-			if (sz_sei) {
-				_sei_data.resize(sz_sei);
-				std::memcpy(_sei_data.data(), tmp_sei, sz_sei);
-			}
-
-			// Not required, we only need the Extra Data and SEI Data anyway.
-			//std::memcpy(_current_packet.data, tmp_packet, sz_packet);
-			//_current_packet.size = static_cast<int>(sz_packet);
-
-			bfree(tmp_packet);
-			bfree(tmp_header);
-			bfree(tmp_sei);
-		} else if (_codec->id == AV_CODEC_ID_HEVC) {
-			hevc::extract_header_sei(_packet.data, static_cast<size_t>(_packet.size), _extra_data, _sei_data);
-		} else if (_context->extradata != nullptr) {
-			_extra_data.resize(static_cast<size_t>(_context->extradata_size));
-			std::memcpy(_extra_data.data(), _context->extradata, static_cast<size_t>(_context->extradata_size));
-		}
+		extract_headers(_packet.data, static_cast<size_t>(_packet.size));
 		_have_first_frame = true;
 	}
 
@@ -669,49 +749,7 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 
 	// Figure out priority and drop_priority.
 	// In theory, this is done by OBS, but its not doing a great job.
-	packet->priority      = packet->keyframe ? 3 : 2;
-	packet->drop_priority = 3;
-	for (size_t idx = 0, edx = _packet.side_data_elems; idx < edx; idx++) {
-		auto& side_data = _packet.side_data[idx];
-		if (side_data.type == AV_PKT_DATA_QUALITY_STATS) {
-			// Decisions based on picture type, if present.
-			switch (side_data.data[sizeof(uint32_t)]) {
-			case AV_PICTURE_TYPE_I:  // I-Frame
-			case AV_PICTURE_TYPE_SI: // Switching I-Frame
-				if (_packet.flags & AV_PKT_FLAG_KEY) {
-					// Recovery only via IDR-Frame.
-					packet->priority      = 3; // OBS_NAL_PRIORITY_HIGHEST
-					packet->drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
-				} else {
-					// Recovery via I- or IDR-Frame.
-					packet->priority      = 2; // OBS_NAL_PRIORITY_HIGH
-					packet->drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
-				}
-				break;
-			case AV_PICTURE_TYPE_P:  // P-Frame
-			case AV_PICTURE_TYPE_SP: // Switching P-Frame
-				// Recovery via I- or IDR-Frame.
-				packet->priority      = 1; // OBS_NAL_PRIORITY_LOW
-				packet->drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
-				break;
-			case AV_PICTURE_TYPE_B: // B-Frame
-				// Recovery via I- or IDR-Frame.
-				packet->priority      = 0; // OBS_NAL_PRIORITY_DISPOSABLE
-				packet->drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
-				break;
-			case AV_PICTURE_TYPE_BI: // BI-Frame, theoretically identical to I-Frame.
-				// Recovery via I- or IDR-Frame.
-				packet->priority      = 2; // OBS_NAL_PRIORITY_HIGH
-				packet->drop_priority = 2; // OBS_NAL_PRIORITY_HIGH
-				break;
-			default: // Unknown picture type.
-				// Recovery only via IDR-Frame
-				packet->priority      = 2; // OBS_NAL_PRIORITY_HIGH
-				packet->drop_priority = 3; // OBS_NAL_PRIORITY_HIGHEST
-				break;
-			}
-		}
-	}
+	get_packet_priority(_packet, packet->priority, packet->drop_priority);
 
 	// Push free frame back into pool.
 	push_free_frame(pop_used_frame());
@@ -719,11 +757,48 @@ int ffmpeg_instance::receive_packet(bool* received_packet, struct encoder_packet
 	return res;
 }
 
+void ffmpeg_instance::extract_headers(uint8_t* data, std::size_t size)
+{
+	if (_codec->id == AV_CODEC_ID_H264) {
+		uint8_t*    tmp_packet;
+		uint8_t*    tmp_header;
+		uint8_t*    tmp_sei;
+		std::size_t sz_packet, sz_header, sz_sei;
+
+		obs_extract_avc_headers(data, size, &tmp_packet, &sz_packet, &tmp_header, &sz_header, &tmp_sei, &sz_sei);
+
+		if (sz_header) {
+			_extra_data.resize(sz_header);
+			std::memcpy(_extra_data.data(), tmp_header, sz_header);
+		}
+
+		if (sz_sei) {
+			_sei_data.resize(sz_sei);
+			std::memcpy(_sei_data.data(), tmp_sei, sz_sei);
+		}
+
+		// Not required, we only need the Extra Data and SEI Data anyway.
+		//std::memcpy(_current_packet.data, tmp_packet, sz_packet);
+		//_current_packet.size = static_cast<int>(sz_packet);
+
+		bfree(tmp_packet);
+		bfree(tmp_header);
+		bfree(tmp_sei);
+	} else if (_codec->id == AV_CODEC_ID_HEVC) {
+		hevc::extract_header_sei(data, size, _extra_data, _sei_data);
+	} else if (_context->extradata != nullptr) {
+		_extra_data.resize(static_cast<size_t>(_context->extradata_size));
+		std::memcpy(_extra_data.data(), _context->extradata, static_cast<size_t>(_context->extradata_size));
+	} else if (_chunked) {
+		_chunked->extra_data(_extra_data);
+	}
+}
+
 int ffmpeg_instance::send_frame(std::shared_ptr<AVFrame> const frame)
 {
 	int res = 0;
 	{
-		auto gctx = streamfx::obs::gs::context();
+		auto gctx = streamfx::obs::gs::context(static_cast<bool>(_hwinst));
 		res       = avcodec_send_frame(_context, frame.get());
 	}
 	if (res == 0) {
@@ -809,6 +884,67 @@ bool ffmpeg_instance::encode_avframe(std::shared_ptr<AVFrame> frame, encoder_pac
 	return true;
 }
 
+bool ffmpeg_instance::encode_chunked(std::shared_ptr<AVFrame> frame, encoder_packet* packet, bool* received_packet)
+{
+	_chunked->push(frame, frame->pts);
+
+	*received_packet = _chunked->pop(packet);
+	if (*received_packet && !_have_first_frame) {
+		extract_headers(packet->data, packet->size);
+		_have_first_frame = true;
+	}
+
+	return true;
+}
+
+AVCodecContext* ffmpeg_instance::clone_context()
+{
+	AVCodecContext* context = avcodec_alloc_context3(_codec);
+	if (!context) {
+		throw std::runtime_error("Failed to create encoder context.");
+	}
+
+	try {
+		// Copy everything that was configured through options, including codec private ones.
+		if (int res = av_opt_copy(context, _context); res < 0) {
+			throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+		}
+		if (_codec->priv_class && context->priv_data && _context->priv_data) {
+			if (int res = av_opt_copy(context->priv_data, _context->priv_data); res < 0) {
+				throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+			}
+		}
+
+		// Not everything is exposed as an option.
+		context->width                  = _context->width;
+		context->height                 = _context->height;
+		context->pix_fmt                = _context->pix_fmt;
+		context->sample_aspect_ratio    = _context->sample_aspect_ratio;
+		context->color_range            = _context->color_range;
+		context->colorspace             = _context->colorspace;
+		context->color_primaries        = _context->color_primaries;
+		context->color_trc              = _context->color_trc;
+		context->chroma_sample_location = _context->chroma_sample_location;
+		context->field_order            = _context->field_order;
+		context->time_base              = _context->time_base;
+		context->framerate              = _context->framerate;
+		context->ticks_per_frame        = _context->ticks_per_frame;
+		context->gop_size               = _context->gop_size;
+		context->keyint_min             = _context->keyint_min;
+		context->thread_type            = _context->thread_type;
+		context->thread_count           = _context->thread_count;
+
+		if (int res = avcodec_open2(context, _codec, NULL); res < 0) {
+			throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+		}
+	} catch (...) {
+		avcodec_free_context(&context);
+		throw;
+	}
+
+	return context;
+}
+
 bool ffmpeg_instance::is_hardware_encode()
 {
 	return _hwinst != nullptr;
@@ -949,6 +1085,108 @@ void ffmpeg_instance::parse_ffmpeg_commandline(std::string text)
 	}
 }
 
+ffmpeg_chunk_encoder::ffmpeg_chunk_encoder(ffmpeg_instance* parent)
+	: _parent(parent), _context(nullptr), _packet(nullptr), _extra_data(), _have_extra_data(false)
+{
+	_context = _parent->clone_context();
+
+	_packet = av_packet_alloc();
+	if (!_packet) {
+		avcodec_free_context(&_context);
+		throw std::bad_alloc();
+	}
+}
+
+ffmpeg_chunk_encoder::~ffmpeg_chunk_encoder()
+{
+	av_packet_free(&_packet);
+	avcodec_free_context(&_context);
+}
+
+void ffmpeg_chunk_encoder::encode(std::shared_ptr<void> frame, int64_t pts, bool keyframe,
+								  std::list<::streamfx::encoder::chunked::packet>& packets)
+{
+	auto vframe       = std::static_pointer_cast<AVFrame>(frame);
+	vframe->pts       = pts;
+	vframe->pict_type = keyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+
+	// Nothing else competes for this context, so simply drain it whenever it is full.
+	int res;
+	while ((res = avcodec_send_frame(_context, vframe.get())) == AVERROR(EAGAIN)) {
+		drain(packets);
+	}
+	if (res < 0) {
+		throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+	}
+
+	drain(packets);
+}
+
+void ffmpeg_chunk_encoder::flush(std::list<::streamfx::encoder::chunked::packet>& packets)
+{
+	if (int res = avcodec_send_frame(_context, nullptr); (res < 0) && (res != AVERROR_EOF)) {
+		throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+	}
+
+	drain(packets);
+}
+
+void ffmpeg_chunk_encoder::drain(std::list<::streamfx::encoder::chunked::packet>& packets)
+{
+	int res;
+	while ((res = avcodec_receive_packet(_context, _packet)) == 0) {
+		if (_parent->_handler)
+			_parent->_handler->process_avpacket(*_packet, _parent->_codec, _context);
+
+		if (!_have_extra_data) {
+			extract_headers();
+			_have_extra_data = true;
+		}
+
+		::streamfx::encoder::chunked::packet pkt;
+		pkt.data.assign(_packet->data, _packet->data + _packet->size);
+		pkt.pts      = _packet->pts;
+		pkt.dts      = _packet->dts;
+		pkt.keyframe = !!(_packet->flags & AV_PKT_FLAG_KEY);
+		get_packet_priority(*_packet, pkt.priority, pkt.drop_priority);
+		packets.push_back(std::move(pkt));
+
+		av_packet_unref(_packet);
+	}
+	if ((res != AVERROR(EAGAIN)) && (res != AVERROR_EOF)) {
+		throw std::runtime_error(::streamfx::ffmpeg::tools::get_error_description(res));
+	}
+}
+
+std::vector<uint8_t> ffmpeg_chunk_encoder::extra_data()
+{
+	return _extra_data;
+}
+
+void ffmpeg_chunk_encoder::extract_headers()
+{
+	// Same sources as ffmpeg_instance::extract_headers, minus the SEI which may legitimately differ per chunk.
+	if ((_context->extradata != nullptr) && (_context->extradata_size > 0)) {
+		_extra_data.assign(_context->extradata, _context->extradata + _context->extradata_size);
+	} else if (_parent->_codec->id == AV_CODEC_ID_H264) {
+		uint8_t*    tmp_packet;
+		uint8_t*    tmp_header;
+		uint8_t*    tmp_sei;
+		std::size_t sz_packet, sz_header, sz_sei;
+
+		obs_extract_avc_headers(_packet->data, static_cast<size_t>(_packet->size), &tmp_packet, &sz_packet,
+								&tmp_header, &sz_header, &tmp_sei, &sz_sei);
+		_extra_data.assign(tmp_header, tmp_header + sz_header);
+
+		bfree(tmp_packet);
+		bfree(tmp_header);
+		bfree(tmp_sei);
+	} else if (_parent->_codec->id == AV_CODEC_ID_HEVC) {
+		std::vector<uint8_t> sei;
+		hevc::extract_header_sei(_packet->data, static_cast<size_t>(_packet->size), _extra_data, sei);
+	}
+}
+
 ffmpeg_factory::ffmpeg_factory(const AVCodec* codec) : _avcodec(codec)
 {
 	// Generate default identifier.
@@ -1041,6 +1279,7 @@ void ffmpeg_factory::get_defaults2(obs_data_t* settings)
 		obs_data_set_default_string(settings, ST_KEY_FFMPEG_CUSTOMSETTINGS, "");
 		obs_data_set_default_int(settings, ST_KEY_FFMPEG_THREADS, 0);
 		obs_data_set_default_int(settings, ST_KEY_FFMPEG_GPU, -1);
+		obs_data_set_default_int(settings, ST_KEY_FFMPEG_PARALLELGOPS, 0);
 	}
 }
 
@@ -1135,6 +1374,13 @@ obs_properties_t* ffmpeg_factory::get_properties2(instance_t* data)
 			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_THREADS, D_TRANSLATE(ST_I18N_FFMPEG_THREADS), 0,
 												   static_cast<int64_t>(std::thread::hardware_concurrency() * 2), 1);
 		}
+
+		if ((!_handler || !_handler->is_hardware_encoder(this)) && (_avcodec->type == AVMEDIA_TYPE_VIDEO)) {
+			auto p = obs_properties_add_int_slider(grp, ST_KEY_FFMPEG_PARALLELGOPS,
+												   D_TRANSLATE(ST_I18N_FFMPEG_PARALLELGOPS), 0,
+												   static_cast<int64_t>(std::thread::hardware_concurrency()), 1);
+			obs_property_set_long_description(p, D_TRANSLATE(ST_I18N_FFMPEG_PARALLELGOPS_DESCRIPTION));
+		}
 	};
 
 	return props;
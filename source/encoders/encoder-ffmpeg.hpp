@@ -28,7 +28,9 @@
 #include <stack>
 #include <thread>
 #include <vector>
+#include "encoders/encoder-chunked.hpp"
 #include "ffmpeg/avframe-queue.hpp"
+#include "ffmpeg/converter.hpp"
 #include "ffmpeg/hwapi/base.hpp"
 #include "ffmpeg/swscale.hpp"
 #include "handlers/handler.hpp"
@@ -49,6 +51,10 @@ extern "C" {
 
 namespace streamfx::encoder::ffmpeg {
 	class ffmpeg_factory;
+	class ffmpeg_chunk_encoder;
+
+	/** Copy the planes of an OBS frame into an FFmpeg frame of the same format, which may have a different stride. */
+	void copy_data(encoder_frame* frame, AVFrame* vframe);
 
 	class ffmpeg_instance : public obs::encoder_instance {
 		ffmpeg_factory* _factory;
@@ -57,8 +63,9 @@ namespace streamfx::encoder::ffmpeg {
 
 		std::shared_ptr<handler::handler> _handler;
 
-		::streamfx::ffmpeg::swscale _scaler;
-		AVPacket                    _packet;
+		::streamfx::ffmpeg::swscale   _scaler;
+		::streamfx::ffmpeg::converter _converter;
+		AVPacket                      _packet;
 
 		std::shared_ptr<::streamfx::ffmpeg::hwapi::base>     _hwapi;
 		std::shared_ptr<::streamfx::ffmpeg::hwapi::instance> _hwinst;
@@ -76,6 +83,11 @@ namespace streamfx::encoder::ffmpeg {
 		std::queue<std::shared_ptr<AVFrame>>           _used_frames;
 		std::chrono::high_resolution_clock::time_point _free_frames_last_used;
 
+		// Parallel GOP Encoding
+		std::shared_ptr<::streamfx::encoder::chunked::scheduler> _chunked;
+
+		friend class ffmpeg_chunk_encoder;
+
 		public:
 		ffmpeg_instance(obs_data_t* settings, obs_encoder_t* self, bool is_hw);
 		virtual ~ffmpeg_instance();
@@ -104,6 +116,7 @@ namespace streamfx::encoder::ffmpeg {
 		void initialize_sw(obs_data_t* settings);
 		void initialize_hw(obs_data_t* settings);
 
+		std::shared_ptr<AVFrame> allocate_frame();
 		void                     push_free_frame(std::shared_ptr<AVFrame> frame);
 		std::shared_ptr<AVFrame> pop_free_frame();
 
@@ -116,6 +129,12 @@ namespace streamfx::encoder::ffmpeg {
 
 		bool encode_avframe(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
 
+		bool encode_chunked(std::shared_ptr<AVFrame> frame, struct encoder_packet* packet, bool* received_packet);
+
+		void extract_headers(uint8_t* data, std::size_t size);
+
+		AVCodecContext* clone_context();
+
 		public: // Handler API
 		bool is_hardware_encode();
 
@@ -126,6 +145,30 @@ namespace streamfx::encoder::ffmpeg {
 		void parse_ffmpeg_commandline(std::string text);
 	};
 
+	class ffmpeg_chunk_encoder : public ::streamfx::encoder::chunked::chunk_encoder {
+		ffmpeg_instance*     _parent;
+		AVCodecContext*      _context;
+		AVPacket*            _packet;
+		std::vector<uint8_t> _extra_data;
+		bool                 _have_extra_data;
+
+		public:
+		ffmpeg_chunk_encoder(ffmpeg_instance* parent);
+		virtual ~ffmpeg_chunk_encoder();
+
+		void encode(std::shared_ptr<void> frame, int64_t pts, bool keyframe,
+					std::list<::streamfx::encoder::chunked::packet>& packets) override;
+
+		void flush(std::list<::streamfx::encoder::chunked::packet>& packets) override;
+
+		std::vector<uint8_t> extra_data() override;
+
+		private:
+		void drain(std::list<::streamfx::encoder::chunked::packet>& packets);
+
+		void extract_headers();
+	};
+
 	class ffmpeg_factory : public obs::encoder_factory<ffmpeg_factory, ffmpeg_instance> {
 		std::string _id;
 		std::string _codec;
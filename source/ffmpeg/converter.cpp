@@ -0,0 +1,259 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2019 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "converter.hpp"
+#include <cstring>
+#include <random>
+#include "plugin.hpp"
+#include "util/util-simd.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavutil/imgutils.h>
+#include <libavutil/mem.h>
+#include <libavutil/pixdesc.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+using namespace streamfx::ffmpeg;
+
+// Rows are handed out in batches of this many, which keeps the per-task overhead well below the work done.
+#define ST_GRAIN 32
+
+typedef converter::job job_t;
+
+static inline const uint8_t* row(job_t const& job, std::size_t plane, std::size_t index)
+{
+	return job.source_data[plane] + static_cast<ptrdiff_t>(index) * job.source_stride[plane];
+}
+
+static inline uint16_t* row16(job_t const& job, std::size_t plane, std::size_t index)
+{
+	return reinterpret_cast<uint16_t*>(job.target_data[plane]
+									   + static_cast<ptrdiff_t>(index) * job.target_stride[plane]);
+}
+
+// swscale copies the luma plane and splits the chroma plane, see nv12ToPlanarWrapper.
+static void nv12_to_yuv420p(job_t const& job, std::size_t begin, std::size_t end)
+{
+	std::size_t chroma = job.width / 2;
+	for (std::size_t idx = begin; idx < end; idx++) {
+		for (std::size_t y = idx * 2; y < (idx * 2 + 2); y++) {
+			memcpy(job.target_data[0] + static_cast<ptrdiff_t>(y) * job.target_stride[0], row(job, 0, y), job.width);
+		}
+		streamfx::util::simd::deinterleave_u8(row(job, 1, idx),
+											  job.target_data[1] + static_cast<ptrdiff_t>(idx) * job.target_stride[1],
+											  job.target_data[2] + static_cast<ptrdiff_t>(idx) * job.target_stride[2],
+											  chroma);
+	}
+}
+
+// The generic swscale path moves 8-bit samples into the top byte and leaves the low byte empty, regardless of range.
+static void nv12_to_p010(job_t const& job, std::size_t begin, std::size_t end)
+{
+	for (std::size_t idx = begin; idx < end; idx++) {
+		for (std::size_t y = idx * 2; y < (idx * 2 + 2); y++) {
+			streamfx::util::simd::widen_u8_u16(row(job, 0, y), row16(job, 0, y), job.width, 8, 0xFF00);
+		}
+		streamfx::util::simd::widen_u8_u16(row(job, 1, idx), row16(job, 1, idx), job.width, 8, 0xFF00);
+	}
+}
+
+// swscale widens planes of the same layout with planarCopyWrapper, which repeats the top bits of full range luma in
+// the new low bits but not those of limited range luma or of chroma.
+template<std::size_t _subsampling>
+static void planar_to_planar10(job_t const& job, std::size_t begin, std::size_t end)
+{
+	uint16_t    luma   = job.full_range ? 0x3FF : 0x3FC;
+	std::size_t chroma = job.width / _subsampling;
+	for (std::size_t idx = begin; idx < end; idx++) {
+		for (std::size_t y = idx * _subsampling; y < ((idx + 1) * _subsampling); y++) {
+			streamfx::util::simd::widen_u8_u16(row(job, 0, y), row16(job, 0, y), job.width, 2, luma);
+		}
+		for (std::size_t plane = 1; plane < 3; plane++) {
+			streamfx::util::simd::widen_u8_u16(row(job, plane, idx), row16(job, plane, idx), chroma, 2, 0x3FC);
+		}
+	}
+}
+
+// The generic swscale path with point sampling repeats every chroma row twice, and never repeats any top bits.
+static void yuv420p_to_yuv422p10(job_t const& job, std::size_t begin, std::size_t end)
+{
+	std::size_t chroma = job.width / 2;
+	for (std::size_t idx = begin; idx < end; idx++) {
+		for (std::size_t y = idx * 2; y < (idx * 2 + 2); y++) {
+			streamfx::util::simd::widen_u8_u16(row(job, 0, y), row16(job, 0, y), job.width, 2, 0x3FC);
+			for (std::size_t plane = 1; plane < 3; plane++) {
+				streamfx::util::simd::widen_u8_u16(row(job, plane, idx), row16(job, plane, y), chroma, 2, 0x3FC);
+			}
+		}
+	}
+}
+
+static const struct {
+	AVPixelFormat          source;
+	AVPixelFormat          target;
+	uint32_t               subsampling; // Rows handled together, and the size of every chroma sample.
+	const char*            name;
+	converter::function_t* function;
+} conversions[] = {
+	{AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P, 2, "NV12 to YUV420P", &nv12_to_yuv420p},
+	{AV_PIX_FMT_NV12, AV_PIX_FMT_P010, 2, "NV12 to P010", &nv12_to_p010},
+	{AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10, 2, "YUV420P to YUV420P10", &planar_to_planar10<2>},
+	{AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P10, 2, "YUV420P to YUV422P10", &yuv420p_to_yuv422p10},
+	{AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV444P10, 1, "YUV444P to YUV444P10", &planar_to_planar10<1>},
+};
+
+converter::converter()
+	: _name(nullptr), _function(nullptr), _width(0), _height(0), _rows(0), _full_range(false), _pool()
+{}
+
+converter::~converter()
+{
+	finalize();
+}
+
+bool converter::initialize(streamfx::ffmpeg::swscale& scaler)
+{
+	finalize();
+
+	AVPixelFormat source = scaler.get_source_format();
+	AVPixelFormat target = scaler.get_target_format();
+	uint32_t      width  = scaler.get_source_width();
+	uint32_t      height = scaler.get_source_height();
+	if ((scaler.get_target_size() != scaler.get_source_size())
+		|| (scaler.is_source_full_range() != scaler.is_target_full_range())
+		|| (scaler.get_source_colorspace() != scaler.get_target_colorspace()))
+		return false;
+
+	for (auto& entry : conversions) {
+		if ((entry.source != source) || (entry.target != target))
+			continue;
+
+		// Odd sizes leave a partial chroma sample, which is best left to swscale.
+		if (((width % entry.subsampling) != 0) || ((height % entry.subsampling) != 0) || (width == 0)
+			|| (height == 0))
+			return false;
+
+		_name       = entry.name;
+		_function   = entry.function;
+		_width      = width;
+		_height     = height;
+		_rows       = height / entry.subsampling;
+		_full_range = scaler.is_target_full_range();
+		if (!verify(scaler, source, target)) {
+			finalize();
+			return false;
+		}
+
+		if (_rows > ST_GRAIN) {
+			_pool = streamfx::threadpool();
+		}
+		return true;
+	}
+
+	return false;
+}
+
+void converter::finalize()
+{
+	_name     = nullptr;
+	_function = nullptr;
+	_pool.reset();
+}
+
+bool converter::is_available()
+{
+	return _function != nullptr;
+}
+
+const char* converter::get_name()
+{
+	return _name;
+}
+
+void converter::convert(const uint8_t* const source_data[], const int source_stride[], uint8_t* const target_data[],
+						const int target_stride[])
+{
+	if (!_function)
+		throw std::runtime_error("converter not initialized");
+
+	job_t job{source_data, source_stride, target_data, target_stride, _width, _full_range};
+	if (_pool && (_rows > ST_GRAIN)) {
+		function_t* function = _function;
+		_pool->parallel_for(
+			0, _rows, [&job, function](std::size_t begin, std::size_t end) { function(job, begin, end); }, ST_GRAIN);
+	} else {
+		_function(job, 0, _rows);
+	}
+}
+
+bool converter::verify(streamfx::ffmpeg::swscale& scaler, AVPixelFormat source, AVPixelFormat target)
+{
+	int      width              = static_cast<int>(_width);
+	int      height             = static_cast<int>(_height);
+	uint8_t* source_data[4]     = {nullptr};
+	int      source_stride[4]   = {0};
+	uint8_t* expected_data[4]   = {nullptr};
+	int      expected_stride[4] = {0};
+	uint8_t* actual_data[4]     = {nullptr};
+	int      actual_stride[4]   = {0};
+
+	bool matches = false;
+	if (int size = av_image_alloc(source_data, source_stride, width, height, source, 32);
+		(size >= 0) && (av_image_alloc(expected_data, expected_stride, width, height, target, 32) >= 0)
+		&& (av_image_alloc(actual_data, actual_stride, width, height, target, 32) >= 0)) {
+		// Noise rather than a flat color, so that every bit of every sample takes part in the comparison.
+		std::mt19937 generator(_width * _height);
+		for (int pos = 0; pos < size; pos++) {
+			source_data[0][pos] = static_cast<uint8_t>(generator());
+		}
+
+		job_t job{source_data, source_stride, actual_data, actual_stride, _width, _full_range};
+		_function(job, 0, _rows);
+		if (scaler.convert(source_data, source_stride, 0, height, expected_data, expected_stride) == height) {
+			const AVPixFmtDescriptor* desc     = av_pix_fmt_desc_get(target);
+			int                       bytes[4] = {0};
+			av_image_fill_linesizes(bytes, target, width);
+
+			matches = true;
+			for (std::size_t plane = 0; matches && (plane < 4) && (bytes[plane] > 0); plane++) {
+				int rows = ((plane == 1) || (plane == 2)) ? AV_CEIL_RSHIFT(height, desc->log2_chroma_h) : height;
+				for (int y = 0; matches && (y < rows); y++) {
+					matches = (memcmp(expected_data[plane] + y * expected_stride[plane],
+									  actual_data[plane] + y * actual_stride[plane],
+									  static_cast<std::size_t>(bytes[plane]))
+							   == 0);
+				}
+			}
+		}
+	}
+
+	av_freep(&source_data[0]);
+	av_freep(&expected_data[0]);
+	av_freep(&actual_data[0]);
+	return matches;
+}
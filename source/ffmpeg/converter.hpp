@@ -0,0 +1,90 @@
+// FFMPEG Video Encoder Integration for OBS Studio
+// Copyright (c) 2019 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <memory>
+#include "swscale.hpp"
+#include "util/util-threadpool.hpp"
+
+extern "C" {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4242 4244 4365)
+#endif
+#include <libavutil/pixfmt.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace streamfx::ffmpeg {
+	/** Converts between a few pixel formats without swscale, for the pairs that encoders run into the most.
+	 *
+	 * Only conversions that keep size, color space and range are covered, and each one is meant to produce exactly what
+	 * swscale produces for the same pair with SWS_POINT. As that depends on the FFmpeg version, a conversion is only
+	 * used if it matched swscale on a test frame. Rows are split across the plugin's thread pool, whose helpers for
+	 * this run at realtime priority, so that encoding never waits behind unrelated work.
+	 */
+	class converter {
+		public:
+		struct job;
+		typedef void function_t(job const& job, std::size_t begin, std::size_t end);
+
+		struct job {
+			const uint8_t* const* source_data;
+			const int*            source_stride;
+			uint8_t* const*       target_data;
+			const int*            target_stride;
+			uint32_t              width;
+			bool                  full_range;
+		};
+
+		private:
+		const char*                                 _name;
+		function_t*                                 _function;
+		uint32_t                                    _width;
+		uint32_t                                    _height;
+		uint32_t                                    _rows;
+		bool                                        _full_range;
+		std::shared_ptr<streamfx::util::threadpool> _pool;
+
+		public:
+		converter();
+		~converter();
+
+		/** Look up a conversion that does what 'scaler' does, returns false if swscale has to be used instead.
+		 *
+		 * 'scaler' must already be initialized, as a test frame is converted with both and compared.
+		 */
+		bool initialize(streamfx::ffmpeg::swscale& scaler);
+		void finalize();
+
+		bool        is_available();
+		const char* get_name();
+
+		void convert(const uint8_t* const source_data[], const int source_stride[], uint8_t* const target_data[],
+					 const int target_stride[]);
+
+		private:
+		bool verify(streamfx::ffmpeg::swscale& scaler, AVPixelFormat source, AVPixelFormat target);
+	};
+} // namespace streamfx::ffmpeg
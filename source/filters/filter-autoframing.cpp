@@ -148,16 +148,16 @@ autoframing_instance::~autoframing_instance()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 
+	// Cancel the underlying task first, it needs the lock to make any progress.
+	if (_provider_task.valid()) {
+		_provider_task.cancel();
+		_provider_task.wait();
+		_provider_task = {};
+	}
+
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
-		// De-queue the underlying task.
-		if (_provider_task) {
-			streamfx::threadpool()->pop(_provider_task);
-			_provider_task->await_completion();
-			_provider_task.reset();
-		}
-
 		// TODO: Make this asynchronous.
 		switch (_provider) {
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
@@ -463,7 +463,7 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 	// - We don't have a target.
 	// - The width/height of the next filter in the chain is empty.
 	if (!_provider_ready || !target || (width == 0) || (height == 0)) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -501,7 +501,7 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 			// Reset GPU state
 			gs_blend_state_pop();
 		} else {
-			obs_source_skip_video_filter(_self);
+			_self.skip_video_filter();
 			return;
 		}
 
@@ -517,7 +517,7 @@ void autoframing_instance::video_render(gs_effect_t* effect)
 				break;
 #endif
 			default:
-				obs_source_skip_video_filter(_self);
+				_self.skip_video_filter();
 				return;
 			}
 		}
@@ -863,24 +863,18 @@ void streamfx::filter::autoframing::autoframing_instance::switch_provider(tracki
 		return;
 	}
 
-	// This doesn't work correctly.
-	// - Need to allow multiple switches at once because OBS is weird.
-	// - Doesn't guarantee that the task is properly killed off.
-
 	// Log information.
 	D_LOG_INFO("Instance '%s' is switching provider from '%s' to '%s'.", obs_source_get_name(_self), cstring(_provider),
 			   cstring(provider));
 
-	// If there is an ongoing task to switch provider, cancel it.
-	if (_provider_task) {
-		// De-queue it.
-		streamfx::threadpool()->pop(_provider_task);
-
-		// Await the death of the task itself.
-		_provider_task->await_completion();
-
-		// Clear any memory associated with it.
-		_provider_task.reset();
+	// If there is an ongoing task to switch provider, cancel it. It needs the lock to make any progress, so wait for it
+	// without holding the lock.
+	if (_provider_task.valid()) {
+		auto task = _provider_task;
+		ul.unlock();
+		task.cancel();
+		task.wait();
+		ul.lock();
 	}
 
 	// Build data to pass into the task.
@@ -889,19 +883,23 @@ void streamfx::filter::autoframing::autoframing_instance::switch_provider(tracki
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(
-		std::bind(&autoframing_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->submit(
+		[this, spd](util::threadpool::cancellation_token const& token) { task_switch_provider(spd, token); });
 }
 
-void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(util::threadpool_data_t data)
+void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(
+	util::threadpool_data_t data, util::threadpool::cancellation_token const& token)
 {
 	std::shared_ptr<switch_provider_data_t> spd = std::static_pointer_cast<switch_provider_data_t>(data);
 
 	// Mark the provider as no longer ready.
 	_provider_ready = false;
 
-	// Lock the provider from being used.
+	// Lock the provider from being used. Whoever cancels us never waits for us while holding the lock.
 	std::unique_lock<std::mutex> ul(_provider_lock);
+	if (token.is_cancelled()) {
+		return;
+	}
 
 	try {
 		// Unload the previous provider.
@@ -915,6 +913,11 @@ void streamfx::filter::autoframing::autoframing_instance::task_switch_provider(u
 			break;
 		}
 
+		// Loading takes a while, so skip it if the switch was superseded in the meantime.
+		if (token.is_cancelled()) {
+			return;
+		}
+
 		// Load the new provider.
 		switch (_provider) {
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
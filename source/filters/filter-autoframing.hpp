@@ -91,7 +91,7 @@ namespace streamfx::filter::autoframing {
 		tracking_provider                       _provider_ui;
 		std::atomic<bool>                       _provider_ready;
 		std::mutex                              _provider_lock;
-		std::shared_ptr<util::threadpool::task> _provider_task;
+		util::threadpool::future<void>          _provider_task;
 
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 		std::shared_ptr<::streamfx::nvidia::ar::facedetection> _nvidia_fx;
@@ -145,7 +145,7 @@ namespace streamfx::filter::autoframing {
 		void tracking_tick(float seconds);
 
 		void switch_provider(tracking_provider provider);
-		void task_switch_provider(util::threadpool_data_t data);
+		void task_switch_provider(util::threadpool_data_t data, util::threadpool::cancellation_token const& token);
 
 #ifdef ENABLE_FILTER_AUTOFRAMING_NVIDIA
 		void nvar_facedetection_load();
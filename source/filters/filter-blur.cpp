@@ -30,6 +30,7 @@
 #include "gfx/blur/gfx-blur-gaussian-linear.hpp"
 #include "gfx/blur/gfx-blur-gaussian.hpp"
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-instrumentation.hpp"
 #include "obs/obs-source-tracker.hpp"
 #include "util/util-logging.hpp"
 
@@ -402,7 +403,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 
 	// Verify that we can actually run first.
 	if (!target || !parent || !this->_self || !this->_blur || (baseW == 0) || (baseH == 0)) {
-		obs_source_skip_video_filter(this->_self);
+		this->_self.skip_video_filter();
 		return;
 	}
 
@@ -414,6 +415,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 	if (!_source_rendered) {
 		// Source To Texture
 		{
+			streamfx::obs::instrumentation::probe gip{this, "Cache"};
 #ifdef ENABLE_PROFILING
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Cache"};
 #endif
@@ -450,11 +452,11 @@ void blur_instance::video_render(gs_effect_t* effect)
 
 				_source_texture = this->_source_rt->get_texture();
 				if (!_source_texture) {
-					obs_source_skip_video_filter(this->_self);
+					this->_self.skip_video_filter();
 					return;
 				}
 			} else {
-				obs_source_skip_video_filter(this->_self);
+				this->_self.skip_video_filter();
 				return;
 			}
 		}
@@ -464,6 +466,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 
 	if (!_output_rendered) {
 		{
+			streamfx::obs::instrumentation::probe gip{this, "Blur"};
 #ifdef ENABLE_PROFILING
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Blur"};
 #endif
@@ -474,6 +477,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 
 		// Mask
 		if (_mask.enabled) {
+			streamfx::obs::instrumentation::probe gip{this, "Mask"};
 #ifdef ENABLE_PROFILING
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Mask"};
 #endif
@@ -491,7 +495,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 			gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
 			gs_stencil_op(GS_STENCIL_BOTH, GS_ZERO, GS_ZERO, GS_ZERO);
 
-			std::string technique = "";
+			const char* technique = "";
 			switch (this->_mask.type) {
 			case mask_type::Region:
 				if (this->_mask.region.feather > std::numeric_limits<float_t>::epsilon()) {
@@ -547,18 +551,18 @@ void blur_instance::video_render(gs_effect_t* effect)
 				gs_ortho(0, 1, 0, 1, -1, 1);
 
 				// Render
-				while (gs_effect_loop(_effect_mask.get_object(), technique.c_str())) {
+				while (gs_effect_loop(_effect_mask.get_object(), technique)) {
 					streamfx::gs_draw_fullscreen_tri();
 				}
 			} catch (const std::exception&) {
 				gs_blend_state_pop();
-				obs_source_skip_video_filter(this->_self);
+				this->_self.skip_video_filter();
 				return;
 			}
 			gs_blend_state_pop();
 
 			if (!(_output_texture = this->_output_rt->get_texture())) {
-				obs_source_skip_video_filter(this->_self);
+				this->_self.skip_video_filter();
 				return;
 			}
 		}
@@ -588,7 +592,7 @@ void blur_instance::video_render(gs_effect_t* effect)
 		gs_eparam_t* param = gs_effect_get_param_by_name(finalEffect, "image");
 		if (!param) {
 			DLOG_ERROR("<filter-blur:%s> Failed to set image param.", obs_source_get_name(this->_self));
-			obs_source_skip_video_filter(_self);
+			_self.skip_video_filter();
 			return;
 		} else {
 			gs_effect_set_texture(param, _output_texture->get_object());
@@ -861,18 +865,12 @@ obs_properties_t* blur_factory::get_properties2(blur_instance* data)
 		p = obs_properties_add_list(pr, ST_KEY_MASK_SOURCE, D_TRANSLATE(ST_I18N_MASK_SOURCE), OBS_COMBO_TYPE_LIST,
 									OBS_COMBO_FORMAT_STRING);
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				obs_property_list_add_string(p, std::string(name + " (Source)").c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_video_sources);
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				obs_property_list_add_string(p, std::string(name + " (Scene)").c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
+		for (auto const& name : *obs::source_tracker::get()->names(obs::source_tracker::kind::VIDEO)) {
+			obs_property_list_add_string(p, std::string(name + " (Source)").c_str(), name.c_str());
+		}
+		for (auto const& name : *obs::source_tracker::get()->names(obs::source_tracker::kind::SCENE)) {
+			obs_property_list_add_string(p, std::string(name + " (Scene)").c_str(), name.c_str());
+		}
 
 		/// Shared
 		p = obs_properties_add_color(pr, ST_KEY_MASK_COLOR, D_TRANSLATE(ST_I18N_MASK_COLOR));
@@ -21,6 +21,7 @@
 #include "strings.hpp"
 #include <stdexcept>
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-instrumentation.hpp"
 #include "util/util-logging.hpp"
 
 #ifdef _DEBUG
@@ -299,6 +300,7 @@ void color_grade_instance::prepare_effect()
 
 void color_grade_instance::rebuild_lut()
 {
+	streamfx::obs::instrumentation::probe gip{this, "Rebuild LUT"};
 #ifdef ENABLE_PROFILING
 	streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Rebuild LUT"};
 #endif
@@ -369,7 +371,7 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 
 	// Skip filter if anything is wrong.
 	if (!parent || !target || !width || !height) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -383,6 +385,7 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 
 	// 1. Capture the filter/source rendered above this.
 	if (!_ccache_fresh || !_ccache_texture) {
+		streamfx::obs::instrumentation::probe gip{this, "Cache"};
 #ifdef ENABLE_PROFILING
 		streamfx::obs::gs::debug_marker gdmp{streamfx::obs::gs::debug_color_cache, "Cache '%s'",
 											 obs_source_get_name(target)};
@@ -439,6 +442,7 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 	// 2. Apply one of the two rendering methods (LUT or Direct).
 	if (_lut_initialized && _lut_enabled) { // Try to apply with the LUT based method.
 		try {
+			streamfx::obs::instrumentation::probe gip{this, "LUT Rendering"};
 #ifdef ENABLE_PROFILING
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "LUT Rendering"};
 #endif
@@ -505,6 +509,7 @@ void color_grade_instance::video_render(gs_effect_t* shader)
 		}
 	}
 	if ((!_lut_initialized || !_lut_enabled) && !_cache_fresh) {
+		streamfx::obs::instrumentation::probe gip{this, "Direct Rendering"};
 #ifdef ENABLE_PROFILING
 		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Direct Rendering"};
 #endif
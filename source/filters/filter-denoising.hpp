@@ -51,7 +51,7 @@ namespace streamfx::filter::denoising {
 		denoising_provider                      _provider_ui;
 		std::atomic<bool>                       _provider_ready;
 		std::mutex                              _provider_lock;
-		std::shared_ptr<util::threadpool::task> _provider_task;
+		util::threadpool::future<void>          _provider_task;
 
 		std::shared_ptr<::streamfx::obs::gs::effect>  _standard_effect;
 		std::shared_ptr<::streamfx::obs::gs::sampler> _channel0_sampler;
@@ -82,7 +82,7 @@ namespace streamfx::filter::denoising {
 
 		private:
 		void switch_provider(denoising_provider provider);
-		void task_switch_provider(util::threadpool_data_t data);
+		void task_switch_provider(util::threadpool_data_t data, util::threadpool::cancellation_token const& token);
 
 #ifdef ENABLE_FILTER_DENOISING_NVIDIA
 		void nvvfx_denoising_load();
@@ -115,7 +115,7 @@ void displacement_instance::video_tick(float_t)
 void displacement_instance::video_render(gs_effect_t*)
 {
 	if (!_texture) { // No displacement map, so just skip us for now.
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -125,7 +125,7 @@ void displacement_instance::video_render(gs_effect_t*)
 #endif
 
 	if (!obs_source_process_filter_begin(_self, GS_RGBA, OBS_ALLOW_DIRECT_RENDERING)) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
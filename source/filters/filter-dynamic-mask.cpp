@@ -213,10 +213,10 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 	auto          input  = _input.lock();
 
 	if (!_self || !parent || !target || !width || !height || !_input || !_input_capture || !_effect) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	} else if (!input.width() || !input.height()) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -318,16 +318,16 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 			_have_final_texture = true;
 		}
 	} catch (...) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
 	if (!_have_filter_texture || !_have_input_texture || !_have_final_texture) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 	if (!_filter_texture->get_object() || !_input_texture->get_object() || !_final_texture->get_object()) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -351,7 +351,7 @@ void dynamic_mask_instance::video_render(gs_effect_t* in_effect)
 		gs_eparam_t* param        = gs_effect_get_param_by_name(final_effect, "image");
 		if (!param) {
 			DLOG_ERROR("<filter-dynamic-mask:%s> Failed to set image param.", obs_source_get_name(_self));
-			obs_source_skip_video_filter(_self);
+			_self.skip_video_filter();
 			return;
 		} else {
 			gs_effect_set_texture(param, _final_texture->get_object());
@@ -494,22 +494,16 @@ obs_properties_t* dynamic_mask_factory::get_properties2(dynamic_mask_instance* d
 		p = obs_properties_add_list(props, ST_KEY_INPUT, D_TRANSLATE(ST_I18N_INPUT), OBS_COMBO_TYPE_LIST,
 									OBS_COMBO_FORMAT_STRING);
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_video_sources);
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
+		for (auto const& name : *obs::source_tracker::get()->names(obs::source_tracker::kind::VIDEO)) {
+			std::stringstream sstr;
+			sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
+			obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+		}
+		for (auto const& name : *obs::source_tracker::get()->names(obs::source_tracker::kind::SCENE)) {
+			std::stringstream sstr;
+			sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
+			obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+		}
 	}
 
 	const char* pri_chs[] = {S_CHANNEL_RED, S_CHANNEL_GREEN, S_CHANNEL_BLUE, S_CHANNEL_ALPHA};
@@ -21,6 +21,7 @@
 #include "strings.hpp"
 #include <stdexcept>
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-instrumentation.hpp"
 #include "util/util-logging.hpp"
 
 #ifdef _DEBUG
@@ -322,7 +323,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 	gs_effect_t*  default_effect = obs_get_base_effect(obs_base_effect::OBS_EFFECT_DEFAULT);
 
 	if (!_self || !parent || !target || !baseW || !baseH || !final_effect) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -352,6 +353,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 		if (!_source_rendered) {
 			// Store input texture.
 			{
+				streamfx::obs::instrumentation::probe gip{this, "Cache"};
 #ifdef ENABLE_PROFILING
 				streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_cache, "Cache"};
 #endif
@@ -394,6 +396,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 				}
 
 				{
+					streamfx::obs::instrumentation::probe gip{this, "Update Distance Field"};
 #ifdef ENABLE_PROFILING
 					streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert,
 														"Update Distance Field"};
@@ -425,7 +428,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 		gs_blend_state_pop();
 	} catch (...) {
 		gs_blend_state_pop();
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -433,7 +436,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 		_output_texture = _source_texture;
 
 		if (!_sdf_consumer_effect) {
-			obs_source_skip_video_filter(_self);
+			_self.skip_video_filter();
 			return;
 		}
 
@@ -453,6 +456,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 
 		// Optimized Render path.
 		try {
+			streamfx::obs::instrumentation::probe gip{this, "Calculate"};
 #ifdef ENABLE_PROFILING
 			streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Calculate"};
 #endif
@@ -545,7 +549,7 @@ void sdf_effects_instance::video_render(gs_effect_t* effect)
 	}
 
 	if (!_output_texture) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -148,7 +148,7 @@ void shader_instance::video_render(gs_effect_t* effect)
 			_fx->render(effect);
 		}
 	} catch (const std::exception& ex) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		throw ex;
 	}
 }
@@ -395,7 +395,7 @@ void transform_instance::video_render(gs_effect_t* effect)
 
 	if (!base_width || !base_height || !parent || !target || !_standard_effect
 		|| !_transform_effect) { // Skip if something is wrong.
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -454,7 +454,7 @@ void transform_instance::video_render(gs_effect_t* effect)
 
 			gs_blend_state_pop();
 		} else {
-			obs_source_skip_video_filter(_self);
+			_self.skip_video_filter();
 			return;
 		}
 
@@ -462,7 +462,7 @@ void transform_instance::video_render(gs_effect_t* effect)
 	}
 	_cache_rt->get_texture(_cache_texture);
 	if (!_cache_texture) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -486,7 +486,7 @@ void transform_instance::video_render(gs_effect_t* effect)
 
 		_mipmap_rendered = true;
 		if (!_mipmap_texture) {
-			obs_source_skip_video_filter(_self);
+			_self.skip_video_filter();
 			return;
 		}
 	}
@@ -575,7 +575,7 @@ void transform_instance::video_render(gs_effect_t* effect)
 	}
 	_source_rt->get_texture(_source_texture);
 	if (!_source_texture) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
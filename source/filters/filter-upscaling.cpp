@@ -129,16 +129,16 @@ upscaling_instance::~upscaling_instance()
 {
 	D_LOG_DEBUG("Finalizing... (Addr: 0x%" PRIuPTR ")", this);
 
+	// Cancel the underlying task first, it needs the lock to make any progress.
+	if (_provider_task.valid()) {
+		_provider_task.cancel();
+		_provider_task.wait();
+		_provider_task = {};
+	}
+
 	{ // Unload the underlying effect ASAP.
 		std::unique_lock<std::mutex> ul(_provider_lock);
 
-		// De-queue the underlying task.
-		if (_provider_task) {
-			streamfx::threadpool()->pop(_provider_task);
-			_provider_task->await_completion();
-			_provider_task.reset();
-		}
-
 		// TODO: Make this asynchronous.
 		switch (_provider) {
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
@@ -254,7 +254,7 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 	// - We don't have a target.
 	// - The width/height of the next filter in the chain is empty.
 	if (!_provider_ready || !target || (width == 0) || (height == 0)) {
-		obs_source_skip_video_filter(_self);
+		_self.skip_video_filter();
 		return;
 	}
 
@@ -300,7 +300,7 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 				gs_blend_state_pop();
 				gs_matrix_pop();
 			} else {
-				obs_source_skip_video_filter(_self);
+				_self.skip_video_filter();
 				return;
 			}
 		}
@@ -320,13 +320,13 @@ void upscaling_instance::video_render(gs_effect_t* effect)
 				break;
 			}
 		} catch (...) {
-			obs_source_skip_video_filter(_self);
+			_self.skip_video_filter();
 			return;
 		}
 
 		if (!_output) {
 			D_LOG_ERROR("Provider '%s' did not return a result.", cstring(_provider));
-			obs_source_skip_video_filter(_self);
+			_self.skip_video_filter();
 			return;
 		}
 
@@ -362,24 +362,18 @@ void streamfx::filter::upscaling::upscaling_instance::switch_provider(upscaling_
 		return;
 	}
 
-	// This doesn't work correctly.
-	// - Need to allow multiple switches at once because OBS is weird.
-	// - Doesn't guarantee that the task is properly killed off.
-
 	// Log information.
 	D_LOG_INFO("Instance '%s' is switching provider from '%s' to '%s'.", obs_source_get_name(_self), cstring(_provider),
 			   cstring(provider));
 
-	// If there is an existing task, attempt to cancel it.
-	if (_provider_task) {
-		// De-queue it.
-		streamfx::threadpool()->pop(_provider_task);
-
-		// Await the death of the task itself.
-		_provider_task->await_completion();
-
-		// Clear any memory associated with it.
-		_provider_task.reset();
+	// If there is an ongoing task to switch provider, cancel it. It needs the lock to make any progress, so wait for it
+	// without holding the lock.
+	if (_provider_task.valid()) {
+		auto task = _provider_task;
+		ul.unlock();
+		task.cancel();
+		task.wait();
+		ul.lock();
 	}
 
 	// Build data to pass into the task.
@@ -388,19 +382,23 @@ void streamfx::filter::upscaling::upscaling_instance::switch_provider(upscaling_
 	_provider     = provider;
 
 	// Then spawn a new task to switch provider.
-	_provider_task = streamfx::threadpool()->push(
-		std::bind(&upscaling_instance::task_switch_provider, this, std::placeholders::_1), spd);
+	_provider_task = streamfx::threadpool()->submit(
+		[this, spd](util::threadpool::cancellation_token const& token) { task_switch_provider(spd, token); });
 }
 
-void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util::threadpool_data_t data)
+void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(
+	util::threadpool_data_t data, util::threadpool::cancellation_token const& token)
 {
 	std::shared_ptr<switch_provider_data_t> spd = std::static_pointer_cast<switch_provider_data_t>(data);
 
 	// 1. Mark the provider as no longer ready.
 	_provider_ready = false;
 
-	// 2. Lock the provider from being used.
+	// 2. Lock the provider from being used. Whoever cancels us never waits for us while holding the lock.
 	std::unique_lock<std::mutex> ul(_provider_lock);
+	if (token.is_cancelled()) {
+		return;
+	}
 
 	try {
 		// 3. Unload the previous provider.
@@ -414,11 +412,19 @@ void streamfx::filter::upscaling::upscaling_instance::task_switch_provider(util:
 			break;
 		}
 
+		// Loading takes a while, so skip it if the switch was superseded in the meantime.
+		if (token.is_cancelled()) {
+			return;
+		}
+
 		// 4. Load the new provider.
 		switch (_provider) {
 #ifdef ENABLE_FILTER_UPSCALING_NVIDIA
 		case upscaling_provider::NVIDIA_SUPERRESOLUTION:
 			nvvfxsr_load();
+			if (token.is_cancelled()) {
+				return;
+			}
 			{
 				auto data = obs_source_get_settings(_self);
 				nvvfxsr_update(data);
@@ -51,7 +51,7 @@ namespace streamfx::filter::virtual_greenscreen {
 		virtual_greenscreen_provider              _provider_ui;
 		std::atomic<bool>                         _provider_ready;
 		std::mutex                                _provider_lock;
-		std::shared_ptr<util::threadpool::task>   _provider_task;
+		util::threadpool::future<void>            _provider_task;
 
 		std::shared_ptr<::streamfx::obs::gs::effect>  _effect;
 		std::shared_ptr<::streamfx::obs::gs::sampler> _channel0_sampler;
@@ -83,7 +83,7 @@ namespace streamfx::filter::virtual_greenscreen {
 
 		private:
 		void switch_provider(virtual_greenscreen_provider provider);
-		void task_switch_provider(util::threadpool_data_t data);
+		void task_switch_provider(util::threadpool_data_t data, util::threadpool::cancellation_token const& token);
 
 #ifdef ENABLE_FILTER_VIRTUAL_GREENSCREEN_NVIDIA
 		void nvvfxgs_load();
@@ -56,6 +56,34 @@ streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data()
 	}
 
 	// Precalculate Kernels
+	_kernels = generate_kernels();
+}
+
+streamfx::gfx::blur::gaussian_linear_data::~gaussian_linear_data()
+{
+	_effect.reset();
+}
+
+streamfx::obs::gs::effect streamfx::gfx::blur::gaussian_linear_data::get_effect()
+{
+	return _effect;
+}
+
+std::vector<float_t> const& streamfx::gfx::blur::gaussian_linear_data::get_kernel(std::size_t width)
+{
+	if (width < 1)
+		width = 1;
+	if (width > ST_MAX_BLUR_SIZE)
+		width = ST_MAX_BLUR_SIZE;
+	width -= 1;
+	return _kernels[width];
+}
+
+std::vector<std::vector<float_t>> streamfx::gfx::blur::gaussian_linear_data::generate_kernels()
+{
+	std::vector<std::vector<float_t>> kernels;
+	kernels.reserve(ST_MAX_BLUR_SIZE);
+
 	for (std::size_t kernel_size = 1; kernel_size <= ST_MAX_BLUR_SIZE; kernel_size++) {
 		std::vector<double_t> kernel_math(ST_MAX_KERNEL_SIZE);
 		std::vector<float_t>  kernel_data(ST_MAX_KERNEL_SIZE);
@@ -83,28 +111,10 @@ streamfx::gfx::blur::gaussian_linear_data::gaussian_linear_data()
 			kernel_data.at(p) = float_t(kernel_math[p] * inverse_sum);
 		}
 
-		_kernels.push_back(std::move(kernel_data));
+		kernels.push_back(std::move(kernel_data));
 	}
-}
 
-streamfx::gfx::blur::gaussian_linear_data::~gaussian_linear_data()
-{
-	_effect.reset();
-}
-
-streamfx::obs::gs::effect streamfx::gfx::blur::gaussian_linear_data::get_effect()
-{
-	return _effect;
-}
-
-std::vector<float_t> const& streamfx::gfx::blur::gaussian_linear_data::get_kernel(std::size_t width)
-{
-	if (width < 1)
-		width = 1;
-	if (width > ST_MAX_BLUR_SIZE)
-		width = ST_MAX_BLUR_SIZE;
-	width -= 1;
-	return _kernels[width];
+	return kernels;
 }
 
 streamfx::gfx::blur::gaussian_linear_factory::gaussian_linear_factory() {}
@@ -304,7 +314,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 #endif
 
 	streamfx::obs::gs::effect effect = _data->get_effect();
-	auto                      kernel = _data->get_kernel(size_t(_size));
+	auto const&               kernel = _data->get_kernel(size_t(_size));
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
@@ -410,7 +420,7 @@ std::shared_ptr<::streamfx::obs::gs::texture> streamfx::gfx::blur::gaussian_line
 #endif
 
 	streamfx::obs::gs::effect effect = _data->get_effect();
-	auto                      kernel = _data->get_kernel(size_t(_size));
+	auto const&               kernel = _data->get_kernel(size_t(_size));
 
 	if (!effect || ((_step_scale.first + _step_scale.second) < std::numeric_limits<double_t>::epsilon())) {
 		return _input_texture;
@@ -37,6 +37,9 @@ namespace streamfx::gfx {
 			streamfx::obs::gs::effect get_effect();
 
 			std::vector<float_t> const& get_kernel(std::size_t width);
+
+			/** Calculate the normalized kernel for every supported width, which does not need the graphics context. */
+			static std::vector<std::vector<float_t>> generate_kernels();
 		};
 
 		class gaussian_linear_factory : public ::streamfx::gfx::blur::ifactory {
@@ -0,0 +1,168 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gfx-gpu-timer.hpp"
+#include <mutex>
+#include <stdexcept>
+#include "obs/gs/gs-helper.hpp"
+#include "util/util-logging.hpp"
+
+// OpenGL
+#include "glad/gl.h"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<gfx::gpu_timer> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+streamfx::gfx::gpu_timer::gpu_timer(std::size_t depth)
+	: _gl(streamfx::gfx::opengl::get()), _profiler(streamfx::util::profiler::create()), _slots(depth), _head(0),
+	  _pending(0), _active(false), _dropped(0)
+{
+	if (!is_available()) {
+		throw std::runtime_error("GPU timing is not available with the current renderer.");
+	}
+	if (depth == 0) {
+		throw std::invalid_argument("GPU timing requires at least one query.");
+	}
+
+	std::vector<GLuint> queries(depth * 2);
+	glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+	for (std::size_t idx = 0; idx < depth; idx++) {
+		_slots[idx].begin = queries[idx * 2];
+		_slots[idx].end   = queries[idx * 2 + 1];
+	}
+}
+
+streamfx::gfx::gpu_timer::~gpu_timer()
+{
+	// Owners don't necessarily live on the graphics thread, so make sure we have a context to delete the queries in.
+	streamfx::obs::gs::context gctx{};
+
+	std::vector<GLuint> queries;
+	queries.reserve(_slots.size() * 2);
+	for (auto& slot : _slots) {
+		queries.push_back(slot.begin);
+		queries.push_back(slot.end);
+	}
+	glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+}
+
+void streamfx::gfx::gpu_timer::begin()
+{
+	poll();
+
+	// Never wait for the GPU, just skip this measurement if it is too far behind.
+	if (_pending >= _slots.size()) {
+		_dropped++;
+		_active = false;
+		return;
+	}
+
+	glQueryCounter(_slots[_head].begin, GL_TIMESTAMP);
+	_active = true;
+}
+
+void streamfx::gfx::gpu_timer::end()
+{
+	if (!_active) {
+		return;
+	}
+
+	glQueryCounter(_slots[_head].end, GL_TIMESTAMP);
+	_head = (_head + 1) % _slots.size();
+	_pending++;
+	_active = false;
+}
+
+void streamfx::gfx::gpu_timer::poll()
+{
+	// Queries complete in the order they were issued, so the first one that isn't ready ends the search.
+	while (_pending > 0) {
+		auto& slot = _slots[(_head + _slots.size() - _pending) % _slots.size()];
+
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(slot.end, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE) {
+			break;
+		}
+
+		GLuint64 begin = 0;
+		GLuint64 end   = 0;
+		glGetQueryObjectui64v(slot.begin, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(slot.end, GL_QUERY_RESULT, &end);
+		if (end >= begin) {
+			_profiler->track(std::chrono::nanoseconds(static_cast<int64_t>(end - begin)));
+		}
+		_pending--;
+	}
+}
+
+std::shared_ptr<streamfx::util::profiler> streamfx::gfx::gpu_timer::profiler()
+{
+	return _profiler;
+}
+
+uint64_t streamfx::gfx::gpu_timer::dropped()
+{
+	return _dropped;
+}
+
+bool streamfx::gfx::gpu_timer::is_available()
+{
+	static std::once_flag once;
+	static bool           available = false;
+
+	std::call_once(once, []() {
+		if (gs_get_device_type() != GS_DEVICE_OPENGL) {
+			D_LOG_INFO("GPU timing is only supported with the OpenGL renderer.", "");
+			return;
+		}
+
+		// The entry points are only valid once GLAD has been loaded.
+		auto gl = streamfx::gfx::opengl::get();
+		if (!(GLAD_GL_VERSION_3_3 || GLAD_GL_ARB_timer_query)) {
+			D_LOG_WARNING("GPU timing is unavailable, as timer queries are not supported.", "");
+			return;
+		}
+
+		// Some drivers expose the extension but provide no usable counter.
+		GLint bits = 0;
+		glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+		if (bits <= 0) {
+			D_LOG_WARNING("GPU timing is unavailable, as the timestamp counter has no precision.", "");
+			return;
+		}
+
+		D_LOG_INFO("GPU timing is available with a %" PRId32 " bit timestamp counter.", bits);
+		available = true;
+	});
+
+	return available;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+#include "common.hpp"
+#include <vector>
+#include "gfx/gfx-opengl.hpp"
+
+namespace streamfx::gfx {
+	/** Measures how long the GPU spends on a section of rendering.
+	 *
+	 * Each measurement is a pair of timestamp queries, which unlike elapsed time queries may be nested. Results are
+	 * collected from a small ring of queries only once the GPU reports them as available, so timing never waits for
+	 * the GPU to catch up. If the GPU falls behind by more than the ring can hold, measurements are dropped instead.
+	 *
+	 * Only the OpenGL renderer is supported. All functions must be called from within the graphics context.
+	 */
+	class gpu_timer {
+		struct slot {
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		std::shared_ptr<streamfx::gfx::opengl>   _gl;
+		std::shared_ptr<streamfx::util::profiler> _profiler;
+		std::vector<slot>                         _slots;
+		std::size_t                               _head;
+		std::size_t                               _pending;
+		bool                                      _active;
+		uint64_t                                  _dropped;
+
+		public:
+		gpu_timer(std::size_t depth = 8);
+		~gpu_timer();
+
+		void begin();
+
+		void end();
+
+		/** Collect all results that are available without waiting. */
+		void poll();
+
+		std::shared_ptr<streamfx::util::profiler> profiler();
+
+		/** Number of measurements skipped because the ring was full. */
+		uint64_t dropped();
+
+		public:
+		/** Check if the current renderer can time GPU work, must be called from within the graphics context. */
+		static bool is_available();
+
+		class scope {
+			gpu_timer& _parent;
+
+			public:
+			scope(gpu_timer& parent) : _parent(parent)
+			{
+				_parent.begin();
+			}
+			~scope()
+			{
+				_parent.end();
+			}
+		};
+	};
+} // namespace streamfx::gfx
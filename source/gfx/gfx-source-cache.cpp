@@ -0,0 +1,142 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "gfx-source-cache.hpp"
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include "obs/gs/gs-helper.hpp"
+
+// Captures nobody asked for in this many frames are released.
+#define ST_EVICT_FRAMES 120
+
+bool streamfx::gfx::source_cache::key::operator<(key const& rhs) const
+{
+	return std::tie(source, width, height, format, blend)
+		   < std::tie(rhs.source, rhs.width, rhs.height, rhs.format, rhs.blend);
+}
+
+streamfx::gfx::source_cache::~source_cache()
+{
+	_entries.clear();
+}
+
+streamfx::gfx::source_cache::source_cache() : _entries(), _frame(0), _frame_time(0) {}
+
+std::shared_ptr<streamfx::obs::gs::texture>
+	streamfx::gfx::source_cache::render(obs_source_t* source, uint32_t width, uint32_t height, gs_color_format format,
+										bool blend)
+{
+	if (!source || (width == 0) || (height == 0)) {
+		return nullptr;
+	}
+
+	// libobs moves on to the next video frame before it renders anything for it.
+	if (uint64_t frame_time = obs_get_video_frame_time(); frame_time != _frame_time) {
+		_frame_time = frame_time;
+		_frame++;
+		evict();
+	}
+
+	auto kv = _entries.find(key{source, width, height, format, blend});
+	if (kv == _entries.end()) {
+		kv = _entries.emplace(key{source, width, height, format, blend}, entry{}).first;
+		kv->second.rt = std::make_shared<streamfx::obs::gs::rendertarget>(format, GS_ZS_NONE);
+	} else if ((kv->second.frame == _frame) && kv->second.weak.get()
+			   && obs_weak_source_references_source(kv->second.weak.get(), source)) {
+		// A source that ends up asking for itself would read from the target that is being drawn into.
+		return kv->second.rendering ? nullptr : kv->second.texture;
+	}
+
+	// Mark the capture as done before rendering, so that a source which ends up asking for itself does not start a
+	// second render into the same target.
+	auto& data = kv->second;
+	data.weak  = streamfx::obs::weak_source{source};
+	data.frame = _frame;
+
+	{
+		struct guard {
+			bool& flag;
+			guard(bool& flag) : flag(flag)
+			{
+				flag = true;
+			}
+			~guard()
+			{
+				flag = false;
+			}
+		} rendering(data.rendering);
+
+#ifdef ENABLE_PROFILING
+		auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_capture, "gfx::source_cache '%s'",
+													obs_source_get_name(source));
+#endif
+		auto op = data.rt->render(width, height);
+		vec4 black;
+		vec4_zero(&black);
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float_t>(height), 0, 1);
+		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+		if (blend) {
+			obs_source_video_render(source);
+		} else {
+			gs_blend_state_push();
+			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+			gs_enable_blending(false);
+			gs_enable_color(true, true, true, true);
+			obs_source_video_render(source);
+			gs_blend_state_pop();
+		}
+	}
+
+	// Consumers may hold on to the texture after we forgot about it, so it keeps the render target alive.
+	if (gs_texture_t* object = data.rt->get_object(); !data.texture || (data.texture->get_object() != object)) {
+		auto rt      = data.rt;
+		data.texture = std::shared_ptr<streamfx::obs::gs::texture>(new streamfx::obs::gs::texture(object, false),
+																   [rt](streamfx::obs::gs::texture* v) { delete v; });
+	}
+	return data.texture;
+}
+
+void streamfx::gfx::source_cache::evict()
+{
+	for (auto kv = _entries.begin(); kv != _entries.end();) {
+		if (((_frame - kv->second.frame) > ST_EVICT_FRAMES) || kv->second.weak.expired()) {
+			kv = _entries.erase(kv);
+		} else {
+			++kv;
+		}
+	}
+}
+
+std::shared_ptr<streamfx::gfx::source_cache> streamfx::gfx::source_cache::get()
+{
+	static std::mutex                                 inst_mtx;
+	static std::weak_ptr<streamfx::gfx::source_cache> inst_weak;
+
+	std::unique_lock<std::mutex> lock(inst_mtx);
+	if (inst_weak.expired()) {
+		auto instance = std::shared_ptr<streamfx::gfx::source_cache>(new streamfx::gfx::source_cache());
+		inst_weak     = instance;
+		return instance;
+	} else {
+		return inst_weak.lock();
+	}
+}
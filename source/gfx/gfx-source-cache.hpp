@@ -0,0 +1,83 @@
+// Copyright (c) 2021 Michael Fabian Dirks <info@xaymar.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+#include "common.hpp"
+#include <map>
+#include "obs/gs/gs-rendertarget.hpp"
+#include "obs/gs/gs-texture.hpp"
+#include "obs/obs-weak-source.hpp"
+
+namespace streamfx::gfx {
+	/** Renders each source at most once per frame, no matter how many consumers ask for it.
+	 *
+	 * Captures are keyed by source, size, color format and blend mode. The first request in a frame renders the
+	 * source, and every further request in the same frame is handed the same texture, which must be treated as
+	 * read-only. A texture stays valid for as long as it is held, even once the cache itself has let go of the capture.
+	 * Captures that were not asked for in a while are released.
+	 *
+	 * All functions must be called from within the graphics context.
+	 */
+	class source_cache {
+		struct key {
+			obs_source_t*   source;
+			uint32_t        width;
+			uint32_t        height;
+			gs_color_format format;
+			bool            blend;
+
+			bool operator<(key const& rhs) const;
+		};
+
+		struct entry {
+			streamfx::obs::weak_source                       weak;
+			std::shared_ptr<streamfx::obs::gs::rendertarget> rt;
+			std::shared_ptr<streamfx::obs::gs::texture>      texture;
+			uint64_t                                         frame;
+			bool                                             rendering;
+		};
+
+		std::map<key, entry> _entries;
+		uint64_t             _frame;
+		uint64_t             _frame_time;
+
+		protected:
+		source_cache();
+
+		public:
+		~source_cache();
+
+		/** Capture 'source' at the given size, or retrieve the capture already made this frame.
+		 *
+		 * @param blend Render with the current blend state, or overwrite the target with blending disabled.
+		 *
+		 * @return The captured texture, or nullptr if the size is empty or the source asked for itself while rendering.
+		 */
+		std::shared_ptr<streamfx::obs::gs::texture> render(obs_source_t* source, uint32_t width, uint32_t height,
+														   gs_color_format format = GS_RGBA, bool blend = true);
+
+		private:
+		void evict();
+
+		public: // Singleton
+		static std::shared_ptr<streamfx::gfx::source_cache> get();
+	};
+} // namespace streamfx::gfx
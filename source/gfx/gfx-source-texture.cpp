@@ -17,12 +17,14 @@
 
 #include "gfx-source-texture.hpp"
 #include <stdexcept>
+#include "gfx-source-cache.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "obs/obs-tools.hpp"
 
 streamfx::gfx::source_texture::~source_texture()
 {
 	if (_child && _parent) {
+		::streamfx::obs::tools::source_unlink(_parent, _child);
 		obs_source_remove_active_child(_parent.get(), _child.get());
 	}
 }
@@ -41,8 +43,7 @@ streamfx::gfx::source_texture::source_texture(streamfx::obs::weak_source child,
 	} else if (!obs_source_add_active_child(_parent.get(), _child.get())) {
 		throw std::runtime_error("Child contains Parent");
 	}
-
-	_rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+	::streamfx::obs::tools::source_link(_parent, _child);
 }
 
 obs_source_t* streamfx::gfx::source_texture::get_object()
@@ -61,6 +62,7 @@ obs_source_t* streamfx::gfx::source_texture::get_parent()
 void streamfx::gfx::source_texture::clear()
 {
 	if (_child && _parent) {
+		::streamfx::obs::tools::source_unlink(_parent, _child);
 		obs_source_remove_active_child(_parent.get(), _child.get());
 	}
 	_child = {};
@@ -78,20 +80,7 @@ std::shared_ptr<streamfx::obs::gs::texture> streamfx::gfx::source_texture::rende
 		return nullptr;
 	}
 
-	if (_child) {
-#ifdef ENABLE_PROFILING
-		auto cctr = streamfx::obs::gs::debug_marker(streamfx::obs::gs::debug_color_capture, "gfx::source_texture '%s'",
-													obs_source_get_name(_child->get()));
-#endif
-		auto op = _rt->render(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
-		vec4 black;
-		vec4_zero(&black);
-		gs_ortho(0, static_cast<float>(width), 0, static_cast<float_t>(height), 0, 1);
-		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
-		obs_source_video_render(_child.get());
-	}
-
-	std::shared_ptr<streamfx::obs::gs::texture> tex;
-	_rt->get_texture(tex);
-	return tex;
+	// Whoever else captures the same source at the same size this frame gets the same texture.
+	return streamfx::gfx::source_cache::get()->render(_child.get(), static_cast<uint32_t>(width),
+													   static_cast<uint32_t>(height), GS_RGBA);
 }
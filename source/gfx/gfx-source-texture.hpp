@@ -27,8 +27,6 @@ namespace streamfx::gfx {
 		streamfx::obs::source _parent;
 		streamfx::obs::source _child;
 
-		std::shared_ptr<streamfx::obs::gs::rendertarget> _rt;
-
 		public:
 		~source_texture();
 		source_texture(streamfx::obs::weak_source child, streamfx::obs::weak_source parent);
@@ -22,6 +22,7 @@
 #include <stdexcept>
 #include "gfx-shader.hpp"
 #include "gfx/gfx-debug.hpp"
+#include "gfx/gfx-source-cache.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "obs/obs-source-tracker.hpp"
 #include "util/util-platform.hpp"
@@ -73,7 +74,7 @@ streamfx::gfx::shader::texture_parameter::texture_parameter(streamfx::gfx::shade
 	: parameter(parent, param, prefix), _field_type(texture_field_type::Input), _keys(), _values(),
 	  _type(texture_type::File), _active(false), _visible(false), _dirty(true),
 	  _dirty_ts(std::chrono::high_resolution_clock::now()), _file_path(), _file_texture(), _source_name(), _source(),
-	  _source_child(), _source_active(), _source_visible(), _source_rendertarget()
+	  _source_child(), _source_active(), _source_visible(), _source_texture()
 {
 	char string_buffer[256];
 
@@ -211,22 +212,16 @@ void streamfx::gfx::shader::texture_parameter::properties(obs_properties_t* prop
 			auto p = obs_properties_add_list(pr, _keys[2].c_str(), D_TRANSLATE(ST_I18N_SOURCE), OBS_COMBO_TYPE_LIST,
 											 OBS_COMBO_FORMAT_STRING);
 			obs_property_list_add_string(p, "", "");
-			obs::source_tracker::get()->enumerate(
-				[&p](std::string name, obs_source_t*) {
-					std::stringstream sstr;
-					sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
-					obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-					return false;
-				},
-				obs::source_tracker::filter_video_sources);
-			obs::source_tracker::get()->enumerate(
-				[&p](std::string name, obs_source_t*) {
-					std::stringstream sstr;
-					sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
-					obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-					return false;
-				},
-				obs::source_tracker::filter_scenes);
+			for (auto const& name : *obs::source_tracker::get()->names(obs::source_tracker::kind::VIDEO)) {
+				std::stringstream sstr;
+				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
+				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+			}
+			for (auto const& name : *obs::source_tracker::get()->names(obs::source_tracker::kind::SCENE)) {
+				std::stringstream sstr;
+				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
+				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+			}
 		}
 
 		modified_type(this, props, nullptr, settings);
@@ -287,7 +282,7 @@ void streamfx::gfx::shader::texture_parameter::assign()
 			_source_child.reset();
 			_source_active.reset();
 			_source_visible.reset();
-			_source_rendertarget.reset();
+			_source_texture.reset();
 			_file_texture.reset();
 
 			if (((field_type() == texture_field_type::Input) && (_type == texture_type::File))
@@ -316,15 +311,11 @@ void streamfx::gfx::shader::texture_parameter::assign()
 					visible = ::streamfx::obs::source_showing_reference::add_showing_reference(source);
 				}
 
-				// Create the necessary render target to capture the source.
-				auto rt = std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
-
 				// Propagate all of this into the storage.
-				_source_rendertarget = rt;
-				_source_visible      = visible;
-				_source_active       = active;
-				_source_child        = child;
-				_source              = source;
+				_source_visible = visible;
+				_source_active  = active;
+				_source_child   = child;
+				_source         = source;
 			}
 
 			_dirty = false;
@@ -336,42 +327,20 @@ void streamfx::gfx::shader::texture_parameter::assign()
 	}
 
 	// If this is a source and active or visible, capture it.
-	if ((_type == texture_type::Source) && (_active || _visible) && _source_rendertarget) {
+	if ((_type == texture_type::Source) && (_active || _visible) && _source_child) {
 #ifdef ENABLE_PROFILING
 		::streamfx::obs::gs::debug_marker profiler1{::streamfx::obs::gs::debug_color_capture, "Parameter '%s'",
 													get_key().data()};
-		::streamfx::obs::gs::debug_marker profiler2{::streamfx::obs::gs::debug_color_capture, "Capture '%s'",
-													obs_source_get_name(_source.get())};
 #endif
-		uint32_t width  = obs_source_get_width(_source.get());
-		uint32_t height = obs_source_get_height(_source.get());
-
-		auto op = _source_rendertarget->render(width, height);
-
-		gs_matrix_push();
-		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
-
-		// ToDo: Figure out if this breaks some sources.
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-		gs_enable_blending(false);
-
-		gs_enable_color(true, true, true, true);
-
-		obs_source_video_render(_source.get());
-
-		gs_blend_state_pop();
-		gs_matrix_pop();
+		// Other parameters capturing the same source this frame share the result. The source overwrites the target
+		// with blending disabled, as this pass always did.
+		_source_texture = ::streamfx::gfx::source_cache::get()->render(
+			_source.get(), obs_source_get_width(_source.get()), obs_source_get_height(_source.get()), GS_RGBA, false);
 	}
 
 	if (_type == texture_type::Source) {
-		if (_source_rendertarget) {
-			auto tex = _source_rendertarget->get_texture();
-			if (tex) {
-				get_parameter().set_texture(_source_rendertarget->get_texture(), false);
-			} else {
-				get_parameter().set_texture(nullptr, false);
-			}
+		if (_source_texture) {
+			get_parameter().set_texture(_source_texture, false);
 		} else {
 			get_parameter().set_texture(nullptr, false);
 		}
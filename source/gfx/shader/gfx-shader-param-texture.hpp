@@ -63,7 +63,7 @@ namespace streamfx::gfx {
 			std::shared_ptr<streamfx::obs::source_active_child>      _source_child;
 			std::shared_ptr<streamfx::obs::source_active_reference>  _source_active;
 			std::shared_ptr<streamfx::obs::source_showing_reference> _source_visible;
-			std::shared_ptr<streamfx::obs::gs::rendertarget>         _source_rendertarget;
+			std::shared_ptr<streamfx::obs::gs::texture>              _source_texture;
 
 			public:
 			texture_parameter(streamfx::gfx::shader::shader* parent, streamfx::obs::gs::effect_parameter param,
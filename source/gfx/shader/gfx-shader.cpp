@@ -457,7 +457,7 @@ void streamfx::gfx::shader::shader::prepare_render()
 		return;
 
 	// Assign user parameters
-	for (auto kv : _shader_params) {
+	for (auto& kv : _shader_params) {
 		kv.second->assign();
 	}
 
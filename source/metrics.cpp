@@ -0,0 +1,459 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "metrics.hpp"
+#include <cstdlib>
+#include "configuration.hpp"
+#include "obs/gs/gs-helper.hpp"
+#include "obs/obs-instrumentation.hpp"
+#include "plugin.hpp"
+#include "util/util-logging.hpp"
+#include "util/util-memory.hpp"
+
+#ifdef D_PLATFORM_WINDOWS
+#include <WinSock2.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<metrics> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_CFG_PORT "Metrics.Port"
+#define ST_ENVIRONMENT "STREAMFX_METRICS_PORT"
+
+// Scrapers send tiny requests, anything larger is not meant for us.
+#define ST_REQUEST_LIMIT 8192
+#define ST_REQUEST_TIMEOUT 2
+
+// A scraper that hangs up early must not take OBS down with SIGPIPE.
+#ifdef D_PLATFORM_LINUX
+#define ST_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define ST_SEND_FLAGS 0
+#endif
+
+#ifdef D_PLATFORM_WINDOWS
+typedef SOCKET socket_t;
+#define ST_INVALID_SOCKET INVALID_SOCKET
+#define ST_CLOSE_SOCKET closesocket
+#else
+typedef int socket_t;
+#define ST_INVALID_SOCKET -1
+#define ST_CLOSE_SOCKET ::close
+#endif
+
+typedef std::vector<std::pair<std::string_view, std::string_view>> labels_t;
+
+static constexpr std::pair<double_t, std::string_view> _quantiles[] = {
+	{0.5, "0.5"},
+	{0.9, "0.9"},
+	{0.99, "0.99"},
+	{0.999, "0.999"},
+};
+
+static std::shared_ptr<streamfx::metrics> _instance;
+
+static void write_family(std::string& out, std::string_view name, std::string_view type, std::string_view help)
+{
+	out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+	out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+static void write_sample(std::string& out, std::string_view name, labels_t const& labels, double_t value)
+{
+	out.append(name);
+	if (!labels.empty()) {
+		out.push_back('{');
+		for (std::size_t idx = 0; idx < labels.size(); idx++) {
+			if (idx > 0) {
+				out.push_back(',');
+			}
+			out.append(labels[idx].first).append("=\"");
+			for (char chr : labels[idx].second) {
+				// Label values may contain anything the user typed into a source name.
+				switch (chr) {
+				case '\\':
+					out.append("\\\\");
+					break;
+				case '"':
+					out.append("\\\"");
+					break;
+				case '\n':
+					out.append("\\n");
+					break;
+				default:
+					out.push_back(chr);
+				}
+			}
+			out.push_back('"');
+		}
+		out.push_back('}');
+	}
+
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), " %.9g\n", value);
+	out.append(buffer);
+}
+
+static void write_summary(std::string& out, std::string_view name, labels_t labels,
+						  streamfx::util::profiler::snapshot const& snapshot)
+{
+	for (auto& quantile : _quantiles) {
+		labels.emplace_back("quantile", quantile.second);
+		write_sample(out, name, labels,
+					 static_cast<double_t>(snapshot.percentile(quantile.first).count()) / 1000000000.);
+		labels.pop_back();
+	}
+	write_sample(out, std::string(name) + "_sum", labels,
+				 static_cast<double_t>(snapshot.total_duration().count()) / 1000000000.);
+	write_sample(out, std::string(name) + "_count", labels, static_cast<double_t>(snapshot.count()));
+}
+
+static void close_socket(intptr_t socket)
+{
+	if (static_cast<socket_t>(socket) != ST_INVALID_SOCKET) {
+		ST_CLOSE_SOCKET(static_cast<socket_t>(socket));
+	}
+}
+
+streamfx::metrics::metrics(uint16_t port)
+	: _port(port), _socket(static_cast<intptr_t>(ST_INVALID_SOCKET)), _thread(), _shutdown(false)
+{
+#ifdef D_PLATFORM_WINDOWS
+	WSADATA wsa;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+		throw std::runtime_error("Failed to initialize WinSock.");
+	}
+#endif
+
+	try {
+		socket_t sock = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (sock == ST_INVALID_SOCKET) {
+			throw std::runtime_error("Failed to create socket.");
+		}
+		_socket = static_cast<intptr_t>(sock);
+
+		int reuse = 1;
+		setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+		// Never listen on anything but loopback, the data is not meant to leave the machine directly.
+		sockaddr_in addr{};
+		addr.sin_family      = AF_INET;
+		addr.sin_port        = htons(_port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (::bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+			throw std::runtime_error("Failed to bind socket, is the port already in use?");
+		}
+		if (::listen(sock, 4) != 0) {
+			throw std::runtime_error("Failed to listen on socket.");
+		}
+
+		_thread = std::thread([this]() { listen(); });
+	} catch (...) {
+		close_socket(_socket);
+#ifdef D_PLATFORM_WINDOWS
+		WSACleanup();
+#endif
+		throw;
+	}
+
+	D_LOG_INFO("Serving metrics on http://127.0.0.1:%" PRIu16 "/metrics.", _port);
+}
+
+streamfx::metrics::~metrics()
+{
+	_shutdown.store(true);
+	if (_thread.joinable()) {
+		_thread.join();
+	}
+	close_socket(_socket);
+#ifdef D_PLATFORM_WINDOWS
+	WSACleanup();
+#endif
+}
+
+uint16_t streamfx::metrics::port()
+{
+	return _port;
+}
+
+void streamfx::metrics::listen()
+{
+	socket_t sock = static_cast<socket_t>(_socket);
+
+	while (!_shutdown.load()) {
+		// Wake up regularly so that unloading never has to wait for a scrape.
+		fd_set fds;
+		FD_ZERO(&fds);
+		FD_SET(sock, &fds);
+		timeval timeout{0, 250000};
+		if (select(static_cast<int>(sock + 1), &fds, nullptr, nullptr, &timeout) <= 0) {
+			continue;
+		}
+
+		socket_t client = ::accept(sock, nullptr, nullptr);
+		if (client == ST_INVALID_SOCKET) {
+			continue;
+		}
+
+		try {
+			respond(static_cast<intptr_t>(client));
+		} catch (std::exception const& ex) {
+			D_LOG_WARNING("Failed to answer request: %s", ex.what());
+		}
+		close_socket(static_cast<intptr_t>(client));
+	}
+}
+
+void streamfx::metrics::respond(intptr_t client)
+{
+	socket_t sock = static_cast<socket_t>(client);
+
+	// A stuck client must not block other scrapers for long.
+#ifdef D_PLATFORM_WINDOWS
+	DWORD timeout = ST_REQUEST_TIMEOUT * 1000;
+#else
+	timeval timeout{ST_REQUEST_TIMEOUT, 0};
+#endif
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+	setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#ifdef D_PLATFORM_MAC
+	int nosigpipe = 1;
+	setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, reinterpret_cast<const char*>(&nosigpipe), sizeof(nosigpipe));
+#endif
+
+	std::string request;
+	while (request.find("\r\n\r\n") == std::string::npos) {
+		char buffer[1024];
+		auto read = ::recv(sock, buffer, sizeof(buffer), 0);
+		if (read <= 0) {
+			return;
+		}
+		request.append(buffer, static_cast<std::size_t>(read));
+		if (request.size() > ST_REQUEST_LIMIT) {
+			return;
+		}
+	}
+
+	std::string status = "404 Not Found";
+	std::string body;
+	if ((request.compare(0, 13, "GET /metrics ") == 0) || (request.compare(0, 13, "GET /metrics?") == 0)) {
+		status = "200 OK";
+		body   = collect();
+	}
+
+	std::string response;
+	response.reserve(body.size() + 128);
+	response.append("HTTP/1.1 ").append(status).append("\r\n");
+	response.append("Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n");
+	response.append("Content-Length: ").append(std::to_string(body.size())).append("\r\n");
+	response.append("Connection: close\r\n\r\n");
+	response.append(body);
+
+	std::size_t sent = 0;
+	while (sent < response.size()) {
+		auto written = ::send(sock, response.data() + sent, static_cast<int>(response.size() - sent), ST_SEND_FLAGS);
+		if (written <= 0) {
+			return;
+		}
+		sent += static_cast<std::size_t>(written);
+	}
+}
+
+std::string streamfx::metrics::collect()
+{
+	std::string out;
+	out.reserve(65536);
+
+	write_family(out, "streamfx_instrumentation_enabled", "gauge", "Whether per-instance timings are being gathered.");
+	write_sample(out, "streamfx_instrumentation_enabled", {},
+				 streamfx::obs::instrumentation::enabled() ? 1. : 0.);
+
+	if (auto pool = streamfx::threadpool(); pool) {
+		static constexpr std::pair<streamfx::util::threadpool_priority, std::string_view> priorities[] = {
+			{streamfx::util::threadpool_priority::REALTIME, "realtime"},
+			{streamfx::util::threadpool_priority::NORMAL, "normal"},
+			{streamfx::util::threadpool_priority::BACKGROUND, "background"},
+		};
+
+		write_family(out, "streamfx_threadpool_workers", "gauge", "Worker threads currently running.");
+		write_sample(out, "streamfx_threadpool_workers", {}, static_cast<double_t>(pool->workers_current()));
+		write_family(out, "streamfx_threadpool_workers_peak", "gauge", "Highest amount of concurrent workers.");
+		write_sample(out, "streamfx_threadpool_workers_peak", {}, static_cast<double_t>(pool->workers_peak()));
+		write_family(out, "streamfx_threadpool_concurrency", "gauge", "Amount of workers the pool may grow to.");
+		write_sample(out, "streamfx_threadpool_concurrency", {}, static_cast<double_t>(pool->concurrency()));
+		write_family(out, "streamfx_threadpool_workers_spawned_total", "counter", "Worker threads created so far.");
+		write_sample(out, "streamfx_threadpool_workers_spawned_total", {},
+					 static_cast<double_t>(pool->workers_spawned()));
+
+		// Only the most recent sample matters here, the scraper keeps its own history.
+		if (auto history = pool->queue_history(); !history.empty()) {
+			auto& sample = history.back();
+			write_family(out, "streamfx_threadpool_queued", "gauge", "Tasks waiting for a worker.");
+			for (auto& priority : priorities) {
+				write_sample(out, "streamfx_threadpool_queued", {{"priority", priority.second}},
+							 static_cast<double_t>(sample.queued[static_cast<std::size_t>(priority.first)]));
+			}
+		}
+
+		write_family(out, "streamfx_threadpool_wait_seconds", "summary", "Time from push to start of execution.");
+		for (auto& priority : priorities) {
+			write_summary(out, "streamfx_threadpool_wait_seconds", {{"priority", priority.second}},
+						  pool->wait_profiler(priority.first)->capture());
+		}
+		write_family(out, "streamfx_threadpool_execute_seconds", "summary", "Time spent executing tasks.");
+		for (auto& priority : priorities) {
+			write_summary(out, "streamfx_threadpool_execute_seconds", {{"priority", priority.second}},
+						  pool->execute_profiler(priority.first)->capture());
+		}
+	}
+
+	// Allocations made on behalf of the frame arenas and pools, which should stop growing once everything warmed up.
+	{
+		auto memory = streamfx::util::memory::stats();
+		write_family(out, "streamfx_memory_heap_allocations_total", "counter",
+					 "Allocations the arenas and pools made from the system.");
+		write_sample(out, "streamfx_memory_heap_allocations_total", {{"allocator", "arena"}},
+					 static_cast<double_t>(memory.arena_heap_allocations));
+		write_sample(out, "streamfx_memory_heap_allocations_total", {{"allocator", "pool"}},
+					 static_cast<double_t>(memory.pool_heap_allocations));
+		write_family(out, "streamfx_memory_heap_bytes_total", "counter",
+					 "Bytes the arenas and pools requested from the system.");
+		write_sample(out, "streamfx_memory_heap_bytes_total", {{"allocator", "arena"}},
+					 static_cast<double_t>(memory.arena_heap_bytes));
+		write_sample(out, "streamfx_memory_heap_bytes_total", {{"allocator", "pool"}},
+					 static_cast<double_t>(memory.pool_heap_bytes));
+		write_family(out, "streamfx_memory_arena_peak_bytes", "gauge", "Most a single frame took from its arena.");
+		write_sample(out, "streamfx_memory_arena_peak_bytes", {}, static_cast<double_t>(memory.arena_peak_bytes));
+	}
+
+	write_family(out, "streamfx_graphics_context_wait_seconds", "summary",
+				 "Time spent waiting to enter the graphics context.");
+	write_summary(out, "streamfx_graphics_context_wait_seconds", {},
+				  streamfx::obs::gs::context::wait_profiler()->capture());
+	write_family(out, "streamfx_graphics_context_hold_seconds", "summary",
+				 "Time the graphics context was held, during which nothing could be rendered.");
+	write_summary(out, "streamfx_graphics_context_hold_seconds", {},
+				  streamfx::obs::gs::context::hold_profiler()->capture());
+
+	if (streamfx::obs::instrumentation::enabled()) {
+		// Timings are cumulative since instrumentation was enabled, so rate() over '_count' of the encode callback
+		// is the encoded frame rate.
+		auto records = streamfx::obs::instrumentation::capture();
+
+		write_family(out, "streamfx_callback_seconds", "summary", "CPU time spent in callbacks and render passes.");
+		for (auto& record : records) {
+			write_summary(out, "streamfx_callback_seconds",
+						  {{"type", record.type},
+						   {"name", record.name},
+						   {"callback", streamfx::obs::instrumentation::cstring(record.function)},
+						   {"pass", record.pass}},
+						  record.timings);
+		}
+
+		write_family(out, "streamfx_callback_gpu_seconds", "summary", "GPU time spent in callbacks and render passes.");
+		for (auto& record : records) {
+			if (record.gpu.count() == 0) {
+				continue;
+			}
+			write_summary(out, "streamfx_callback_gpu_seconds",
+						  {{"type", record.type},
+						   {"name", record.name},
+						   {"callback", streamfx::obs::instrumentation::cstring(record.function)},
+						   {"pass", record.pass}},
+						  record.gpu);
+		}
+
+		auto summaries = streamfx::obs::instrumentation::summarize();
+
+		write_family(out, "streamfx_instance_render_target_bytes", "gauge", "Video memory held by render targets.");
+		for (auto& sum : summaries) {
+			write_sample(out, "streamfx_instance_render_target_bytes",
+						 {{"type", sum.type},
+						  {"name", sum.name},
+						  {"kind", streamfx::obs::instrumentation::cstring(sum.kind)}},
+						 static_cast<double_t>(sum.memory));
+		}
+
+		write_family(out, "streamfx_instance_skipped_frames_total", "counter", "Frames that were skipped.");
+		for (auto& sum : summaries) {
+			write_sample(out, "streamfx_instance_skipped_frames_total",
+						 {{"type", sum.type},
+						  {"name", sum.name},
+						  {"kind", streamfx::obs::instrumentation::cstring(sum.kind)}},
+						 static_cast<double_t>(sum.skipped));
+		}
+	}
+
+	return out;
+}
+
+void streamfx::metrics::initialize()
+{
+	if (_instance) {
+		return;
+	}
+
+	// The environment takes precedence, which allows enabling metrics per machine without touching the configuration.
+	int64_t port = 0;
+	if (const char* env = getenv(ST_ENVIRONMENT); env) {
+		port = strtoll(env, nullptr, 10);
+	} else if (auto config = streamfx::configuration::instance(); config) {
+		auto dataptr = config->get();
+		if (obs_data_has_user_value(dataptr.get(), ST_CFG_PORT)) {
+			port = obs_data_get_int(dataptr.get(), ST_CFG_PORT);
+		}
+	}
+	if ((port <= 0) || (port > UINT16_MAX)) {
+		return;
+	}
+
+	try {
+		_instance = std::make_shared<streamfx::metrics>(static_cast<uint16_t>(port));
+	} catch (std::exception const& ex) {
+		D_LOG_ERROR("Failed to serve metrics on port %" PRId64 ": %s", port, ex.what());
+	}
+}
+
+void streamfx::metrics::finalize()
+{
+	_instance.reset();
+}
+
+std::shared_ptr<streamfx::metrics> streamfx::metrics::instance()
+{
+	return _instance;
+}
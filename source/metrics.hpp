@@ -0,0 +1,60 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include "common.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace streamfx {
+	/** Publishes performance counters in the Prometheus text format.
+	 *
+	 * Serves plain HTTP on the loopback interface only, and only if a port was configured through 'Metrics.Port' in
+	 * the configuration or the STREAMFX_METRICS_PORT environment variable. Requests are answered on a dedicated
+	 * thread from data that is already being gathered elsewhere, so scraping never enters the graphics context.
+	 * Per-instance timings are only included while instrumentation was enabled separately.
+	 */
+	class metrics {
+		uint16_t          _port;
+		intptr_t          _socket;
+		std::thread       _thread;
+		std::atomic<bool> _shutdown;
+
+		public:
+		metrics(uint16_t port);
+		~metrics();
+
+		uint16_t port();
+
+		private:
+		void listen();
+
+		void respond(intptr_t client);
+
+		std::string collect();
+
+		public /* Singleton */:
+		static void initialize();
+
+		static void finalize();
+
+		static std::shared_ptr<streamfx::metrics> instance();
+	};
+} // namespace streamfx
@@ -136,11 +136,11 @@ streamfx::obs::gs::effect_technique streamfx::obs::gs::effect::get_technique(std
 	return streamfx::obs::gs::effect_technique(get()->techniques.array + idx, *this);
 }
 
-streamfx::obs::gs::effect_technique streamfx::obs::gs::effect::get_technique(const std::string& name)
+streamfx::obs::gs::effect_technique streamfx::obs::gs::effect::get_technique(const std::string_view name)
 {
 	for (std::size_t idx = 0; idx < count_techniques(); idx++) {
 		auto ptr = get()->techniques.array + idx;
-		if (strcmp(ptr->name, name.c_str()) == 0) {
+		if (name == std::string_view{ptr->name}) {
 			return streamfx::obs::gs::effect_technique(ptr, *this);
 		}
 	}
@@ -148,7 +148,7 @@ streamfx::obs::gs::effect_technique streamfx::obs::gs::effect::get_technique(con
 	return nullptr;
 }
 
-bool streamfx::obs::gs::effect::has_technique(const std::string& name)
+bool streamfx::obs::gs::effect::has_technique(const std::string_view name)
 {
 	if (get_technique(name))
 		return true;
@@ -169,11 +169,11 @@ streamfx::obs::gs::effect_parameter streamfx::obs::gs::effect::get_parameter(std
 	return streamfx::obs::gs::effect_parameter(get()->params.array + idx, *this);
 }
 
-streamfx::obs::gs::effect_parameter streamfx::obs::gs::effect::get_parameter(const std::string& name)
+streamfx::obs::gs::effect_parameter streamfx::obs::gs::effect::get_parameter(const std::string_view name)
 {
 	for (std::size_t idx = 0; idx < count_parameters(); idx++) {
 		auto ptr = get()->params.array + idx;
-		if (strcmp(ptr->name, name.c_str()) == 0) {
+		if (name == std::string_view{ptr->name}) {
 			return streamfx::obs::gs::effect_parameter(ptr, *this);
 		}
 	}
@@ -181,14 +181,14 @@ streamfx::obs::gs::effect_parameter streamfx::obs::gs::effect::get_parameter(con
 	return nullptr;
 }
 
-bool streamfx::obs::gs::effect::has_parameter(const std::string& name)
+bool streamfx::obs::gs::effect::has_parameter(const std::string_view name)
 {
 	if (get_parameter(name))
 		return true;
 	return false;
 }
 
-bool streamfx::obs::gs::effect::has_parameter(const std::string& name, effect_parameter::type type)
+bool streamfx::obs::gs::effect::has_parameter(const std::string_view name, effect_parameter::type type)
 {
 	auto eprm = get_parameter(name);
 	if (eprm)
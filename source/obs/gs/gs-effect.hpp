@@ -34,14 +34,14 @@ namespace streamfx::obs::gs {
 
 		std::size_t                         count_techniques();
 		streamfx::obs::gs::effect_technique get_technique(std::size_t idx);
-		streamfx::obs::gs::effect_technique get_technique(const std::string& name);
-		bool                                has_technique(const std::string& name);
+		streamfx::obs::gs::effect_technique get_technique(const std::string_view name);
+		bool                                has_technique(const std::string_view name);
 
 		std::size_t                         count_parameters();
 		streamfx::obs::gs::effect_parameter get_parameter(std::size_t idx);
-		streamfx::obs::gs::effect_parameter get_parameter(const std::string& name);
-		bool                                has_parameter(const std::string& name);
-		bool                                has_parameter(const std::string& name, effect_parameter::type type);
+		streamfx::obs::gs::effect_parameter get_parameter(const std::string_view name);
+		bool                                has_parameter(const std::string_view name);
+		bool                                has_parameter(const std::string_view name, effect_parameter::type type);
 
 		public /* Legacy Support */:
 		inline gs_effect_t* get_object()
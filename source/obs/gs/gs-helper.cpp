@@ -18,3 +18,15 @@
  */
 
 #include "gs-helper.hpp"
+
+std::shared_ptr<streamfx::util::profiler> streamfx::obs::gs::context::wait_profiler()
+{
+	static std::shared_ptr<streamfx::util::profiler> instance = streamfx::util::profiler::create();
+	return instance;
+}
+
+std::shared_ptr<streamfx::util::profiler> streamfx::obs::gs::context::hold_profiler()
+{
+	static std::shared_ptr<streamfx::util::profiler> instance = streamfx::util::profiler::create();
+	return instance;
+}
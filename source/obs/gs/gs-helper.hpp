@@ -19,22 +19,71 @@
 
 #pragma once
 #include "common.hpp"
+#include <chrono>
 #include <vector>
 #include "plugin.hpp"
+#include "util/util-profiler.hpp"
+
+#ifdef ENABLE_PROFILING
+#include <algorithm>
+#include <cstdarg>
+#include "util/util-memory.hpp"
+#include "util/util-tracer.hpp"
+#endif
 
 namespace streamfx::obs::gs {
+	/** Holds the graphics context for as long as it exists.
+	 *
+	 * The graphics thread can't render while anyone else holds the context, so only take it for work that actually
+	 * touches the GPU. The time spent waiting for and holding the context is tracked, except when the thread already
+	 * held it.
+	 */
 	class context {
+		bool _entered;
+		bool                                           _tracked;
+		std::chrono::high_resolution_clock::time_point _acquired;
+
 		public:
-		inline context()
+		inline context() : context(true) {}
+
+		/** Only enter the graphics context if 'enter' is set, for code that needs it only for hardware resources. */
+		inline context(bool enter) : _entered(enter)
 		{
+			if (!_entered) {
+				return;
+			}
+
+			_tracked   = (gs_get_context() == nullptr);
+			auto start = std::chrono::high_resolution_clock::now();
 			obs_enter_graphics();
 			if (gs_get_context() == nullptr)
 				throw std::runtime_error("Failed to enter graphics context.");
+			_acquired = std::chrono::high_resolution_clock::now();
+			if (_tracked) {
+				wait_profiler()->track(_acquired - start);
+			}
 		}
 		~context()
 		{
+			if (!_entered) {
+				return;
+			}
+
+			if (_tracked) {
+				hold_profiler()->track(std::chrono::high_resolution_clock::now() - _acquired);
+			}
 			obs_leave_graphics();
 		}
+
+		context(context const&)            = delete;
+		context& operator=(context const&) = delete;
+
+		public:
+		/** Time spent waiting to enter the graphics context from outside of it. */
+		static std::shared_ptr<streamfx::util::profiler> wait_profiler();
+
+		/** Time the graphics context was held after entering it from outside of it. */
+		static std::shared_ptr<streamfx::util::profiler> hold_profiler();
 	};
 
 #ifdef ENABLE_PROFILING
@@ -64,25 +113,30 @@ namespace streamfx::obs::gs {
 	static const float_t* debug_color_render       = debug_color_teal;
 
 	class debug_marker {
-		std::string _name;
-
 		public:
 		inline debug_marker(const float_t color[4], const char* format, ...)
 		{
-			std::size_t       size;
-			std::vector<char> buffer(64);
+			// Markers are placed every frame, so format the name into the frame arena instead of the heap.
+			streamfx::util::memory::arena::scope scope;
 
 			va_list vargs;
+			va_list vargs_size;
 			va_start(vargs, format);
-			size = static_cast<size_t>(vsnprintf(buffer.data(), buffer.size(), format, vargs));
+			va_copy(vargs_size, vargs);
+			std::size_t size = static_cast<size_t>(std::max(vsnprintf(nullptr, 0, format, vargs_size), 0)) + 1;
+			va_end(vargs_size);
+
+			char* name = streamfx::util::memory::frame_arena().allocate<char>(size);
+			vsnprintf(name, size, format, vargs);
 			va_end(vargs);
 
-			_name = std::string(buffer.data(), buffer.data() + size);
-			gs_debug_marker_begin(color, _name.c_str());
+			gs_debug_marker_begin(color, name);
+			streamfx::util::tracer::begin(name);
 		}
 
 		inline ~debug_marker()
 		{
+			streamfx::util::tracer::end();
 			gs_debug_marker_end();
 		}
 	};
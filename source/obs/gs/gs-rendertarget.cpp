@@ -20,15 +20,20 @@
 #include "gs-rendertarget.hpp"
 #include <stdexcept>
 #include "obs/gs/gs-helper.hpp"
+#include "obs/obs-instrumentation.hpp"
 
 streamfx::obs::gs::rendertarget::~rendertarget()
 {
+	if (_owner) {
+		streamfx::obs::instrumentation::release_memory(_owner, this);
+	}
+
 	auto gctx = streamfx::obs::gs::context();
 	gs_texrender_destroy(_render_target);
 }
 
 streamfx::obs::gs::rendertarget::rendertarget(gs_color_format colorFormat, gs_zstencil_format zsFormat)
-	: _color_format(colorFormat), _zstencil_format(zsFormat)
+	: _color_format(colorFormat), _zstencil_format(zsFormat), _owner(nullptr), _owned_size(0)
 {
 	_is_being_rendered = false;
 	auto gctx          = streamfx::obs::gs::context();
@@ -80,6 +85,43 @@ gs_zstencil_format streamfx::obs::gs::rendertarget::get_zstencil_format()
 	return _zstencil_format;
 }
 
+void streamfx::obs::gs::rendertarget::track_memory(uint32_t width, uint32_t height)
+{
+	// Render targets used outside of any instance keep whatever owner they had before.
+	void* owner = streamfx::obs::instrumentation::current();
+	if (!owner) {
+		return;
+	}
+
+	uint64_t bpp = gs_get_format_bpp(_color_format);
+	switch (_zstencil_format) {
+	case GS_Z16:
+		bpp += 16;
+		break;
+	case GS_Z24_S8:
+	case GS_Z32F:
+		bpp += 32;
+		break;
+	case GS_Z32F_S8X24:
+		bpp += 64;
+		break;
+	default:
+		break;
+	}
+
+	uint64_t size = uint64_t(width) * uint64_t(height) * bpp / 8;
+	if ((owner == _owner) && (size == _owned_size)) {
+		return;
+	}
+
+	if (_owner && (_owner != owner)) {
+		streamfx::obs::instrumentation::release_memory(_owner, this);
+	}
+	streamfx::obs::instrumentation::track_memory(owner, this, size);
+	_owner      = owner;
+	_owned_size = size;
+}
+
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget* rt, uint32_t width,
 													uint32_t height)
 	: parent(rt)
@@ -95,6 +137,10 @@ streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertar
 		throw std::runtime_error("Failed to begin rendering to render target.");
 	}
 	parent->_is_being_rendered = true;
+
+	if (streamfx::obs::instrumentation::enabled()) {
+		parent->track_memory(width, height);
+	}
 }
 
 streamfx::obs::gs::rendertarget_op::rendertarget_op(streamfx::obs::gs::rendertarget_op&& r)
@@ -34,6 +34,10 @@ namespace streamfx::obs::gs {
 		gs_color_format    _color_format;
 		gs_zstencil_format _zstencil_format;
 
+		// Instance that the memory of this render target is accounted to, see obs::instrumentation.
+		void*    _owner;
+		uint64_t _owned_size;
+
 		public:
 		~rendertarget();
 
@@ -54,6 +58,9 @@ namespace streamfx::obs::gs {
 		gs_zstencil_format get_zstencil_format();
 
 		streamfx::obs::gs::rendertarget_op render(uint32_t width, uint32_t height);
+
+		private:
+		void track_memory(uint32_t width, uint32_t height);
 	};
 
 	class rendertarget_op {
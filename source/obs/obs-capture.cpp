@@ -0,0 +1,435 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include "obs-capture.hpp"
+#include <cinttypes>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "obs/gs/gs-helper.hpp"
+#include "obs/gs/gs-rendertarget.hpp"
+#include "plugin.hpp"
+#include "strings.hpp"
+#include "util/util-logging.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<obs::capture> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_ENVIRONMENT "STREAMFX_CAPTURE"
+#define ST_ENVIRONMENT_FRAMES "STREAMFX_CAPTURE_FRAMES"
+#define ST_DEFAULT_FRAMES 60
+
+#define ST_I18N "Capture"
+#define ST_KEY "StreamFX.Capture"
+
+namespace streamfx::obs::capture {
+	std::atomic<std::size_t> _active{0};
+
+	struct frame {
+		std::string file;
+		uint64_t    time;
+		uint64_t    render;
+	};
+
+	// Frames are several megabytes each, so buffers come back here once written instead of being freed.
+	struct buffer_pool {
+		std::mutex                                      lock;
+		std::vector<std::unique_ptr<std::vector<char>>> free;
+	};
+
+	struct session {
+		void*                 instance = nullptr;
+		obs_source_t*         source   = nullptr;
+		std::filesystem::path path;
+		std::string           id;
+		std::string           name;
+		std::string           settings;
+		uint32_t              frames = 0;
+		uint32_t              width  = 0;
+		uint32_t              height = 0;
+		uint64_t              epoch  = 0;
+		std::vector<frame>    log;
+
+		std::unique_ptr<streamfx::obs::gs::rendertarget> input;
+		gs_stagesurf_t*                                  stage[2] = {nullptr, nullptr};
+		std::shared_ptr<buffer_pool>                     buffers  = std::make_shared<buffer_pool>();
+
+		~session()
+		{
+			if (input || stage[0] || stage[1]) {
+				auto gctx = streamfx::obs::gs::context();
+				input.reset();
+				for (auto& surface : stage) {
+					if (surface) {
+						gs_stagesurface_destroy(surface);
+					}
+				}
+			}
+		}
+	};
+
+	static std::mutex                                          _lock;
+	static std::unordered_map<void*, obs_source_t*>            _sources;
+	static std::unordered_map<void*, std::shared_ptr<session>> _sessions;
+
+	static std::filesystem::path const& directory()
+	{
+		static std::filesystem::path path = []() {
+			const char* value = std::getenv(ST_ENVIRONMENT);
+			return (value && *value) ? std::filesystem::u8path(value) : std::filesystem::path();
+		}();
+		return path;
+	}
+
+	static uint32_t frame_count()
+	{
+		if (const char* value = std::getenv(ST_ENVIRONMENT_FRAMES); value) {
+			if (auto count = std::strtoul(value, nullptr, 10); count > 0) {
+				return static_cast<uint32_t>(count);
+			}
+		}
+		return ST_DEFAULT_FRAMES;
+	}
+
+	static std::string sanitize(std::string name)
+	{
+		// Source names may contain anything, including path separators.
+		for (auto& chr : name) {
+			if (!(((chr >= 'a') && (chr <= 'z')) || ((chr >= 'A') && (chr <= 'Z')) || ((chr >= '0') && (chr <= '9'))
+				  || (chr == '-') || (chr == '_'))) {
+				chr = '_';
+			}
+		}
+		return name;
+	}
+
+	static std::string escape(std::string const& text)
+	{
+		std::string result;
+		result.reserve(text.size());
+		for (char chr : text) {
+			if ((chr == '"') || (chr == '\\')) {
+				result.push_back('\\');
+				result.push_back(chr);
+			} else if (static_cast<unsigned char>(chr) < 0x20) {
+				char buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned int>(chr));
+				result.append(buf);
+			} else {
+				result.push_back(chr);
+			}
+		}
+		return result;
+	}
+
+	static void write(std::filesystem::path path, std::shared_ptr<std::vector<char>> data)
+	{
+		// Disks are slow, the render thread must never wait for one.
+		streamfx::threadpool()->push(
+			[path, data](streamfx::util::threadpool_data_t) {
+				std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+				stream.write(data->data(), static_cast<std::streamsize>(data->size()));
+				if (!stream) {
+					D_LOG_ERROR("Failed to write '%s'.", path.u8string().c_str());
+				}
+			},
+			nullptr);
+	}
+
+	static std::shared_ptr<std::vector<char>> acquire(std::shared_ptr<buffer_pool> const& pool, std::size_t size)
+	{
+		std::unique_ptr<std::vector<char>> buffer;
+		{
+			std::lock_guard<std::mutex> lock(pool->lock);
+			if (!pool->free.empty()) {
+				buffer = std::move(pool->free.back());
+				pool->free.pop_back();
+			}
+		}
+		if (!buffer) {
+			buffer = std::make_unique<std::vector<char>>();
+		}
+		buffer->resize(size);
+
+		// The pool outlives the session if a write is still queued, so it is kept alive by the buffers instead.
+		return std::shared_ptr<std::vector<char>>(buffer.release(), [pool](std::vector<char>* ptr) {
+			std::lock_guard<std::mutex> lock(pool->lock);
+			pool->free.emplace_back(ptr);
+		});
+	}
+
+	static void download(session& s, std::size_t index)
+	{
+		auto     data     = acquire(s.buffers, static_cast<std::size_t>(s.width) * s.height * 4);
+		uint8_t* pixels   = nullptr;
+		uint32_t linesize = 0;
+		if (!gs_stagesurface_map(s.stage[index % 2], &pixels, &linesize)) {
+			throw std::runtime_error("Failed to read back the input.");
+		}
+		for (uint32_t y = 0; y < s.height; y++) {
+			memcpy(data->data() + static_cast<std::size_t>(y) * s.width * 4,
+				   pixels + static_cast<std::size_t>(y) * linesize, static_cast<std::size_t>(s.width) * 4);
+		}
+		gs_stagesurface_unmap(s.stage[index % 2]);
+
+		write(s.path / s.log[index].file, data);
+	}
+
+	static void record(session& s)
+	{
+		obs_source_t* parent = obs_filter_get_parent(s.source);
+		obs_source_t* target = obs_filter_get_target(s.source);
+		if (!parent || !target) {
+			throw std::runtime_error("Filter has no input.");
+		}
+
+		uint32_t width  = obs_source_get_base_width(target);
+		uint32_t height = obs_source_get_base_height(target);
+		if (s.log.empty()) {
+			s.width  = width;
+			s.height = height;
+		} else if ((s.width != width) || (s.height != height)) {
+			throw std::runtime_error("Input size changed during capture.");
+		}
+		if ((width == 0) || (height == 0)) {
+			throw std::runtime_error("Input has no size.");
+		}
+
+		if (!s.input) {
+			s.input = std::make_unique<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE);
+		}
+		{
+			auto op    = s.input->render(width, height);
+			vec4 blank = {0, 0, 0, 0};
+			gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), -1., 1.);
+			gs_clear(GS_CLEAR_COLOR, &blank, 0, 0);
+
+			// Same as what libobs does when a filter asks for its input, minus the filter itself.
+			gs_blend_state_push();
+			gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+			uint32_t flags = obs_source_get_output_flags(target);
+			if ((target == parent) && ((flags & (OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_ASYNC)) == 0)) {
+				obs_source_default_render(target);
+			} else {
+				obs_source_video_render(target);
+			}
+			gs_blend_state_pop();
+		}
+
+		std::size_t index = s.log.size();
+		uint64_t    now   = os_gettime_ns();
+		if (index == 0) {
+			s.epoch = now;
+		}
+		char file[32];
+		snprintf(file, sizeof(file), "frame-%06zu.raw", index);
+		s.log.push_back({file, now - s.epoch, 0});
+
+		// Two surfaces, so that the copy of a frame is read one frame later when the GPU is long done with it.
+		if (!s.stage[index % 2]) {
+			s.stage[index % 2] = gs_stagesurface_create(width, height, GS_RGBA);
+		}
+		gs_stage_texture(s.stage[index % 2], s.input->get_object());
+		if (index > 0) {
+			download(s, index - 1);
+		}
+		if (index + 1 == s.frames) {
+			download(s, index);
+		}
+	}
+
+	static void finish(std::shared_ptr<session> const& s, bool complete)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			auto                        kv = _sessions.find(s->instance);
+			if ((kv == _sessions.end()) || (kv->second != s)) {
+				return;
+			}
+			_sessions.erase(kv);
+			_active.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		if (!complete) {
+			D_LOG_WARNING("Capture of '%s' was abandoned after %zu frames.", s->name.c_str(), s->log.size());
+			return;
+		}
+
+		double_t       fps = 0.;
+		obs_video_info ovi;
+		if (obs_get_video_info(&ovi) && (ovi.fps_den > 0)) {
+			fps = static_cast<double_t>(ovi.fps_num) / static_cast<double_t>(ovi.fps_den);
+		}
+
+		// Settings are already JSON, and everything else is simple enough to not need a library.
+		std::stringstream manifest;
+		manifest.precision(17);
+		manifest << "{\n";
+		manifest << "\t\"version\": 1,\n";
+		manifest << "\t\"id\": \"" << escape(s->id) << "\",\n";
+		manifest << "\t\"name\": \"" << escape(s->name) << "\",\n";
+		manifest << "\t\"settings\": " << (s->settings.empty() ? "{}" : s->settings) << ",\n";
+		manifest << "\t\"width\": " << s->width << ",\n";
+		manifest << "\t\"height\": " << s->height << ",\n";
+		manifest << "\t\"format\": \"rgba8\",\n";
+		manifest << "\t\"fps\": " << fps << ",\n";
+		manifest << "\t\"frames\": [";
+		for (std::size_t idx = 0; idx < s->log.size(); idx++) {
+			auto& entry = s->log[idx];
+			manifest << (idx > 0 ? "," : "") << "\n\t\t{\"file\": \"" << entry.file << "\", \"time_ns\": " << entry.time
+					 << ", \"render_ns\": " << entry.render << "}";
+		}
+		manifest << "\n\t]\n}\n";
+
+		auto text = manifest.str();
+		write(s->path / "manifest.json", std::make_shared<std::vector<char>>(text.begin(), text.end()));
+		D_LOG_INFO("Captured %zu frames of '%s' to '%s'.", s->log.size(), s->name.c_str(), s->path.u8string().c_str());
+	}
+
+	bool available()
+	{
+		return !directory().empty();
+	}
+
+	void add_properties(obs_properties_t* props, void* instance, obs_source_t* source)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_sources[instance] = source;
+		}
+
+		obs_properties_add_button2(
+			props, ST_KEY, D_TRANSLATE(ST_I18N),
+			[](obs_properties_t*, obs_property_t*, void* data) {
+				try {
+					start(data);
+				} catch (const std::exception& ex) {
+					D_LOG_ERROR("Failed to start capture: %s", ex.what());
+				}
+				return false;
+			},
+			instance);
+	}
+
+	void start(void* instance)
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		auto                        kv = _sources.find(instance);
+		if ((kv == _sources.end()) || (_sessions.count(instance) > 0)) {
+			return;
+		}
+
+		auto s      = std::make_shared<session>();
+		s->instance = instance;
+		s->source   = kv->second;
+		s->id       = obs_source_get_id(s->source);
+		s->name     = obs_source_get_name(s->source) ? obs_source_get_name(s->source) : "";
+		s->frames   = frame_count();
+		if (obs_data_t* settings = obs_source_get_settings(s->source); settings) {
+			s->settings = obs_data_get_json(settings);
+			obs_data_release(settings);
+		}
+		s->log.reserve(s->frames);
+
+		char        stamp[32];
+		std::time_t now = std::time(nullptr);
+		std::tm     local{};
+#ifdef D_PLATFORM_WINDOWS
+		localtime_s(&local, &now);
+#else
+		localtime_r(&now, &local);
+#endif
+		std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+		s->path = directory() / std::filesystem::u8path(sanitize(s->name) + "-" + stamp);
+		std::filesystem::create_directories(s->path);
+
+		_sessions.emplace(instance, s);
+		_active.fetch_add(1, std::memory_order_relaxed);
+		D_LOG_INFO("Capturing %" PRIu32 " frames of '%s' to '%s'.", s->frames, s->name.c_str(),
+				   s->path.u8string().c_str());
+	}
+
+	void remove(void* instance)
+	{
+		std::shared_ptr<session> s;
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_sources.erase(instance);
+			if (auto kv = _sessions.find(instance); kv != _sessions.end()) {
+				s = kv->second;
+			}
+		}
+		if (s) {
+			finish(s, false);
+		}
+	}
+
+	void scope::begin(void* instance)
+	{
+		std::shared_ptr<session> s;
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			auto                        kv = _sessions.find(instance);
+			if (kv == _sessions.end()) {
+				return;
+			}
+			s = kv->second;
+		}
+
+		try {
+			record(*s);
+		} catch (const std::exception& ex) {
+			D_LOG_ERROR("Failed to capture '%s': %s", s->name.c_str(), ex.what());
+			finish(s, false);
+			return;
+		}
+
+		_session = s;
+		_start   = std::chrono::high_resolution_clock::now();
+	}
+
+	void scope::end()
+	{
+		auto elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+		_session->log.back().render =
+			static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		if (_session->log.size() >= _session->frames) {
+			finish(_session, true);
+		}
+	}
+} // namespace streamfx::obs::capture
@@ -0,0 +1,81 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#pragma once
+#include "common.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+/** Records what a filter received as input for a number of frames, so that it can be replayed offline.
+ *
+ * Only available if the STREAMFX_CAPTURE environment variable names an output directory, in which case every video
+ * filter gains a button that captures its next STREAMFX_CAPTURE_FRAMES frames (60 by default). Each frame of input is
+ * written as raw RGBA8 next to a 'manifest.json' holding the settings and timings, which the GPU benchmark can feed
+ * back into the same filter with '--replay'.
+ */
+namespace streamfx::obs::capture {
+	struct session;
+
+	extern std::atomic<std::size_t> _active;
+
+	/** Check if any instance is being captured right now. */
+	inline bool active()
+	{
+		return _active.load(std::memory_order_relaxed) > 0;
+	}
+
+	/** Check if captures were enabled through the environment. */
+	bool available();
+
+	/** Add the capture button for an instance, called by the factories when building properties. */
+	void add_properties(obs_properties_t* props, void* instance, obs_source_t* source);
+
+	/** Begin capturing the next frames of an instance. */
+	void start(void* instance);
+
+	/** Abandon any capture of an instance, called by the factories right before destruction. */
+	void remove(void* instance);
+
+	class scope {
+		std::shared_ptr<session>                       _session;
+		std::chrono::high_resolution_clock::time_point _start;
+
+		public:
+		FORCE_INLINE scope(void* instance)
+		{
+			if (active()) {
+				begin(instance);
+			}
+		}
+
+		FORCE_INLINE ~scope()
+		{
+			if (_session) {
+				end();
+			}
+		}
+
+		private:
+		void begin(void* instance);
+
+		void end();
+	};
+} // namespace streamfx::obs::capture
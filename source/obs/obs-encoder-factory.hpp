@@ -19,7 +19,9 @@
 
 #pragma once
 #include "common.hpp"
+#include "obs-instrumentation.hpp"
 #include "plugin.hpp"
+#include "util/util-memory.hpp"
 
 namespace streamfx::obs {
 	class encoder_instance {
@@ -189,7 +191,10 @@ namespace streamfx::obs {
 		static void* _create(obs_data_t* settings, obs_encoder_t* encoder) noexcept
 		try {
 			auto* fac = reinterpret_cast<factory_t*>(obs_encoder_get_type_data(encoder));
-			return fac->create(settings, encoder, false);
+			void* instance = fac->create(settings, encoder, false);
+			if (instance)
+				instrumentation::add(instance, encoder);
+			return instance;
 		} catch (const std::exception& ex) {
 			DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			return nullptr;
@@ -202,7 +207,10 @@ namespace streamfx::obs {
 		try {
 			auto* fac = reinterpret_cast<factory_t*>(obs_encoder_get_type_data(encoder));
 			try {
-				return fac->create(settings, encoder, true);
+				void* instance = fac->create(settings, encoder, true);
+				if (instance)
+					instrumentation::add(instance, encoder);
+				return instance;
 			} catch (...) {
 				return obs_encoder_create_rerouted(encoder, fac->_info_fallback.id);
 			}
@@ -265,8 +273,10 @@ namespace streamfx::obs {
 		private /* Instance */:
 		static void _destroy(void* data) noexcept
 		try {
-			if (data)
+			if (data) {
+				instrumentation::remove(data);
 				delete reinterpret_cast<instance_t*>(data);
+			}
 		} catch (const std::exception& ex) {
 			DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 		} catch (...) {
@@ -292,6 +302,8 @@ namespace streamfx::obs {
 		static bool _encode(void* data, struct encoder_frame* frame, struct encoder_packet* packet,
 							bool* received_packet) noexcept
 		try {
+			instrumentation::probe               probe{data, instrumentation::callback::ENCODE};
+			streamfx::util::memory::arena::scope frame_scope;
 			if (data)
 				return reinterpret_cast<encoder_instance*>(data)->encode_video(frame, packet, received_packet);
 			return false;
@@ -306,6 +318,8 @@ namespace streamfx::obs {
 		static bool _encode_texture(void* data, uint32_t handle, int64_t pts, uint64_t lock_key, uint64_t* next_key,
 									struct encoder_packet* packet, bool* received_packet) noexcept
 		try {
+			instrumentation::probe               probe{data, instrumentation::callback::ENCODE};
+			streamfx::util::memory::arena::scope frame_scope;
 			if (data)
 				return reinterpret_cast<encoder_instance*>(data)->encode_video(handle, pts, lock_key, next_key, packet,
 																			   received_packet);
@@ -0,0 +1,481 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "obs-instrumentation.hpp"
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include "gfx/gfx-gpu-timer.hpp"
+#include "util/util-logging.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<obs::instrumentation> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_ENVIRONMENT "STREAMFX_INSTRUMENTATION"
+
+namespace streamfx::obs::instrumentation {
+	struct timing {
+		std::shared_ptr<streamfx::util::profiler> cpu;
+		std::shared_ptr<streamfx::gfx::gpu_timer> gpu;
+	};
+
+	struct entry {
+		obs_source_t*  source;
+		obs_encoder_t* encoder;
+		std::string    type;
+		category       kind;
+
+		std::unordered_map<void const*, uint64_t> memory;
+		std::atomic<uint64_t>                     skipped{0};
+
+		// Profilers are only created once a callback is actually called with instrumentation enabled, as each one
+		// holds a full histogram. Passes are found by the name the probe was given, without building a string for it.
+		timing                                     callbacks[static_cast<size_t>(callback::_COUNT)];
+		std::map<std::string, timing, std::less<>> passes;
+	};
+
+	std::atomic<bool> _enabled{false};
+
+	static std::shared_mutex                                  _lock;
+	static std::unordered_map<void*, std::shared_ptr<entry>> _entries;
+	static thread_local void*                                 _current = nullptr;
+
+	static void collect(entry& entry, std::vector<record>& records, bool reset)
+	{
+		// Names can change at any time, so they are only looked up here. The caller guarantees that the instance, and
+		// with it the source or encoder, is still alive.
+		const char* name = nullptr;
+		if (entry.source) {
+			name = obs_source_get_name(entry.source);
+		} else if (entry.encoder) {
+			name = obs_encoder_get_name(entry.encoder);
+		}
+
+		auto append = [&](timing& timing, callback function, std::string const& pass) {
+			if (!timing.cpu) {
+				return;
+			}
+
+			record rec;
+			rec.type     = entry.type;
+			rec.name     = name ? name : "";
+			rec.function = function;
+			rec.pass     = pass;
+			rec.timings  = timing.cpu->capture(reset);
+			if (timing.gpu) {
+				rec.gpu = timing.gpu->profiler()->capture(reset);
+			}
+			if (rec.timings.count() > 0) {
+				records.push_back(std::move(rec));
+			}
+		};
+
+		for (size_t idx = 0; idx < static_cast<size_t>(callback::_COUNT); idx++) {
+			append(entry.callbacks[idx], static_cast<callback>(idx), std::string());
+		}
+		for (auto& kv : entry.passes) {
+			append(kv.second, callback::VIDEO_RENDER, kv.first);
+		}
+	}
+
+	static timing create_timing(bool gpu)
+	{
+		timing timing;
+		timing.cpu = streamfx::util::profiler::create();
+
+		// GPU timing only makes sense for work that is submitted from within the graphics context.
+		if (gpu && gs_get_context() && streamfx::gfx::gpu_timer::is_available()) {
+			try {
+				timing.gpu = std::make_shared<streamfx::gfx::gpu_timer>();
+			} catch (std::exception const& ex) {
+				D_LOG_WARNING("Failed to set up GPU timing: %s", ex.what());
+			}
+		}
+
+		return timing;
+	}
+
+	static void log(std::vector<record> const& records)
+	{
+		if (records.empty()) {
+			return;
+		}
+
+		D_LOG_INFO("%-24s %-32s %-14s %10s %10s %10s %10s %10s %10s %10s", "Type", "Name", "Callback", "Calls",
+				   "Average", "95.0%", "99.0%", "99.9%", "GPU Avg.", "GPU 99.0%");
+		for (auto& rec : records) {
+			double_t gpu_average = -1.;
+			double_t gpu_99      = -1.;
+			if (rec.gpu.count() > 0) {
+				gpu_average = rec.gpu.average_duration() / 1000000.0;
+				gpu_99      = rec.gpu.percentile(0.99).count() / 1000000.0;
+			}
+
+			D_LOG_INFO("%-24s %-32s %-14s %10" PRIu64 " %8.3fms %8.3fms %8.3fms %8.3fms %8.3fms %8.3fms",
+					   rec.type.c_str(), rec.name.c_str(), rec.pass.empty() ? cstring(rec.function) : rec.pass.c_str(),
+					   rec.timings.count(), rec.timings.average_duration() / 1000000.0,
+					   rec.timings.percentile(0.95).count() / 1000000.0,
+					   rec.timings.percentile(0.99).count() / 1000000.0,
+					   rec.timings.percentile(0.999).count() / 1000000.0, gpu_average, gpu_99);
+		}
+	}
+} // namespace streamfx::obs::instrumentation
+
+using namespace streamfx::obs::instrumentation;
+
+const char* streamfx::obs::instrumentation::cstring(callback v)
+{
+	switch (v) {
+	case callback::VIDEO_TICK:
+		return "video_tick";
+	case callback::VIDEO_RENDER:
+		return "video_render";
+	case callback::FILTER_VIDEO:
+		return "filter_video";
+	case callback::FILTER_AUDIO:
+		return "filter_audio";
+	case callback::AUDIO_RENDER:
+		return "audio_render";
+	case callback::AUDIO_MIX:
+		return "audio_mix";
+	case callback::ENCODE:
+		return "encode";
+	default:
+		return "unknown";
+	}
+}
+
+const char* streamfx::obs::instrumentation::cstring(category v)
+{
+	switch (v) {
+	case category::SOURCE:
+		return "Source";
+	case category::FILTER:
+		return "Filter";
+	case category::TRANSITION:
+		return "Transition";
+	case category::ENCODER:
+		return "Encoder";
+	default:
+		return "Unknown";
+	}
+}
+
+void streamfx::obs::instrumentation::enable(bool enabled, bool report)
+{
+	if (_enabled.exchange(enabled) == enabled) {
+		return;
+	}
+
+	if (enabled) {
+		D_LOG_INFO("Instrumentation enabled, every source and encoder callback is now being timed.", "");
+	} else {
+		// Probes that are still in flight keep their profiler alive, so it is safe to drop everything here.
+		if (report) {
+			streamfx::obs::instrumentation::report();
+		}
+
+		// GPU timers need the graphics context to be released, which must never be entered while holding the lock.
+		std::vector<timing> released;
+		{
+			std::unique_lock<std::shared_mutex> lock(_lock);
+			for (auto& kv : _entries) {
+				for (auto& timing : kv.second->callbacks) {
+					released.push_back(std::move(timing));
+					timing = {};
+				}
+				for (auto& pass : kv.second->passes) {
+					released.push_back(std::move(pass.second));
+				}
+				kv.second->passes.clear();
+			}
+		}
+		released.clear();
+
+		D_LOG_INFO("Instrumentation disabled.", "");
+	}
+}
+
+void streamfx::obs::instrumentation::initialize()
+{
+	if (const char* value = std::getenv(ST_ENVIRONMENT); value) {
+		std::string_view v{value};
+		enable(!(v.empty() || (v == "0") || (v == "false") || (v == "off")));
+	}
+}
+
+void streamfx::obs::instrumentation::finalize()
+{
+	enable(false);
+
+	std::unordered_map<void*, std::shared_ptr<entry>> entries;
+	{
+		std::unique_lock<std::shared_mutex> lock(_lock);
+		entries.swap(_entries);
+	}
+}
+
+void streamfx::obs::instrumentation::add(void* instance, obs_source_t* source)
+{
+	auto entry     = std::make_shared<instrumentation::entry>();
+	entry->source  = source;
+	entry->encoder = nullptr;
+	if (const char* id = obs_source_get_id(source); id) {
+		entry->type = id;
+	}
+	switch (obs_source_get_type(source)) {
+	case OBS_SOURCE_TYPE_FILTER:
+		entry->kind = category::FILTER;
+		break;
+	case OBS_SOURCE_TYPE_TRANSITION:
+		entry->kind = category::TRANSITION;
+		break;
+	default:
+		entry->kind = category::SOURCE;
+		break;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	_entries.insert_or_assign(instance, entry);
+}
+
+void streamfx::obs::instrumentation::add(void* instance, obs_encoder_t* encoder)
+{
+	auto entry     = std::make_shared<instrumentation::entry>();
+	entry->source  = nullptr;
+	entry->encoder = encoder;
+	entry->kind    = category::ENCODER;
+	if (const char* id = obs_encoder_get_id(encoder); id) {
+		entry->type = id;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	_entries.insert_or_assign(instance, entry);
+}
+
+void streamfx::obs::instrumentation::remove(void* instance)
+{
+	std::shared_ptr<entry> entry;
+	{
+		std::unique_lock<std::shared_mutex> lock(_lock);
+		if (auto kv = _entries.find(instance); kv != _entries.end()) {
+			entry = kv->second;
+			_entries.erase(kv);
+		}
+	}
+
+	// Instances are usually gone long before anyone asks for a report, so their timings are logged right here.
+	if (entry && enabled()) {
+		std::vector<record> records;
+		collect(*entry, records, false);
+		log(records);
+	}
+}
+
+std::vector<record> streamfx::obs::instrumentation::capture(bool reset)
+{
+	std::vector<record>                 records;
+	std::shared_lock<std::shared_mutex> lock(_lock);
+
+	records.reserve(_entries.size());
+	for (auto& kv : _entries) {
+		collect(*kv.second, records, reset);
+	}
+
+	return records;
+}
+
+void streamfx::obs::instrumentation::report()
+{
+	log(capture());
+}
+
+std::vector<summary> streamfx::obs::instrumentation::summarize()
+{
+	std::vector<summary>                result;
+	std::shared_lock<std::shared_mutex> lock(_lock);
+
+	result.reserve(_entries.size());
+	for (auto& kv : _entries) {
+		auto&   entry = kv.second;
+		summary sum;
+
+		const char* name = nullptr;
+		if (entry->source) {
+			name = obs_source_get_name(entry->source);
+		} else if (entry->encoder) {
+			name = obs_encoder_get_name(entry->encoder);
+		}
+
+		sum.instance = kv.first;
+		sum.type     = entry->type;
+		sum.name     = name ? name : "";
+		sum.kind     = entry->kind;
+		sum.cpu      = std::chrono::nanoseconds(0);
+		sum.gpu      = std::chrono::nanoseconds(0);
+		sum.has_gpu  = false;
+		sum.memory   = 0;
+		sum.skipped  = entry->skipped.load(std::memory_order_relaxed);
+
+		// Passes are nested within the callbacks, so they would be counted twice.
+		for (auto& timing : entry->callbacks) {
+			if (timing.cpu) {
+				sum.cpu += timing.cpu->total_duration();
+			}
+			if (timing.gpu) {
+				sum.gpu += timing.gpu->profiler()->total_duration();
+				sum.has_gpu = true;
+			}
+		}
+		for (auto& kv2 : entry->memory) {
+			sum.memory += kv2.second;
+		}
+
+		result.push_back(std::move(sum));
+	}
+
+	return result;
+}
+
+void* streamfx::obs::instrumentation::current()
+{
+	return _current;
+}
+
+void streamfx::obs::instrumentation::track_memory(void* instance, void const* object, uint64_t bytes)
+{
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	if (auto kv = _entries.find(instance); kv != _entries.end()) {
+		kv->second->memory[object] = bytes;
+	}
+}
+
+void streamfx::obs::instrumentation::release_memory(void* instance, void const* object)
+{
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	if (auto kv = _entries.find(instance); kv != _entries.end()) {
+		kv->second->memory.erase(object);
+	}
+}
+
+void streamfx::obs::instrumentation::count_skipped()
+{
+	if (!_current) {
+		return;
+	}
+
+	std::shared_lock<std::shared_mutex> lock(_lock);
+	if (auto kv = _entries.find(_current); kv != _entries.end()) {
+		kv->second->skipped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void streamfx::obs::instrumentation::probe::begin(void* instance, callback function)
+{
+	size_t idx = static_cast<size_t>(function);
+
+	{
+		std::shared_lock<std::shared_mutex> lock(_lock);
+		if (auto kv = _entries.find(instance); kv != _entries.end()) {
+			_profiler = kv->second->callbacks[idx].cpu;
+			_gpu      = kv->second->callbacks[idx].gpu;
+			if (!_profiler) {
+				lock.unlock();
+
+				// Upgrade to an exclusive lock, the entry may have vanished in the meantime.
+				std::unique_lock<std::shared_mutex> ulock(_lock);
+				if (kv = _entries.find(instance); kv != _entries.end()) {
+					auto& timing = kv->second->callbacks[idx];
+					if (!timing.cpu) {
+						timing = create_timing(function == callback::VIDEO_RENDER);
+					}
+					_profiler = timing.cpu;
+					_gpu      = timing.gpu;
+				}
+			}
+		}
+	}
+
+	if (_gpu) {
+		_gpu->begin();
+	}
+	if (_profiler) {
+		_previous = _current;
+		_current  = instance;
+		_start    = std::chrono::high_resolution_clock::now();
+	}
+}
+
+void streamfx::obs::instrumentation::probe::begin(void* instance, const char* pass)
+{
+	{
+		std::shared_lock<std::shared_mutex> lock(_lock);
+		if (auto kv = _entries.find(instance); kv != _entries.end()) {
+			if (auto kv2 = kv->second->passes.find(pass); kv2 != kv->second->passes.end()) {
+				_profiler = kv2->second.cpu;
+				_gpu      = kv2->second.gpu;
+			} else {
+				lock.unlock();
+
+				std::unique_lock<std::shared_mutex> ulock(_lock);
+				if (kv = _entries.find(instance); kv != _entries.end()) {
+					auto& timing = kv->second->passes[pass];
+					if (!timing.cpu) {
+						timing = create_timing(true);
+					}
+					_profiler = timing.cpu;
+					_gpu      = timing.gpu;
+				}
+			}
+		}
+	}
+
+	if (_gpu) {
+		_gpu->begin();
+	}
+	if (_profiler) {
+		_previous = _current;
+		_current  = instance;
+		_start    = std::chrono::high_resolution_clock::now();
+	}
+}
+
+void streamfx::obs::instrumentation::probe::end()
+{
+	_current = _previous;
+
+	_profiler->track(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now()
+																			- _start));
+	if (_gpu) {
+		_gpu->end();
+	}
+}
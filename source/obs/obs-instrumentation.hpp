@@ -0,0 +1,174 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include "common.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace streamfx::gfx {
+	class gpu_timer;
+}
+
+/** Timing of every source and encoder callback, per instance.
+ *
+ * The factory trampolines place a probe around each call into an instance. While instrumentation is disabled, which is
+ * the default, a probe is a single relaxed load and branch. Once enabled, the duration of every call is sorted into a
+ * profiler that belongs to the instance and callback, so production machines can be profiled without special builds.
+ *
+ * Rendering callbacks and named passes within them are additionally timed on the GPU, if the renderer supports it.
+ */
+namespace streamfx::obs::instrumentation {
+	enum class callback : uint8_t {
+		VIDEO_TICK,
+		VIDEO_RENDER,
+		FILTER_VIDEO,
+		FILTER_AUDIO,
+		AUDIO_RENDER,
+		AUDIO_MIX,
+		ENCODE,
+		_COUNT,
+	};
+
+	const char* cstring(callback v);
+
+	enum class category : uint8_t {
+		SOURCE,
+		FILTER,
+		TRANSITION,
+		ENCODER,
+	};
+
+	const char* cstring(category v);
+
+	struct record {
+		std::string                        type;
+		std::string                        name;
+		callback                           function;
+		std::string                        pass;
+		streamfx::util::profiler::snapshot timings;
+		streamfx::util::profiler::snapshot gpu;
+	};
+
+	/** Running totals of a single instance, meant to be compared against an earlier summary. */
+	struct summary {
+		void*                    instance;
+		std::string              type;
+		std::string              name;
+		category                 kind;
+		std::chrono::nanoseconds cpu;
+		std::chrono::nanoseconds gpu;
+		bool                     has_gpu;
+		uint64_t                 memory;
+		uint64_t                 skipped;
+	};
+
+	extern std::atomic<bool> _enabled;
+
+	inline bool enabled()
+	{
+		return _enabled.load(std::memory_order_relaxed);
+	}
+
+	/** Turn instrumentation on or off.
+	 *
+	 * Turning it off logs a report of everything gathered so far, unless 'report' is false, and releases the collected
+	 * data.
+	 */
+	void enable(bool enabled, bool report = true);
+
+	/** Apply the STREAMFX_INSTRUMENTATION environment variable. */
+	void initialize();
+
+	void finalize();
+
+	/** Register an instance, called by the factories right after creation. */
+	void add(void* instance, obs_source_t* source);
+
+	void add(void* instance, obs_encoder_t* encoder);
+
+	/** Unregister an instance, called by the factories right before destruction. */
+	void remove(void* instance);
+
+	/** Collect the timings of all instances that were called at least once. */
+	std::vector<record> capture(bool reset = false);
+
+	/** Write the current timings to the log. */
+	void report();
+
+	/** Summarize every registered instance, including those that were never called. */
+	std::vector<summary> summarize();
+
+	/** The instance whose callback is currently running on this thread, if any. */
+	void* current();
+
+	/** Account memory held by 'object' to an instance, replacing any earlier amount. */
+	void track_memory(void* instance, void const* object, uint64_t bytes);
+
+	void release_memory(void* instance, void const* object);
+
+	void count_skipped();
+
+	/** Count a skipped frame against the instance that is currently being rendered. */
+	inline void skipped()
+	{
+		if (enabled()) {
+			count_skipped();
+		}
+	}
+
+	class probe {
+		std::shared_ptr<streamfx::util::profiler>      _profiler;
+		std::shared_ptr<streamfx::gfx::gpu_timer>      _gpu;
+		std::chrono::high_resolution_clock::time_point _start;
+		void*                                          _previous;
+
+		public:
+		FORCE_INLINE probe(void* instance, callback function)
+		{
+			if (enabled()) {
+				begin(instance, function);
+			}
+		}
+
+		/** Time a named pass within a rendering callback of an instance. */
+		FORCE_INLINE probe(void* instance, const char* pass)
+		{
+			if (enabled()) {
+				begin(instance, pass);
+			}
+		}
+
+		FORCE_INLINE ~probe()
+		{
+			if (_profiler) {
+				end();
+			}
+		}
+
+		private:
+		void begin(void* instance, callback function);
+
+		void begin(void* instance, const char* pass);
+
+		void end();
+	};
+} // namespace streamfx::obs::instrumentation
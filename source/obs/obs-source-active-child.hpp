@@ -33,6 +33,7 @@ namespace streamfx::obs {
 			auto parent = _parent.lock();
 			auto child  = _child.lock();
 			if (parent && child) {
+				::streamfx::obs::tools::source_unlink(parent, child);
 				obs_source_remove_active_child(parent, child);
 			}
 		}
@@ -44,6 +45,7 @@ namespace streamfx::obs {
 			} else if (!obs_source_add_active_child(parent, child)) {
 				throw std::runtime_error("Child contains Parent");
 			}
+			::streamfx::obs::tools::source_link(parent, child);
 		}
 	};
 } // namespace streamfx::obs
@@ -19,7 +19,10 @@
 
 #pragma once
 #include "common.hpp"
+#include "obs-capture.hpp"
+#include "obs-instrumentation.hpp"
 #include "obs-source.hpp"
+#include "util/util-memory.hpp"
 
 namespace streamfx::obs {
 	template<class _factory, typename _instance>
@@ -160,7 +163,11 @@ namespace streamfx::obs {
 		static void* _create(obs_data_t* settings, obs_source_t* source) noexcept
 		{
 			try {
-				return reinterpret_cast<_factory*>(obs_source_get_type_data(source))->create(settings, source);
+				auto* fac      = reinterpret_cast<_factory*>(obs_source_get_type_data(source));
+				void* instance = fac->create(settings, source);
+				if (instance)
+					instrumentation::add(instance, source);
+				return instance;
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 				return nullptr;
@@ -185,9 +192,14 @@ namespace streamfx::obs {
 		static obs_properties_t* _get_properties2(void* data, void* type_data) noexcept
 		{
 			try {
-				if (type_data)
-					return reinterpret_cast<_factory*>(type_data)->get_properties2(reinterpret_cast<_instance*>(data));
-				return nullptr;
+				if (!type_data)
+					return nullptr;
+
+				auto*             fac   = reinterpret_cast<_factory*>(type_data);
+				obs_properties_t* props = fac->get_properties2(reinterpret_cast<_instance*>(data));
+				if (props && data && (fac->_info.video_render == _video_render_filter) && capture::available())
+					capture::add_properties(props, data, reinterpret_cast<_instance*>(data)->get().get());
+				return props;
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 				return nullptr;
@@ -201,8 +213,11 @@ namespace streamfx::obs {
 		static void _destroy(void* data) noexcept
 		{
 			try {
-				if (data)
+				if (data) {
+					capture::remove(data);
+					instrumentation::remove(data);
 					delete reinterpret_cast<_instance*>(data);
+				}
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
 			} catch (...) {
@@ -225,6 +240,8 @@ namespace streamfx::obs {
 		public /* Instance > Video */:
 		static void _video_tick(void* data, float seconds) noexcept
 		{
+			instrumentation::probe               probe{data, instrumentation::callback::VIDEO_TICK};
+			streamfx::util::memory::arena::scope frame_scope;
 			try {
 				if (data)
 					reinterpret_cast<_instance*>(data)->video_tick(seconds);
@@ -237,6 +254,8 @@ namespace streamfx::obs {
 
 		static void _video_render(void* data, gs_effect_t* effect) noexcept
 		{
+			instrumentation::probe               probe{data, instrumentation::callback::VIDEO_RENDER};
+			streamfx::util::memory::arena::scope frame_scope;
 			try {
 				if (data)
 					reinterpret_cast<_instance*>(data)->video_render(effect);
@@ -249,20 +268,25 @@ namespace streamfx::obs {
 
 		static void _video_render_filter(void* data, gs_effect_t* effect) noexcept
 		{
+			instrumentation::probe               probe{data, instrumentation::callback::VIDEO_RENDER};
+			capture::scope                       capture_scope{data};
+			streamfx::util::memory::arena::scope frame_scope;
 			try {
 				if (data)
 					reinterpret_cast<_instance*>(data)->video_render(effect);
 			} catch (const std::exception& ex) {
 				DLOG_ERROR("Unexpected exception in function '%s': %s.", __FUNCTION_NAME__, ex.what());
-				obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
+				reinterpret_cast<_instance*>(data)->get().skip_video_filter();
 			} catch (...) {
 				DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
-				obs_source_skip_video_filter(reinterpret_cast<_instance*>(data)->get());
+				reinterpret_cast<_instance*>(data)->get().skip_video_filter();
 			}
 		}
 
 		static struct obs_source_frame* _filter_video(void* data, struct obs_source_frame* frame) noexcept
 		{
+			instrumentation::probe               probe{data, instrumentation::callback::FILTER_VIDEO};
+			streamfx::util::memory::arena::scope frame_scope;
 			try {
 				if (data)
 					return reinterpret_cast<_instance*>(data)->filter_video(frame);
@@ -279,6 +303,8 @@ namespace streamfx::obs {
 		public /* Instance > Audio */:
 		static struct obs_audio_data* _filter_audio(void* data, struct obs_audio_data* frame) noexcept
 		{
+			instrumentation::probe               probe{data, instrumentation::callback::FILTER_AUDIO};
+			streamfx::util::memory::arena::scope frame_scope;
 			try {
 				if (data)
 					return reinterpret_cast<_instance*>(data)->filter_audio(frame);
@@ -295,6 +321,8 @@ namespace streamfx::obs {
 		static bool _audio_render(void* data, uint64_t* ts_out, struct obs_source_audio_mix* audio_output,
 								  uint32_t mixers, std::size_t channels, std::size_t sample_rate) noexcept
 		{
+			instrumentation::probe               probe{data, instrumentation::callback::AUDIO_RENDER};
+			streamfx::util::memory::arena::scope frame_scope;
 			try {
 				if (data)
 					return reinterpret_cast<_instance*>(data)->audio_render(ts_out, audio_output, mixers, channels,
@@ -312,6 +340,8 @@ namespace streamfx::obs {
 		static bool _audio_mix(void* data, uint64_t* ts_out, struct audio_output_data* audio_output,
 							   std::size_t channels, std::size_t sample_rate) noexcept
 		{
+			instrumentation::probe               probe{data, instrumentation::callback::AUDIO_MIX};
+			streamfx::util::memory::arena::scope frame_scope;
 			try {
 				if (data)
 					return reinterpret_cast<_instance*>(data)->audio_mix(ts_out, audio_output, channels, sample_rate);
@@ -0,0 +1,440 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include "obs-source-graph.hpp"
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+#include "util/util-logging.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<obs::source_graph> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+static obs_scene_t* scene_or_group(obs_source_t* source)
+{
+	if (obs_scene_t* scene = obs_scene_from_source(source); scene) {
+		return scene;
+	}
+	return obs_group_from_source(source);
+}
+
+void streamfx::obs::source_graph::source_create_handler(void* ptr, calldata_t* data) noexcept
+{
+	auto* self = reinterpret_cast<streamfx::obs::source_graph*>(ptr);
+	try {
+		obs_source_t* source = nullptr;
+		if (calldata_get_ptr(data, "source", &source); !source) {
+			throw std::runtime_error("Missing 'source' parameter.");
+		}
+
+		self->insert_source(source);
+		self->connect(source);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Event 'source_create' caused exception: %s", ex.what());
+	} catch (...) {
+		DLOG_ERROR("Event 'source_create' caused unknown exception.", nullptr);
+	}
+}
+
+void streamfx::obs::source_graph::source_destroy_handler(void* ptr, calldata_t* data) noexcept
+{
+	auto* self = reinterpret_cast<streamfx::obs::source_graph*>(ptr);
+	try {
+		obs_source_t* source = nullptr;
+		if (calldata_get_ptr(data, "source", &source); !source) {
+			throw std::runtime_error("Missing 'source' parameter.");
+		}
+
+		// The signal handler of the source is destroyed along with it, so there is nothing to disconnect.
+		self->remove_source(source);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Event 'source_destroy' caused exception: %s", ex.what());
+	} catch (...) {
+		DLOG_ERROR("Event 'source_destroy' caused unknown exception.", nullptr);
+	}
+}
+
+void streamfx::obs::source_graph::item_add_handler(void* ptr, calldata_t* data) noexcept
+{
+	auto* self = reinterpret_cast<streamfx::obs::source_graph*>(ptr);
+	try {
+		obs_scene_t*     scene = nullptr;
+		obs_sceneitem_t* item  = nullptr;
+		if (calldata_get_ptr(data, "scene", &scene); !scene) {
+			throw std::runtime_error("Missing 'scene' parameter.");
+		}
+		if (calldata_get_ptr(data, "item", &item); !item) {
+			throw std::runtime_error("Missing 'item' parameter.");
+		}
+
+		self->link(obs_scene_get_source(scene), obs_sceneitem_get_source(item));
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Event 'item_add' caused exception: %s", ex.what());
+	} catch (...) {
+		DLOG_ERROR("Event 'item_add' caused unknown exception.", nullptr);
+	}
+}
+
+void streamfx::obs::source_graph::item_remove_handler(void* ptr, calldata_t* data) noexcept
+{
+	auto* self = reinterpret_cast<streamfx::obs::source_graph*>(ptr);
+	try {
+		obs_scene_t*     scene = nullptr;
+		obs_sceneitem_t* item  = nullptr;
+		if (calldata_get_ptr(data, "scene", &scene); !scene) {
+			throw std::runtime_error("Missing 'scene' parameter.");
+		}
+		if (calldata_get_ptr(data, "item", &item); !item) {
+			throw std::runtime_error("Missing 'item' parameter.");
+		}
+
+		self->unlink(obs_scene_get_source(scene), obs_sceneitem_get_source(item));
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Event 'item_remove' caused exception: %s", ex.what());
+	} catch (...) {
+		DLOG_ERROR("Event 'item_remove' caused unknown exception.", nullptr);
+	}
+}
+
+void streamfx::obs::source_graph::filter_add_handler(void* ptr, calldata_t* data) noexcept
+{
+	auto* self = reinterpret_cast<streamfx::obs::source_graph*>(ptr);
+	try {
+		obs_source_t* source = nullptr;
+		obs_source_t* filter = nullptr;
+		if (calldata_get_ptr(data, "source", &source); !source) {
+			throw std::runtime_error("Missing 'source' parameter.");
+		}
+		if (calldata_get_ptr(data, "filter", &filter); !filter) {
+			throw std::runtime_error("Missing 'filter' parameter.");
+		}
+
+		self->link(source, filter);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Event 'filter_add' caused exception: %s", ex.what());
+	} catch (...) {
+		DLOG_ERROR("Event 'filter_add' caused unknown exception.", nullptr);
+	}
+}
+
+void streamfx::obs::source_graph::filter_remove_handler(void* ptr, calldata_t* data) noexcept
+{
+	auto* self = reinterpret_cast<streamfx::obs::source_graph*>(ptr);
+	try {
+		obs_source_t* source = nullptr;
+		obs_source_t* filter = nullptr;
+		if (calldata_get_ptr(data, "source", &source); !source) {
+			throw std::runtime_error("Missing 'source' parameter.");
+		}
+		if (calldata_get_ptr(data, "filter", &filter); !filter) {
+			throw std::runtime_error("Missing 'filter' parameter.");
+		}
+
+		self->unlink(source, filter);
+	} catch (const std::exception& ex) {
+		DLOG_ERROR("Event 'filter_remove' caused exception: %s", ex.what());
+	} catch (...) {
+		DLOG_ERROR("Event 'filter_remove' caused unknown exception.", nullptr);
+	}
+}
+
+streamfx::obs::source_graph::node& streamfx::obs::source_graph::ensure(obs_source_t* source)
+{
+	if (auto kv = _nodes.find(source); kv != _nodes.end()) {
+		if (!obs_weak_source_expired(kv->second.weak)) {
+			return kv->second;
+		}
+
+		// A new source at the address of one that went away without telling us, such as a private source.
+		drop(kv);
+	}
+
+	auto& entry  = _nodes[source];
+	entry.weak   = obs_source_get_weak_source(source);
+	entry.scene  = (scene_or_group(source) != nullptr);
+	return entry;
+}
+
+void streamfx::obs::source_graph::drop(std::unordered_map<obs_source_t*, node>::iterator iter)
+{
+	for (auto& parent : iter->second.parents) {
+		if (auto kv = _nodes.find(parent.first); kv != _nodes.end()) {
+			kv->second.children.erase(iter->first);
+		}
+	}
+	for (auto& child : iter->second.children) {
+		if (auto kv = _nodes.find(child.first); kv != _nodes.end()) {
+			kv->second.parents.erase(iter->first);
+		}
+	}
+	obs_weak_source_release(iter->second.weak);
+	_nodes.erase(iter);
+}
+
+void streamfx::obs::source_graph::insert_source(obs_source_t* source)
+{
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	ensure(source);
+}
+
+void streamfx::obs::source_graph::remove_source(obs_source_t* source)
+{
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	if (auto kv = _nodes.find(source); kv != _nodes.end()) {
+		drop(kv);
+	}
+}
+
+void streamfx::obs::source_graph::link(obs_source_t* parent, obs_source_t* child)
+{
+	if (!parent || !child || (parent == child)) {
+		return;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	auto&                               p = ensure(parent);
+	auto&                               c = ensure(child);
+	p.children[child]++;
+	c.parents[parent]++;
+}
+
+void streamfx::obs::source_graph::unlink(obs_source_t* parent, obs_source_t* child)
+{
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	auto                                p = _nodes.find(parent);
+	auto                                c = _nodes.find(child);
+	if ((p == _nodes.end()) || (c == _nodes.end())) {
+		return;
+	}
+
+	// The same source may be in a scene more than once.
+	if (auto kv = p->second.children.find(child); (kv != p->second.children.end()) && (--kv->second <= 0)) {
+		p->second.children.erase(kv);
+	}
+	if (auto kv = c->second.parents.find(parent); (kv != c->second.parents.end()) && (--kv->second <= 0)) {
+		c->second.parents.erase(kv);
+	}
+}
+
+void streamfx::obs::source_graph::connect(obs_source_t* source)
+{
+	signal_handler_t* sh = obs_source_get_signal_handler(source);
+	if (!sh) {
+		return;
+	}
+
+	signal_handler_connect(sh, "filter_add", &filter_add_handler, this);
+	signal_handler_connect(sh, "filter_remove", &filter_remove_handler, this);
+	if (scene_or_group(source)) {
+		signal_handler_connect(sh, "item_add", &item_add_handler, this);
+		signal_handler_connect(sh, "item_remove", &item_remove_handler, this);
+	}
+}
+
+void streamfx::obs::source_graph::disconnect(obs_source_t* source)
+{
+	signal_handler_t* sh = obs_source_get_signal_handler(source);
+	if (!sh) {
+		return;
+	}
+
+	signal_handler_disconnect(sh, "filter_add", &filter_add_handler, this);
+	signal_handler_disconnect(sh, "filter_remove", &filter_remove_handler, this);
+	signal_handler_disconnect(sh, "item_add", &item_add_handler, this);
+	signal_handler_disconnect(sh, "item_remove", &item_remove_handler, this);
+}
+
+streamfx::obs::source_graph::source_graph() : _nodes(), _lock()
+{
+	auto osi = obs_get_signal_handler();
+	signal_handler_connect(osi, "source_create", &source_create_handler, this);
+	signal_handler_connect(osi, "source_destroy", &source_destroy_handler, this);
+
+	// Learn about all sources first, then about how they are connected.
+	obs_enum_all_sources(
+		[](void* param, obs_source_t* source) {
+			auto* self = reinterpret_cast<::streamfx::obs::source_graph*>(param);
+			self->insert_source(source);
+			self->connect(source);
+			return true;
+		},
+		this);
+	obs_enum_all_sources(
+		[](void* param, obs_source_t* source) {
+			auto* self = reinterpret_cast<::streamfx::obs::source_graph*>(param);
+			if (obs_scene_t* scene = scene_or_group(source); scene) {
+				obs_scene_enum_items(
+					scene,
+					[](obs_scene_t* scene, obs_sceneitem_t* item, void* param) {
+						auto* self = reinterpret_cast<::streamfx::obs::source_graph*>(param);
+						self->link(obs_scene_get_source(scene), obs_sceneitem_get_source(item));
+						return true;
+					},
+					self);
+			}
+			obs_source_enum_filters(
+				source,
+				[](obs_source_t* parent, obs_source_t* child, void* param) {
+					reinterpret_cast<::streamfx::obs::source_graph*>(param)->link(parent, child);
+				},
+				self);
+			return true;
+		},
+		this);
+}
+
+streamfx::obs::source_graph::~source_graph()
+{
+	auto osi = obs_get_signal_handler();
+	if (osi) {
+		signal_handler_disconnect(osi, "source_create", &source_create_handler, this);
+		signal_handler_disconnect(osi, "source_destroy", &source_destroy_handler, this);
+	}
+
+	// Disconnecting waits for handlers that are running right now, which may be waiting for the lock themselves.
+	std::unordered_map<obs_source_t*, node> nodes;
+	{
+		std::unique_lock<std::shared_mutex> lock(_lock);
+		nodes.swap(_nodes);
+	}
+	for (auto& kv : nodes) {
+		if (obs_source_t* source = obs_weak_source_get_source(kv.second.weak); source) {
+			disconnect(source);
+			obs_source_release(source);
+		}
+		obs_weak_source_release(kv.second.weak);
+	}
+}
+
+bool streamfx::obs::source_graph::contains(obs_source_t* haystack, obs_source_t* needle)
+{
+	if (!haystack || !needle) {
+		return false;
+	}
+	if (haystack == needle) {
+		return true;
+	}
+
+	std::vector<obs_source_t*> opaque;
+	{
+		std::shared_lock<std::shared_mutex> lock(_lock);
+
+		std::unordered_set<obs_source_t*> visited{needle};
+		std::vector<obs_source_t*>        pending{needle};
+		while (!pending.empty()) {
+			auto kv = _nodes.find(pending.back());
+			pending.pop_back();
+			if (kv == _nodes.end()) {
+				continue;
+			}
+
+			for (auto& parent : kv->second.parents) {
+				if (parent.first == haystack) {
+					return true;
+				}
+				if (visited.insert(parent.first).second) {
+					pending.push_back(parent.first);
+				}
+			}
+		}
+
+		// Anything but a scene may hold children that libobs never told us about, such as the active source of a
+		// transition. Collect every such source below the haystack, while they are guaranteed to still be alive.
+		visited = {haystack};
+		pending = {haystack};
+		while (!pending.empty()) {
+			obs_source_t* source = pending.back();
+			pending.pop_back();
+
+			auto kv = _nodes.find(source);
+			if (kv == _nodes.end()) {
+				if (source == haystack) {
+					opaque.push_back(obs_source_get_ref(haystack));
+				}
+				continue;
+			}
+			if (!kv->second.scene) {
+				// Its full tree already covers everything below it.
+				if (obs_source_t* ref = obs_weak_source_get_source(kv->second.weak); ref) {
+					opaque.push_back(ref);
+				}
+				continue;
+			}
+
+			for (auto& child : kv->second.children) {
+				if (visited.insert(child.first).second) {
+					pending.push_back(child.first);
+				}
+			}
+		}
+	}
+
+	// Only libobs knows their full tree, which must not be enumerated while holding the lock.
+	struct search {
+		obs_source_t* needle;
+		bool          found;
+	} state{needle, false};
+	for (auto source : opaque) {
+		if (!state.found) {
+			obs_source_enum_full_tree(
+				source,
+				[](obs_source_t*, obs_source_t* child, void* param) {
+					auto* state = reinterpret_cast<search*>(param);
+					if (child == state->needle) {
+						state->found = true;
+					}
+				},
+				&state);
+		}
+		obs_source_release(source);
+	}
+
+	return state.found;
+}
+
+std::shared_ptr<streamfx::obs::source_graph> streamfx::obs::source_graph::get(bool create)
+{
+	static std::mutex                                 inst_mtx;
+	static std::weak_ptr<streamfx::obs::source_graph> inst_weak;
+
+	std::unique_lock<std::mutex> lock(inst_mtx);
+	if (inst_weak.expired()) {
+		if (!create) {
+			return nullptr;
+		}
+		auto instance = std::shared_ptr<streamfx::obs::source_graph>(new streamfx::obs::source_graph());
+		inst_weak     = instance;
+		return instance;
+	} else {
+		return inst_weak.lock();
+	}
+}
@@ -0,0 +1,87 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#pragma once
+#include "common.hpp"
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace streamfx::obs {
+	/** Which source contains which other source, kept up to date from libobs signals.
+	 *
+	 * Scene items and filters are recorded as they are added and removed, and the active children StreamFX adds itself
+	 * are recorded by whoever adds them. This is enough to walk upwards from any source without asking libobs. Other
+	 * children, such as those of transitions or of sources from other plugins, are never announced by libobs.
+	 */
+	class source_graph {
+		struct node {
+			obs_weak_source_t*                         weak;
+			bool                                       scene;
+			std::unordered_map<obs_source_t*, int32_t> children;
+			std::unordered_map<obs_source_t*, int32_t> parents;
+		};
+
+		// Sources are only used as keys, and are removed before libobs frees them.
+		std::unordered_map<obs_source_t*, node> _nodes;
+		std::shared_mutex                       _lock;
+
+		static void source_create_handler(void* ptr, calldata_t* data) noexcept;
+		static void source_destroy_handler(void* ptr, calldata_t* data) noexcept;
+		static void item_add_handler(void* ptr, calldata_t* data) noexcept;
+		static void item_remove_handler(void* ptr, calldata_t* data) noexcept;
+		static void filter_add_handler(void* ptr, calldata_t* data) noexcept;
+		static void filter_remove_handler(void* ptr, calldata_t* data) noexcept;
+
+		void insert_source(obs_source_t* source);
+		void remove_source(obs_source_t* source);
+
+		// Must be called with _lock held exclusively.
+		node& ensure(obs_source_t* source);
+		void  drop(std::unordered_map<obs_source_t*, node>::iterator iter);
+
+		void connect(obs_source_t* source);
+		void disconnect(obs_source_t* source);
+
+		protected:
+		source_graph();
+
+		public:
+		~source_graph();
+
+		/** Record that 'parent' now contains 'child', such as after adding it as an active child. */
+		void link(obs_source_t* parent, obs_source_t* child);
+
+		/** Undo one earlier call to link(). */
+		void unlink(obs_source_t* parent, obs_source_t* child);
+
+		/** Check if 'needle' is 'haystack' or anywhere below it.
+		 *
+		 * Walks upwards from 'needle' and stops at 'haystack', so only the ancestors of 'needle' are visited. Children
+		 * that were never recorded can only be below sources that aren't scenes, so if that finds nothing, the full
+		 * tree of every such source below 'haystack' is searched as well.
+		 */
+		bool contains(obs_source_t* haystack, obs_source_t* needle);
+
+		public: // Singleton
+		/** Get the graph, creating it unless 'create' is false. */
+		static std::shared_ptr<streamfx::obs::source_graph> get(bool create = true);
+	};
+} // namespace streamfx::obs
@@ -63,6 +63,7 @@ void streamfx::obs::source_tracker::source_destroy_handler(void* ptr, calldata_t
 			throw std::runtime_error("Missing 'source' parameter.");
 		}
 
+		self->remove_source(source);
 	} catch (const std::exception& ex) {
 		DLOG_ERROR("Event 'source_destroy' caused exception: %s", ex.what());
 	} catch (...) {
@@ -95,6 +96,60 @@ void streamfx::obs::source_tracker::source_rename_handler(void* ptr, calldata_t*
 	}
 }
 
+static uint32_t classify(obs_source_t* source)
+{
+	typedef streamfx::obs::source_tracker::kind kind;
+	auto bit = [](kind v) { return uint32_t(1) << static_cast<uint32_t>(v); };
+
+	switch (obs_source_get_type(source)) {
+	case OBS_SOURCE_TYPE_INPUT: {
+		uint32_t flags = obs_source_get_output_flags(source);
+		uint32_t mask  = bit(kind::INPUT);
+		if (flags & OBS_SOURCE_AUDIO) {
+			mask |= bit(kind::AUDIO);
+		}
+		if (flags & OBS_SOURCE_VIDEO) {
+			mask |= bit(kind::VIDEO);
+		}
+		return mask;
+	}
+	case OBS_SOURCE_TYPE_TRANSITION:
+		return bit(kind::TRANSITION);
+	case OBS_SOURCE_TYPE_SCENE:
+		return bit(kind::SCENE);
+	default:
+		return 0;
+	}
+}
+
+void streamfx::obs::source_tracker::insert_locked(std::string const& name, std::shared_ptr<obs_weak_source_t> weak,
+												  obs_source_t* source)
+{
+	// A source by the same name that was never removed can only be stale, so replace it.
+	if (auto found = _sources.find(name); found != _sources.end()) {
+		erase_locked(found);
+	}
+
+	_sources.emplace(name, weak);
+	uint32_t mask = classify(source);
+	for (std::size_t idx = 0; idx < _kinds; idx++) {
+		if (mask & (uint32_t(1) << idx)) {
+			_buckets[idx].insert(name);
+		}
+	}
+	_generation.fetch_add(1, std::memory_order_release);
+}
+
+void streamfx::obs::source_tracker::erase_locked(
+	std::map<std::string, std::shared_ptr<obs_weak_source_t>>::iterator iter)
+{
+	for (auto& bucket : _buckets) {
+		bucket.erase(iter->first);
+	}
+	_sources.erase(iter);
+	_generation.fetch_add(1, std::memory_order_release);
+}
+
 void streamfx::obs::source_tracker::insert_source(obs_source_t* source)
 {
 	const auto* name = obs_source_get_name(source);
@@ -108,10 +163,7 @@ void streamfx::obs::source_tracker::insert_source(obs_source_t* source)
 	}
 
 	std::unique_lock<std::mutex> lock(_mutex);
-	_sources.insert({
-		std::string(name),
-		weak,
-	});
+	insert_locked(name, weak, source);
 }
 
 void streamfx::obs::source_tracker::remove_source(obs_source_t* source)
@@ -121,28 +173,24 @@ void streamfx::obs::source_tracker::remove_source(obs_source_t* source)
 	// Lock read & write access to the map.
 	std::unique_lock<std::mutex> ul(_mutex);
 
-	// Try and remove the source by name.
+	// Try and remove the source by name, as long as it actually is the same source.
 	if (name != nullptr) {
 		auto found = _sources.find(std::string(name));
-		if (found != _sources.end()) {
-			_sources.erase(found);
+		if ((found != _sources.end()) && obs_weak_source_references_source(found->second.get(), source)) {
+			erase_locked(found);
 			return;
 		}
 	}
 
 	// If that didn't work, try and remove it by handle.
 	for (auto iter = _sources.begin(); iter != _sources.end(); iter++) {
-		if (obs_weak_source_get_source(iter->second.get()) == source) {
-			_sources.erase(iter);
+		if (obs_weak_source_references_source(iter->second.get(), source)) {
+			erase_locked(iter);
 			return;
 		}
 	}
 
-	// If that all failed, and the source is named, throw and report an error.
-	if (name) {
-		D_LOG_WARNING("Source '%s' was not tracked.", name);
-		throw std::runtime_error("Failed to find given source.");
-	}
+	// Private sources are never tracked, but are destroyed like any other source.
 }
 
 void streamfx::obs::source_tracker::rename_source(std::string_view old_name, std::string_view new_name,
@@ -152,19 +200,24 @@ void streamfx::obs::source_tracker::rename_source(std::string_view old_name, std
 		throw std::runtime_error("New and old name are identical.");
 	}
 
+	std::shared_ptr<obs_weak_source_t> weak;
+
 	std::unique_lock<std::mutex> ul(_mutex);
-	auto                         found = _sources.find(std::string(old_name));
-	if (found == _sources.end()) {
-		insert_source(source);
-		return;
+	if (auto found = _sources.find(std::string(old_name)); found != _sources.end()) {
+		weak = found->second;
+		erase_locked(found);
+	} else {
+		weak = {obs_source_get_weak_source(source), streamfx::obs::obs_weak_source_deleter};
+		if (!weak) {
+			return;
+		}
 	}
 
-	// Insert at new key, remove old pair.
-	_sources.insert({new_name.data(), found->second});
-	_sources.erase(found);
+	insert_locked(std::string(new_name), weak, source);
 }
 
-streamfx::obs::source_tracker::source_tracker() : _sources(), _mutex()
+streamfx::obs::source_tracker::source_tracker()
+	: _sources(), _mutex(), _generation(0), _buckets(), _cache(), _cache_generation()
 {
 	auto osi = obs_get_signal_handler();
 	signal_handler_connect(osi, "source_create", &source_create_handler, this);
@@ -191,6 +244,9 @@ streamfx::obs::source_tracker::~source_tracker()
 	}
 
 	this->_sources.clear();
+	for (auto& bucket : _buckets) {
+		bucket.clear();
+	}
 }
 
 void streamfx::obs::source_tracker::enumerate(enumerate_cb_t ecb, filter_cb_t fcb)
@@ -223,29 +279,82 @@ void streamfx::obs::source_tracker::enumerate(enumerate_cb_t ecb, filter_cb_t fc
 	}
 }
 
-bool streamfx::obs::source_tracker::filter_sources(std::string, obs_source_t* source)
+void streamfx::obs::source_tracker::enumerate(kind type, enumerate_cb_t ecb)
+{
+	auto list = names(type);
+
+	// Only hold the lock long enough to look up the sources, callbacks may take a while.
+	std::vector<std::shared_ptr<obs_weak_source_t>> weak;
+	weak.reserve(list->size());
+	{
+		std::unique_lock<std::mutex> ul(_mutex);
+		for (auto const& name : *list) {
+			auto found = _sources.find(name);
+			weak.push_back((found != _sources.end()) ? found->second : nullptr);
+		}
+	}
+
+	for (std::size_t idx = 0; idx < list->size(); idx++) {
+		if (!weak[idx]) {
+			continue;
+		}
+
+		auto source = std::shared_ptr<obs_source_t>(obs_weak_source_get_source(weak[idx].get()),
+													streamfx::obs::obs_source_deleter);
+		if (!source) {
+			continue;
+		}
+
+		if (ecb && ecb((*list)[idx], source.get())) {
+			break;
+		}
+	}
+}
+
+std::shared_ptr<const streamfx::obs::source_tracker::names_t> streamfx::obs::source_tracker::names(kind type)
+{
+	auto idx = static_cast<std::size_t>(type);
+	if (idx >= _kinds) {
+		throw std::invalid_argument("type");
+	}
+
+	std::unique_lock<std::mutex> ul(_mutex);
+	uint64_t                     generation = _generation.load(std::memory_order_acquire);
+	if (!_cache[idx] || (_cache_generation[idx] != generation)) {
+		_cache[idx]            = std::make_shared<const names_t>(_buckets[idx].begin(), _buckets[idx].end());
+		_cache_generation[idx] = generation;
+	}
+	return _cache[idx];
+}
+
+uint64_t streamfx::obs::source_tracker::generation()
+{
+	return _generation.load(std::memory_order_acquire);
+}
+
+bool streamfx::obs::source_tracker::filter_sources(std::string const&, obs_source_t* source)
 {
 	return (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT);
 }
 
-bool streamfx::obs::source_tracker::filter_audio_sources(std::string, obs_source_t* source)
+bool streamfx::obs::source_tracker::filter_audio_sources(std::string const&, obs_source_t* source)
 {
 	uint32_t flags = obs_source_get_output_flags(source);
 	return !(flags & OBS_SOURCE_AUDIO) || (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT);
 }
 
-bool streamfx::obs::source_tracker::filter_video_sources(std::string, obs_source_t* source)
+bool streamfx::obs::source_tracker::filter_video_sources(std::string const&, obs_source_t* source)
 {
 	uint32_t flags = obs_source_get_output_flags(source);
 	return !(flags & OBS_SOURCE_VIDEO) || (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT);
 }
 
-bool streamfx::obs::source_tracker::filter_transitions(std::string, obs_source_t* source)
+bool streamfx::obs::source_tracker::filter_transitions(std::string const&, obs_source_t* source)
 {
 	return (obs_source_get_type(source) != OBS_SOURCE_TYPE_TRANSITION);
 }
 
-bool streamfx::obs::source_tracker::filter_scenes(std::string, obs_source_t* source)
+bool streamfx::obs::source_tracker::filter_scenes(std::string const&, obs_source_t* source)
 {
 	return (obs_source_get_type(source) != OBS_SOURCE_TYPE_SCENE);
 }
@@ -19,14 +19,45 @@
 
 #pragma once
 #include "common.hpp"
+#include <array>
+#include <atomic>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <set>
+#include <vector>
 
 namespace streamfx::obs {
+	/** Keeps track of all named sources by name.
+	 *
+	 * Sources are additionally sorted into buckets by kind as they are created, renamed and destroyed, so that lists of
+	 * a single kind never need to look at every source. Each change increments a generation counter, which callers may
+	 * use to keep their own lists until something actually changed.
+	 */
 	class source_tracker {
+		public:
+		enum class kind : uint8_t {
+			INPUT,      // Any input.
+			AUDIO,      // Inputs with audio.
+			VIDEO,      // Inputs with video.
+			TRANSITION, // Transitions.
+			SCENE,      // Scenes.
+			_COUNT,
+		};
+
+		typedef std::vector<std::string> names_t;
+
+		private:
 		std::map<std::string, std::shared_ptr<obs_weak_source_t>> _sources;
 		std::mutex                                                _mutex;
+		std::atomic<uint64_t>                                     _generation;
+
+		static constexpr std::size_t _kinds = static_cast<std::size_t>(kind::_COUNT);
+
+		std::array<std::set<std::string>, _kinds>          _buckets;
+		std::array<std::shared_ptr<const names_t>, _kinds> _cache;
+		std::array<uint64_t, _kinds>                       _cache_generation;
 
 		static void source_create_handler(void* ptr, calldata_t* data) noexcept;
 		static void source_destroy_handler(void* ptr, calldata_t* data) noexcept;
@@ -37,20 +68,25 @@ namespace streamfx::obs {
 		void remove_source(obs_source_t* source);
 		void rename_source(std::string_view old_name, std::string_view new_name, obs_source_t* source);
 
+		private:
+		// Must be called with _mutex held.
+		void insert_locked(std::string const& name, std::shared_ptr<obs_weak_source_t> weak, obs_source_t* source);
+		void erase_locked(std::map<std::string, std::shared_ptr<obs_weak_source_t>>::iterator iter);
+
 		public:
 		// Callback function for enumerating sources.
 		//
 		// @param std::string Name of the Source
 		// @param obs_source_t* Source
 		// @return true to abort enumeration, false to keep going.
-		typedef std::function<bool(std::string, obs_source_t*)> enumerate_cb_t;
+		typedef std::function<bool(std::string const&, obs_source_t*)> enumerate_cb_t;
 
 		// Filter function for enumerating sources.
 		//
 		// @param std::string Name of the Source
 		// @param obs_source_t* Source
 		// @return true to skip, false to pass along.
-		typedef std::function<bool(std::string, obs_source_t*)> filter_cb_t;
+		typedef std::function<bool(std::string const&, obs_source_t*)> filter_cb_t;
 
 		protected:
 		source_tracker();
@@ -64,12 +100,26 @@ namespace streamfx::obs {
 		// @param filter_cb Filter function to narrow down results.
 		void enumerate(enumerate_cb_t enumerate_cb, filter_cb_t filter_cb = nullptr);
 
+		//! Enumerate all tracked sources of a kind, in order of their names.
+		//
+		// @param type Kind of sources to enumerate.
+		// @param enumerate_cb The function called for each tracked source.
+		void enumerate(kind type, enumerate_cb_t enumerate_cb);
+
+		//! Names of all tracked sources of a kind, in order.
+		//
+		// The list is shared and only rebuilt after something changed, so this is cheap to call repeatedly.
+		std::shared_ptr<const names_t> names(kind type);
+
+		//! Incremented whenever a source is added, removed or renamed.
+		uint64_t generation();
+
 		public:
-		static bool filter_sources(std::string name, obs_source_t* source);
-		static bool filter_audio_sources(std::string name, obs_source_t* source);
-		static bool filter_video_sources(std::string name, obs_source_t* source);
-		static bool filter_transitions(std::string name, obs_source_t* source);
-		static bool filter_scenes(std::string name, obs_source_t* source);
+		static bool filter_sources(std::string const& name, obs_source_t* source);
+		static bool filter_audio_sources(std::string const& name, obs_source_t* source);
+		static bool filter_video_sources(std::string const& name, obs_source_t* source);
+		static bool filter_transitions(std::string const& name, obs_source_t* source);
+		static bool filter_scenes(std::string const& name, obs_source_t* source);
 
 		public: // Singleton
 		static std::shared_ptr<streamfx::obs::source_tracker> get();
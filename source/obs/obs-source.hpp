@@ -19,6 +19,7 @@
 
 #pragma once
 #include "common.hpp"
+#include "obs-instrumentation.hpp"
 
 namespace streamfx::obs {
 	class source {
@@ -531,6 +532,7 @@ namespace streamfx::obs {
 		 */
 		FORCE_INLINE void skip_video_filter()
 		{
+			streamfx::obs::instrumentation::skipped();
 			return obs_source_skip_video_filter(_ref);
 		};
 
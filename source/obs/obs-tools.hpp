@@ -24,6 +24,12 @@
 namespace streamfx::obs {
 	namespace tools {
 		bool source_find_source(::streamfx::obs::source haystack, ::streamfx::obs::source needle);
+
+		/** Tell source_find_source about an active child, which libobs does not announce. */
+		void source_link(::streamfx::obs::source parent, ::streamfx::obs::source child);
+
+		/** Undo an earlier source_link(). */
+		void source_unlink(::streamfx::obs::source parent, ::streamfx::obs::source child);
 	} // namespace tools
 
 	inline void obs_source_deleter(obs_source_t* v)
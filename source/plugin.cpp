@@ -22,9 +22,18 @@
 #include <stdexcept>
 #include "configuration.hpp"
 #include "gfx/gfx-opengl.hpp"
+#include "gfx/gfx-source-cache.hpp"
 #include "obs/gs/gs-helper.hpp"
 #include "obs/gs/gs-vertexbuffer.hpp"
+#include "obs/obs-instrumentation.hpp"
+#include "obs/obs-source-graph.hpp"
 #include "obs/obs-source-tracker.hpp"
+#include "util/util-cpu.hpp"
+#include "util/util-logging.hpp"
+
+#ifdef ENABLE_METRICS
+#include "metrics.hpp"
+#endif
 
 #ifdef ENABLE_NVIDIA_CUDA
 #include "nvidia/cuda/nvidia-cuda-obs.hpp"
@@ -94,21 +103,40 @@
 static std::shared_ptr<streamfx::util::threadpool>       _threadpool;
 static std::shared_ptr<streamfx::obs::gs::vertex_buffer> _gs_fstri_vb;
 static std::shared_ptr<streamfx::gfx::opengl>            _streamfx_gfx_opengl;
+static std::shared_ptr<streamfx::gfx::source_cache>      _source_cache;
 static std::shared_ptr<streamfx::obs::source_tracker>    _source_tracker;
+static std::shared_ptr<streamfx::obs::source_graph>      _source_graph;
 
 MODULE_EXPORT bool obs_module_load(void)
 try {
 	DLOG_INFO("Loading Version %s", STREAMFX_VERSION_STRING);
 
+	// Initialize Logging, from here on messages are written by a background thread.
+	streamfx::util::logging::initialize();
+
 	// Initialize global configuration.
 	streamfx::configuration::initialize();
 
+	// Report which instructions the CPU kernels are going to use.
+	streamfx::util::cpu::initialize();
+
 	// Initialize global Thread Pool.
 	_threadpool = std::make_shared<streamfx::util::threadpool>();
 
+	// Initialize Instrumentation
+	streamfx::obs::instrumentation::initialize();
+
+#ifdef ENABLE_METRICS
+	// Initialize Metrics
+	streamfx::metrics::initialize();
+#endif
+
 	// Initialize Source Tracker
 	_source_tracker = streamfx::obs::source_tracker::get();
 
+	// Initialize Source Graph
+	_source_graph = streamfx::obs::source_graph::get();
+
 	// Initialize GLAD (OpenGL)
 	{
 		streamfx::obs::gs::context gctx{};
@@ -146,6 +174,9 @@ try {
 		_gs_fstri_vb->update();
 	}
 
+	// Initialize Source Cache
+	_source_cache = streamfx::gfx::source_cache::get();
+
 	// Encoders
 	{
 #ifdef ENABLE_ENCODER_AOM_AV1
@@ -220,9 +251,11 @@ try {
 	return true;
 } catch (std::exception const& ex) {
 	DLOG_ERROR("Unexpected exception in function '%s': %s", __FUNCTION_NAME__, ex.what());
+	streamfx::util::logging::finalize();
 	return false;
 } catch (...) {
 	DLOG_ERROR("Unexpected exception in function '%s'.", __FUNCTION_NAME__);
+	streamfx::util::logging::finalize();
 	return false;
 }
 
@@ -235,6 +268,11 @@ try {
 	streamfx::ui::handler::finalize();
 #endif
 
+	// Metrics
+#ifdef ENABLE_METRICS
+	streamfx::metrics::finalize();
+#endif
+
 	// Transitions
 	{
 #ifdef ENABLE_TRANSITION_SHADER
@@ -299,6 +337,9 @@ try {
 #endif
 	}
 
+	// Finalize Source Cache
+	_source_cache.reset();
+
 	// GS Stuff
 	{
 		_gs_fstri_vb.reset();
@@ -310,9 +351,15 @@ try {
 		_streamfx_gfx_opengl.reset();
 	}
 
+	// Finalize Source Graph
+	_source_graph.reset();
+
 	// Finalize Source Tracker
 	_source_tracker.reset();
 
+	// Finalize Instrumentation
+	streamfx::obs::instrumentation::finalize();
+
 	//	// Auto-Updater
 	//#ifdef ENABLE_UPDATER
 	//	_updater.reset();
@@ -324,6 +371,9 @@ try {
 	// Finalize Configuration
 	streamfx::configuration::finalize();
 
+	// Finalize Logging
+	streamfx::util::logging::finalize();
+
 	DLOG_INFO("Unloaded Version %s", STREAMFX_VERSION_STRING);
 } catch (std::exception const& ex) {
 	DLOG_ERROR("Unexpected exception in function '%s': %s", __FUNCTION_NAME__, ex.what());
@@ -19,6 +19,7 @@
 
 #include "source-mirror.hpp"
 #include "strings.hpp"
+#include <algorithm>
 #include <bitset>
 #include <cstring>
 #include <functional>
@@ -51,6 +52,7 @@
 #pragma warning(disable : 4201)
 #endif
 #include <media-io/audio-io.h>
+#include <util/threading.h>
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
@@ -63,37 +65,140 @@
 #define ST_I18N_SOURCE_AUDIO_LAYOUT ST_I18N_SOURCE_AUDIO ".Layout"
 #define ST_KEY_SOURCE_AUDIO_LAYOUT "Source.Mirror.Audio.Layout"
 #define ST_I18N_SOURCE_AUDIO_LAYOUT_(x) ST_I18N_SOURCE_AUDIO_LAYOUT "." D_VSTR(x)
+#define ST_I18N_CROP ST_I18N ".Crop"
+#define ST_I18N_CROP_LEFT ST_I18N_CROP ".Left"
+#define ST_KEY_CROP_LEFT "Source.Mirror.Crop.Left"
+#define ST_I18N_CROP_TOP ST_I18N_CROP ".Top"
+#define ST_KEY_CROP_TOP "Source.Mirror.Crop.Top"
+#define ST_I18N_CROP_RIGHT ST_I18N_CROP ".Right"
+#define ST_KEY_CROP_RIGHT "Source.Mirror.Crop.Right"
+#define ST_I18N_CROP_BOTTOM ST_I18N_CROP ".Bottom"
+#define ST_KEY_CROP_BOTTOM "Source.Mirror.Crop.Bottom"
+#define ST_I18N_SIZE ST_I18N ".Size"
+#define ST_I18N_SIZE_WIDTH ST_I18N_SIZE ".Width"
+#define ST_KEY_SIZE_WIDTH "Source.Mirror.Size.Width"
+#define ST_I18N_SIZE_HEIGHT ST_I18N_SIZE ".Height"
+#define ST_KEY_SIZE_HEIGHT "Source.Mirror.Size.Height"
+
+// Captures are rendered at up to 2^n times the output size and then halved n times.
+#define ST_MAX_DOWNSAMPLE_STEPS 2
+
+// Each block holds up to AUDIO_OUTPUT_FRAMES, so this is a bit over half a second of audio at 48kHz.
+#define ST_AUDIO_BLOCKS 32
 
 using namespace streamfx::source::mirror;
 
 static constexpr std::string_view HELP_URL = "https://github.com/Xaymar/obs-StreamFX/wiki/Source-Mirror";
 
-mirror_audio_data::mirror_audio_data(const audio_data* audio, speaker_layout layout)
+audio_ring::audio_ring()
+	: _buffer(), _blocks(), _block_frames(0), _frame_size(0), _planes(0), _read(0), _write(0), _dropped(0)
+{}
+
+void audio_ring::reset(audio_format format, speaker_layout speakers, uint32_t samples_per_sec,
+					   std::size_t block_frames, std::size_t blocks)
+{
+	_block_frames = block_frames;
+	_frame_size   = get_audio_size(format, speakers, 1);
+	_planes       = is_audio_planar(format) ? get_audio_channels(speakers) : 1;
+	_buffer.resize(blocks * _planes * _block_frames * _frame_size);
+	_blocks.resize(blocks);
+	for (auto& block : _blocks) {
+		block                 = {};
+		block.format          = format;
+		block.samples_per_sec = samples_per_sec;
+	}
+
+	_read    = 0;
+	_write   = 0;
+	_dropped = 0;
+}
+
+void audio_ring::write(const audio_data* audio, speaker_layout layout)
 {
-	// Build a clone of a packet.
-	audio_t*                 oad = obs_get_audio();
-	const audio_output_info* aoi = audio_output_get_info(oad);
-	osa.frames                   = audio->frames;
-	osa.timestamp                = audio->timestamp;
-	osa.speakers                 = layout;
-	osa.format                   = aoi->format;
-	osa.samples_per_sec          = aoi->samples_per_sec;
-	data.resize(MAX_AV_PLANES);
-	for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
-		if (!audio->data[idx]) {
-			osa.data[idx] = nullptr;
-			continue;
+	// Detect Audio Layout from underlying audio.
+	if (layout == SPEAKERS_UNKNOWN) {
+		std::bitset<MAX_AV_PLANES> layout_detection;
+		for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+			layout_detection.set(idx, audio->data[idx] != nullptr);
+		}
+		switch (layout_detection.to_ulong()) {
+		case 0b00000001:
+			layout = SPEAKERS_MONO;
+			break;
+		case 0b00000011:
+			layout = SPEAKERS_STEREO;
+			break;
+		case 0b00000111:
+			layout = SPEAKERS_2POINT1;
+			break;
+		case 0b00001111:
+			layout = SPEAKERS_4POINT0;
+			break;
+		case 0b00011111:
+			layout = SPEAKERS_4POINT1;
+			break;
+		case 0b00111111:
+			layout = SPEAKERS_5POINT1;
+			break;
+		case 0b11111111:
+			layout = SPEAKERS_7POINT1;
+			break;
+		default:
+			layout = SPEAKERS_UNKNOWN;
+			break;
+		}
+	}
+
+	// Split packets that are larger than a block, so that nothing ever has to be allocated here.
+	const std::size_t blocks = _blocks.size();
+	const std::size_t stride = _block_frames * _frame_size;
+	for (std::size_t offset = 0; offset < audio->frames;) {
+		std::size_t write = _write.load(std::memory_order_relaxed);
+		if ((write - _read.load(std::memory_order_acquire)) >= blocks) {
+			// The reader fell behind, so drop what doesn't fit instead of waiting for it.
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			break;
 		}
 
-		data[idx].resize(audio->frames * get_audio_bytes_per_channel(osa.format));
-		memcpy(data[idx].data(), audio->data[idx], data[idx].size());
-		osa.data[idx] = data[idx].data();
+		obs_source_audio& block  = _blocks[write % blocks];
+		uint8_t*          planes = _buffer.data() + (write % blocks) * _planes * stride;
+		std::size_t       frames = std::min<std::size_t>(audio->frames - offset, _block_frames);
+		for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
+			if ((idx < _planes) && audio->data[idx]) {
+				block.data[idx] = planes + idx * stride;
+				memcpy(const_cast<uint8_t*>(block.data[idx]), audio->data[idx] + offset * _frame_size,
+					   frames * _frame_size);
+			} else {
+				block.data[idx] = nullptr;
+			}
+		}
+		block.frames    = static_cast<uint32_t>(frames);
+		block.timestamp = audio->timestamp + (offset * 1000000000ull) / block.samples_per_sec;
+		block.speakers  = layout;
+
+		// Sequentially consistent, as the caller checks whether the reader sleeps right after. With release, that check
+		// could happen before the reader is able to see this block, and both would miss each other.
+		_write.store(write + 1, std::memory_order_seq_cst);
+		offset += frames;
 	}
 }
 
+bool audio_ring::empty()
+{
+	// Pairs with the store in write(), see there.
+	return _read.load(std::memory_order_acquire) == _write.load(std::memory_order_seq_cst);
+}
+
+uint64_t audio_ring::dropped()
+{
+	return _dropped.exchange(0);
+}
+
 mirror_instance::mirror_instance(obs_data_t* settings, obs_source_t* self)
-	: obs::source_instance(settings, self), _source(), _source_child(), _signal_rename(), _audio_enabled(false),
-	  _audio_layout(SPEAKERS_UNKNOWN)
+	: obs::source_instance(settings, self), _source(), _source_child(), _signal_rename(), _source_size(),
+	  _crop_left(0), _crop_top(0), _crop_right(0), _crop_bottom(0), _size(), _region_offset(), _region_size(),
+	  _output_size(), _rts(), _audio_enabled(false), _audio_layout(SPEAKERS_UNKNOWN), _audio_ring(), _audio_thread(),
+	  _audio_lock(), _audio_cv(), _audio_waiting(false), _audio_shutdown(false)
 {
 	update(settings);
 }
@@ -101,16 +206,17 @@ mirror_instance::mirror_instance(obs_data_t* settings, obs_source_t* self)
 mirror_instance::~mirror_instance()
 {
 	release();
+	audio_stop();
 }
 
 uint32_t mirror_instance::get_width()
 {
-	return _source_size.first ? _source_size.first : 1;
+	return _output_size.first ? _output_size.first : 1;
 }
 
 uint32_t mirror_instance::get_height()
 {
-	return _source_size.second ? _source_size.second : 1;
+	return _output_size.second ? _output_size.second : 1;
 }
 
 void mirror_instance::load(obs_data_t* data)
@@ -135,6 +241,14 @@ void mirror_instance::update(obs_data_t* data)
 	_audio_enabled = obs_data_get_bool(data, ST_KEY_SOURCE_AUDIO);
 	_audio_layout  = static_cast<speaker_layout>(obs_data_get_int(data, ST_KEY_SOURCE_AUDIO_LAYOUT));
 
+	// Region and Size
+	_crop_left   = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_CROP_LEFT), 0));
+	_crop_top    = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_CROP_TOP), 0));
+	_crop_right  = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_CROP_RIGHT), 0));
+	_crop_bottom = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_CROP_BOTTOM), 0));
+	_size.first  = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_SIZE_WIDTH), 0));
+	_size.second = static_cast<uint32_t>(std::max<int64_t>(obs_data_get_int(data, ST_KEY_SIZE_HEIGHT), 0));
+
 	// Acquire new source.
 	acquire(obs_data_get_string(data, ST_KEY_SOURCE));
 }
@@ -148,7 +262,10 @@ void mirror_instance::save(obs_data_t* data)
 	}
 }
 
-void mirror_instance::video_tick(float_t time) {}
+void mirror_instance::video_tick(float_t time)
+{
+	update_geometry();
+}
 
 void mirror_instance::video_render(gs_effect_t* effect)
 {
@@ -162,10 +279,89 @@ void mirror_instance::video_render(gs_effect_t* effect)
 										 obs_source_get_name(_self), obs_source_get_name(_source.get())};
 #endif
 
-	_source_size.first  = obs_source_get_width(_source.get());
-	_source_size.second = obs_source_get_height(_source.get());
+	// Without a crop or a different size, the source can be drawn directly.
+	if ((_region_offset.first == 0) && (_region_offset.second == 0) && (_region_size == _source_size)
+		&& (_output_size == _source_size)) {
+		obs_source_video_render(_source.get());
+		return;
+	}
+	if ((_region_size.first == 0) || (_region_size.second == 0) || (_output_size.first == 0)
+		|| (_output_size.second == 0)) {
+		return;
+	}
+
+	// Large reductions lose thin lines and text if rendered directly at the output size, so render at a multiple of
+	// it and halve that with a linear filter until it fits. Each halving averages exactly four texels.
+	std::size_t steps = 0;
+	while ((steps < ST_MAX_DOWNSAMPLE_STEPS) && ((_output_size.first << (steps + 1)) <= _region_size.first)
+		   && ((_output_size.second << (steps + 1)) <= _region_size.second)) {
+		steps++;
+	}
+	while (_rts.size() <= steps) {
+		_rts.push_back(std::make_shared<streamfx::obs::gs::rendertarget>(GS_RGBA, GS_ZS_NONE));
+	}
+
+	uint32_t width  = _output_size.first << steps;
+	uint32_t height = _output_size.second << steps;
+	{
+#ifdef ENABLE_PROFILING
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_capture, "Capture"};
+#endif
+		auto op = _rts[0]->render(width, height);
+
+		// Only the region is inside the projection, everything else is never rasterized.
+		gs_ortho(static_cast<float>(_region_offset.first),
+				 static_cast<float>(_region_offset.first + _region_size.first),
+				 static_cast<float>(_region_offset.second),
+				 static_cast<float>(_region_offset.second + _region_size.second), 0, 1);
+
+		vec4 black;
+		vec4_zero(&black);
+		gs_clear(GS_CLEAR_COLOR, &black, 0, 0);
+
+		// Keep the alpha channel intact, which leaves the color premultiplied.
+		gs_blend_state_push();
+		gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA, GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+		obs_source_video_render(_source.get());
+		gs_blend_state_pop();
+	}
+
+	gs_effect_t*  default_effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_eparam_t*  image          = gs_effect_get_param_by_name(default_effect, "image");
+	gs_texture_t* texture        = _rts[0]->get_object();
+	for (std::size_t step = 1; step <= steps; step++) {
+#ifdef ENABLE_PROFILING
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_convert, "Downsample %" PRIuMAX, step};
+#endif
+		width >>= 1;
+		height >>= 1;
+
+		auto op = _rts[step]->render(width, height);
+		gs_ortho(0, static_cast<float>(width), 0, static_cast<float>(height), 0, 1);
+
+		gs_blend_state_push();
+		gs_enable_blending(false);
+		gs_effect_set_texture(image, texture);
+		while (gs_effect_loop(default_effect, "Draw")) {
+			gs_draw_sprite(nullptr, 0, width, height);
+		}
+		gs_blend_state_pop();
+
+		texture = _rts[step]->get_object();
+	}
 
-	obs_source_video_render(_source.get());
+	{
+#ifdef ENABLE_PROFILING
+		streamfx::obs::gs::debug_marker gdm{streamfx::obs::gs::debug_color_render, "Render"};
+#endif
+		gs_blend_state_push();
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+		gs_effect_set_texture(image, texture);
+		while (gs_effect_loop(default_effect, "Draw")) {
+			gs_draw_sprite(nullptr, 0, _output_size.first, _output_size.second);
+		}
+		gs_blend_state_pop();
+	}
 }
 
 void mirror_instance::enum_active_sources(obs_source_enum_proc_t cb, void* ptr)
@@ -196,11 +392,11 @@ try {
 	// Everything went well, store.
 	_source_child       = std::make_shared<::streamfx::obs::source_active_child>(_self, source);
 	_source             = source;
-	_source_size.first  = obs_source_get_width(_source);
-	_source_size.second = obs_source_get_height(_source);
+	update_geometry();
 
 	// Listen to any audio the source spews out.
 	if (_audio_enabled) {
+		audio_start();
 		_signal_audio = std::make_shared<obs::audio_signal_handler>(_source);
 		_signal_audio->event.add(std::bind(&mirror_instance::on_audio, this, std::placeholders::_1,
 										   std::placeholders::_2, std::placeholders::_3));
@@ -217,6 +413,38 @@ void mirror_instance::release()
 	_source.release();
 }
 
+void mirror_instance::update_geometry()
+{
+	if (_source) {
+		_source_size.first  = obs_source_get_width(_source.get());
+		_source_size.second = obs_source_get_height(_source.get());
+	} else {
+		_source_size = {0, 0};
+	}
+
+	// Crop as much as asked for, but never more than there is.
+	_region_offset.first  = std::min(_crop_left, _source_size.first);
+	_region_offset.second = std::min(_crop_top, _source_size.second);
+	_region_size.first    = _source_size.first - _region_offset.first;
+	_region_size.second   = _source_size.second - _region_offset.second;
+	_region_size.first -= std::min(_crop_right, _region_size.first);
+	_region_size.second -= std::min(_crop_bottom, _region_size.second);
+
+	// A size of zero follows the region, keeping its aspect ratio if only the other size was given.
+	_output_size = _size;
+	if ((_region_size.first == 0) || (_region_size.second == 0)) {
+		_output_size = {0, 0};
+	} else if ((_size.first == 0) && (_size.second == 0)) {
+		_output_size = _region_size;
+	} else if (_size.first == 0) {
+		_output_size.first = static_cast<uint32_t>(
+			std::max<uint64_t>(uint64_t(_size.second) * _region_size.first / _region_size.second, 1));
+	} else if (_size.second == 0) {
+		_output_size.second = static_cast<uint32_t>(
+			std::max<uint64_t>(uint64_t(_size.first) * _region_size.second / _region_size.first, 1));
+	}
+}
+
 void mirror_instance::on_audio(::streamfx::obs::source, const audio_data* audio, bool)
 {
 	// Immediately quit if there isn't any actual audio to send out.
@@ -224,58 +452,65 @@ void mirror_instance::on_audio(::streamfx::obs::source, const audio_data* audio,
 		return;
 	}
 
-	// Detect Audio Layout from underlying audio.
-	speaker_layout detected_layout;
-	if (_audio_layout != SPEAKERS_UNKNOWN) {
-		detected_layout = _audio_layout;
-	} else {
-		std::bitset<MAX_AV_PLANES> layout_detection;
-		for (std::size_t idx = 0; idx < MAX_AV_PLANES; idx++) {
-			layout_detection.set(idx, audio->data[idx] != nullptr);
-		}
-		switch (layout_detection.to_ulong()) {
-		case 0b00000001:
-			detected_layout = SPEAKERS_MONO;
-			break;
-		case 0b00000011:
-			detected_layout = SPEAKERS_STEREO;
-			break;
-		case 0b00000111:
-			detected_layout = SPEAKERS_2POINT1;
-			break;
-		case 0b00001111:
-			detected_layout = SPEAKERS_4POINT0;
-			break;
-		case 0b00011111:
-			detected_layout = SPEAKERS_4POINT1;
-			break;
-		case 0b00111111:
-			detected_layout = SPEAKERS_5POINT1;
-			break;
-		case 0b11111111:
-			detected_layout = SPEAKERS_7POINT1;
-			break;
-		default:
-			detected_layout = SPEAKERS_UNKNOWN;
-			break;
-		}
+	_audio_ring.write(audio, _audio_layout);
+
+	// Only bother the forwarding thread if it is actually asleep.
+	if (_audio_waiting.load()) {
+		std::lock_guard<std::mutex> lock(_audio_lock);
+		_audio_cv.notify_one();
+	}
+}
+
+void mirror_instance::audio_start()
+{
+	if (_audio_thread.joinable()) {
+		return;
+	}
+
+	// The format of the captured audio is always the format of the audio output.
+	audio_t*                 audio = obs_get_audio();
+	const audio_output_info* aoi   = audio_output_get_info(audio);
+	_audio_ring.reset(aoi->format, aoi->speakers, aoi->samples_per_sec, AUDIO_OUTPUT_FRAMES, ST_AUDIO_BLOCKS);
+
+	_audio_shutdown = false;
+	_audio_thread   = std::thread(&mirror_instance::audio_output, this);
+}
+
+void mirror_instance::audio_stop()
+{
+	if (!_audio_thread.joinable()) {
+		return;
 	}
 
 	{
-		std::unique_lock<std::mutex> ul(_audio_queue_lock);
-		_audio_queue.emplace(audio, detected_layout);
+		std::lock_guard<std::mutex> lock(_audio_lock);
+		_audio_shutdown = true;
 	}
+	_audio_cv.notify_all();
+	_audio_thread.join();
 
-	// Create a clone of the audio data and push it to the thread pool.
-	streamfx::threadpool()->push(std::bind(&mirror_instance::audio_output, this, std::placeholders::_1), nullptr);
+	if (uint64_t dropped = _audio_ring.dropped(); dropped > 0) {
+		D_LOG_WARNING("Dropped %" PRIu64 " blocks of audio for '%s'.", dropped, obs_source_get_name(_self));
+	}
 }
 
-void mirror_instance::audio_output(std::shared_ptr<void> data)
+void mirror_instance::audio_output()
 {
-	std::unique_lock<std::mutex> ul(_audio_queue_lock);
-	while (_audio_queue.size() > 0) {
-		obs_source_output_audio(_self, &((_audio_queue.front()).osa));
-		_audio_queue.pop();
+	os_set_thread_name("StreamFX: Source Mirror Audio");
+
+	while (true) {
+		{
+			// Announce that we're about to sleep before checking for work, so that a new block can't be missed.
+			std::unique_lock<std::mutex> lock(_audio_lock);
+			_audio_waiting = true;
+			_audio_cv.wait(lock, [this]() { return _audio_shutdown || !_audio_ring.empty(); });
+			_audio_waiting = false;
+			if (_audio_shutdown) {
+				break;
+			}
+		}
+
+		_audio_ring.read([this](obs_source_audio const& block) { obs_source_output_audio(_self, &block); });
 	}
 }
 
@@ -303,6 +538,12 @@ void mirror_factory::get_defaults2(obs_data_t* data)
 	obs_data_set_default_string(data, ST_KEY_SOURCE, "");
 	obs_data_set_default_bool(data, ST_KEY_SOURCE_AUDIO, false);
 	obs_data_set_default_int(data, ST_KEY_SOURCE_AUDIO_LAYOUT, static_cast<int64_t>(SPEAKERS_UNKNOWN));
+	obs_data_set_default_int(data, ST_KEY_CROP_LEFT, 0);
+	obs_data_set_default_int(data, ST_KEY_CROP_TOP, 0);
+	obs_data_set_default_int(data, ST_KEY_CROP_RIGHT, 0);
+	obs_data_set_default_int(data, ST_KEY_CROP_BOTTOM, 0);
+	obs_data_set_default_int(data, ST_KEY_SIZE_WIDTH, 0);
+	obs_data_set_default_int(data, ST_KEY_SIZE_HEIGHT, 0);
 }
 
 static bool modified_properties(obs_properties_t* pr, obs_property_t* p, obs_data_t* data) noexcept
@@ -335,22 +576,16 @@ obs_properties_t* mirror_factory::get_properties2(mirror_instance* data)
 		obs_property_set_modified_callback(p, modified_properties);
 
 		obs_property_list_add_string(p, "", "");
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_sources);
-		obs::source_tracker::get()->enumerate(
-			[&p](std::string name, obs_source_t*) {
-				std::stringstream sstr;
-				sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
-				obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
-				return false;
-			},
-			obs::source_tracker::filter_scenes);
+		for (auto const& name : *obs::source_tracker::get()->names(obs::source_tracker::kind::INPUT)) {
+			std::stringstream sstr;
+			sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SOURCE) << ")";
+			obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+		}
+		for (auto const& name : *obs::source_tracker::get()->names(obs::source_tracker::kind::SCENE)) {
+			std::stringstream sstr;
+			sstr << name << " (" << D_TRANSLATE(S_SOURCETYPE_SCENE) << ")";
+			obs_property_list_add_string(p, sstr.str().c_str(), name.c_str());
+		}
 	}
 
 	{
@@ -379,6 +614,38 @@ obs_properties_t* mirror_factory::get_properties2(mirror_instance* data)
 								  static_cast<int64_t>(SPEAKERS_7POINT1));
 	}
 
+	{
+		auto grp = obs_properties_create();
+
+		std::pair<const char*, const char*> opts[] = {
+			{ST_KEY_CROP_LEFT, ST_I18N_CROP_LEFT},
+			{ST_KEY_CROP_TOP, ST_I18N_CROP_TOP},
+			{ST_KEY_CROP_RIGHT, ST_I18N_CROP_RIGHT},
+			{ST_KEY_CROP_BOTTOM, ST_I18N_CROP_BOTTOM},
+		};
+		for (auto opt : opts) {
+			p = obs_properties_add_int(grp, opt.first, D_TRANSLATE(opt.second), 0, 16384, 1);
+			obs_property_int_set_suffix(p, " px");
+		}
+
+		obs_properties_add_group(pr, ST_I18N_CROP, D_TRANSLATE(ST_I18N_CROP), OBS_GROUP_NORMAL, grp);
+	}
+
+	{
+		auto grp = obs_properties_create();
+
+		std::pair<const char*, const char*> opts[] = {
+			{ST_KEY_SIZE_WIDTH, ST_I18N_SIZE_WIDTH},
+			{ST_KEY_SIZE_HEIGHT, ST_I18N_SIZE_HEIGHT},
+		};
+		for (auto opt : opts) {
+			p = obs_properties_add_int(grp, opt.first, D_TRANSLATE(opt.second), 0, 16384, 1);
+			obs_property_int_set_suffix(p, " px");
+		}
+
+		obs_properties_add_group(pr, ST_I18N_SIZE, D_TRANSLATE(ST_I18N_SIZE), OBS_GROUP_NORMAL, grp);
+	}
+
 	return pr;
 }
 
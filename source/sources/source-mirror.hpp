@@ -19,9 +19,9 @@
 
 #pragma once
 #include "common.hpp"
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 #include "gfx/gfx-source-texture.hpp"
@@ -34,11 +34,47 @@
 #include "obs/obs-tools.hpp"
 
 namespace streamfx::source::mirror {
-	struct mirror_audio_data {
-		mirror_audio_data(const audio_data*, speaker_layout);
+	/** Blocks of audio that are allocated once, with exactly one writer and exactly one reader.
+	 *
+	 * Writing never allocates or waits, so it is safe to do from the audio capture callback. Packets larger than a
+	 * block are split, and whatever doesn't fit because the reader fell behind is dropped.
+	 */
+	class audio_ring {
+		std::vector<uint8_t>          _buffer;
+		std::vector<obs_source_audio> _blocks;
+		std::size_t                   _block_frames;
+		std::size_t                   _frame_size;
+		std::size_t                   _planes;
+		std::atomic<std::size_t>      _read;
+		std::atomic<std::size_t>      _write;
+		std::atomic<uint64_t>         _dropped;
 
-		obs_source_audio                  osa;
-		std::vector<std::vector<uint8_t>> data;
+		public:
+		audio_ring();
+
+		/** Allocate the blocks for the given format, must not be called while anyone is reading or writing. */
+		void reset(audio_format format, speaker_layout speakers, uint32_t samples_per_sec, std::size_t block_frames,
+				   std::size_t blocks);
+
+		/** Copy audio into the ring, detecting the layout from the planes present if 'layout' is unknown. */
+		void write(const audio_data* audio, speaker_layout layout);
+
+		/** Hand every block written so far to 'fn', and free them up again afterwards. */
+		template<typename _fn>
+		void read(_fn&& fn)
+		{
+			std::size_t read  = _read.load(std::memory_order_relaxed);
+			std::size_t write = _write.load(std::memory_order_acquire);
+			for (; read != write; read++) {
+				fn(_blocks[read % _blocks.size()]);
+				_read.store(read + 1, std::memory_order_release);
+			}
+		}
+
+		bool empty();
+
+		/** Number of blocks dropped since the last call. */
+		uint64_t dropped();
 	};
 
 	class mirror_instance : public obs::source_instance {
@@ -49,11 +85,28 @@ namespace streamfx::source::mirror {
 		std::shared_ptr<obs::audio_signal_handler>            _signal_audio;
 		std::pair<uint32_t, uint32_t>                         _source_size;
 
+		// Region and Size
+		uint32_t                                                      _crop_left;
+		uint32_t                                                      _crop_top;
+		uint32_t                                                      _crop_right;
+		uint32_t                                                      _crop_bottom;
+		std::pair<uint32_t, uint32_t>                                 _size;
+		std::pair<uint32_t, uint32_t>                                 _region_offset;
+		std::pair<uint32_t, uint32_t>                                 _region_size;
+		std::pair<uint32_t, uint32_t>                                 _output_size;
+		std::vector<std::shared_ptr<streamfx::obs::gs::rendertarget>> _rts;
+
 		// Audio
-		bool                          _audio_enabled;
-		speaker_layout                _audio_layout;
-		std::mutex                    _audio_queue_lock;
-		std::queue<mirror_audio_data> _audio_queue;
+		bool           _audio_enabled;
+		speaker_layout _audio_layout;
+
+		// Audio is written into the ring by the audio capture callback, and forwarded by a thread of our own.
+		audio_ring              _audio_ring;
+		std::thread             _audio_thread;
+		std::mutex              _audio_lock;
+		std::condition_variable _audio_cv;
+		std::atomic<bool>       _audio_waiting;
+		std::atomic<bool>       _audio_shutdown;
 
 		public:
 		mirror_instance(obs_data_t* settings, obs_source_t* self);
@@ -77,9 +130,13 @@ namespace streamfx::source::mirror {
 		void acquire(std::string source_name);
 		void release();
 
+		void update_geometry();
+
 		void on_audio(::streamfx::obs::source, const struct audio_data*, bool);
 
-		void audio_output(std::shared_ptr<void> data);
+		void audio_start();
+		void audio_stop();
+		void audio_output();
 	};
 
 	class mirror_factory : public obs::source_factory<source::mirror::mirror_factory, source::mirror::mirror_instance> {
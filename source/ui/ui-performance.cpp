@@ -0,0 +1,200 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "ui-performance.hpp"
+#include "strings.hpp"
+#include <algorithm>
+#include <cmath>
+#include "plugin.hpp"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251 4365 4371 4619 4946)
+#endif
+#include <QAction>
+#include <QHeaderView>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+// Translation Keys
+constexpr std::string_view _i18n_title          = "UI.Performance";
+constexpr std::string_view _i18n_column_name    = "UI.Performance.Name";
+constexpr std::string_view _i18n_column_type    = "UI.Performance.Type";
+constexpr std::string_view _i18n_column_kind    = "UI.Performance.Kind";
+constexpr std::string_view _i18n_column_cpu     = "UI.Performance.CPU";
+constexpr std::string_view _i18n_column_gpu     = "UI.Performance.GPU";
+constexpr std::string_view _i18n_column_memory  = "UI.Performance.Memory";
+constexpr std::string_view _i18n_column_skipped = "UI.Performance.Skipped";
+
+#define ST_REFRESH_INTERVAL 1000
+
+enum class column : int {
+	NAME,
+	TYPE,
+	KIND,
+	CPU,
+	GPU,
+	MEMORY,
+	SKIPPED,
+	_COUNT,
+};
+
+static QTableWidgetItem* make_item(QVariant value)
+{
+	auto item = new QTableWidgetItem();
+	item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+	item->setData(Qt::DisplayRole, value);
+	return item;
+}
+
+static QVariant make_number(double_t value)
+{
+	// Numbers instead of text, so that sorting by a column works as expected.
+	return QVariant(std::round(value * 100.) / 100.);
+}
+
+streamfx::ui::performance::performance(QWidget* parent)
+	: QDockWidget(parent), _table(), _timer(), _owns_instrumentation(false), _previous(), _previous_time()
+{
+	setObjectName("StreamFXPerformance");
+	setWindowTitle(QString::fromUtf8(D_TRANSLATE(_i18n_title.data())));
+	setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+
+	_table = new QTableWidget(0, static_cast<int>(column::_COUNT), this);
+	_table->setHorizontalHeaderLabels({
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_name.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_type.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_kind.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_cpu.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_gpu.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_memory.data())),
+		QString::fromUtf8(D_TRANSLATE(_i18n_column_skipped.data())),
+	});
+	_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+	_table->horizontalHeader()->setStretchLastSection(true);
+	_table->verticalHeader()->setVisible(false);
+	_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+	_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	_table->setSortingEnabled(true);
+	_table->sortByColumn(static_cast<int>(column::CPU), Qt::DescendingOrder);
+	setWidget(_table);
+
+	_timer = new QTimer(this);
+	_timer->setInterval(ST_REFRESH_INTERVAL);
+	connect(_timer, &QTimer::timeout, this, &streamfx::ui::performance::on_refresh);
+
+	// Unlike hide events, this only changes when the dock is actually opened or closed.
+	connect(toggleViewAction(), &QAction::toggled, this, &streamfx::ui::performance::on_toggled);
+}
+
+streamfx::ui::performance::~performance()
+{
+	on_toggled(false);
+}
+
+void streamfx::ui::performance::showEvent(QShowEvent* event)
+{
+	QDockWidget::showEvent(event);
+
+	// Nothing is being measured unless instrumentation is on, so turn it on for as long as we're open.
+	if (!streamfx::obs::instrumentation::enabled()) {
+		streamfx::obs::instrumentation::enable(true);
+		_owns_instrumentation = true;
+	}
+
+	_previous.clear();
+	_previous_time = std::chrono::steady_clock::now();
+	on_refresh();
+	_timer->start();
+}
+
+void streamfx::ui::performance::hideEvent(QHideEvent* event)
+{
+	QDockWidget::hideEvent(event);
+
+	_timer->stop();
+}
+
+void streamfx::ui::performance::on_toggled(bool open)
+{
+	// The table already showed everything, so there is no need to repeat it in the log.
+	if (!open && _owns_instrumentation) {
+		streamfx::obs::instrumentation::enable(false, false);
+		_owns_instrumentation = false;
+	}
+}
+
+void streamfx::ui::performance::on_refresh()
+{
+	auto     now     = std::chrono::steady_clock::now();
+	double_t seconds = std::chrono::duration<double_t>(now - _previous_time).count();
+	_previous_time   = now;
+
+	// Show the cost per frame, which is easier to compare against the frame budget than the cost per second.
+	double_t       fps = 60.;
+	obs_video_info ovi;
+	if (obs_get_video_info(&ovi) && (ovi.fps_den > 0)) {
+		fps = static_cast<double_t>(ovi.fps_num) / static_cast<double_t>(ovi.fps_den);
+	}
+	double_t frames = std::max(1., seconds * fps);
+
+	auto                                                     summaries = streamfx::obs::instrumentation::summarize();
+	std::map<void*, streamfx::obs::instrumentation::summary> current;
+
+	// Sorting while the table is being filled would move rows around underneath us.
+	_table->setSortingEnabled(false);
+	_table->setRowCount(static_cast<int>(summaries.size()));
+
+	int row = 0;
+	for (auto& sum : summaries) {
+		double_t cpu     = 0.;
+		double_t gpu     = 0.;
+		uint64_t skipped = 0;
+		if (auto kv = _previous.find(sum.instance); kv != _previous.end()) {
+			// Totals start over whenever instrumentation is turned off, so they may have gone backwards.
+			auto& prev = kv->second;
+			if (sum.cpu >= prev.cpu) {
+				cpu = static_cast<double_t>((sum.cpu - prev.cpu).count()) / 1000000. / frames;
+			}
+			if (sum.gpu >= prev.gpu) {
+				gpu = static_cast<double_t>((sum.gpu - prev.gpu).count()) / 1000000. / frames;
+			}
+			if (sum.skipped >= prev.skipped) {
+				skipped = sum.skipped - prev.skipped;
+			}
+		}
+
+		_table->setItem(row, static_cast<int>(column::NAME), make_item(QString::fromStdString(sum.name)));
+		_table->setItem(row, static_cast<int>(column::TYPE), make_item(QString::fromStdString(sum.type)));
+		_table->setItem(row, static_cast<int>(column::KIND),
+						make_item(QString::fromUtf8(streamfx::obs::instrumentation::cstring(sum.kind))));
+		_table->setItem(row, static_cast<int>(column::CPU), make_item(make_number(cpu)));
+		_table->setItem(row, static_cast<int>(column::GPU), make_item(sum.has_gpu ? make_number(gpu) : QVariant()));
+		_table->setItem(row, static_cast<int>(column::MEMORY),
+						make_item(make_number(static_cast<double_t>(sum.memory) / 1048576.)));
+		_table->setItem(row, static_cast<int>(column::SKIPPED), make_item(QVariant::fromValue<qulonglong>(skipped)));
+
+		current.emplace(sum.instance, std::move(sum));
+		row++;
+	}
+
+	_table->setSortingEnabled(true);
+	_previous.swap(current);
+}
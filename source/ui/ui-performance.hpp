@@ -0,0 +1,69 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include "common.hpp"
+#include <chrono>
+#include <map>
+#include "obs/obs-instrumentation.hpp"
+#include "ui-common.hpp"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4251 4365 4371 4619 4946)
+#endif
+#include <QDockWidget>
+#include <QTableWidget>
+#include <QTimer>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+namespace streamfx::ui {
+	/** Lists every StreamFX instance along with what it costs per frame.
+	 *
+	 * Instrumentation is enabled for as long as the dock is open, unless something else already enabled it. Being
+	 * minimized or tabbed away only pauses the refresh.
+	 */
+	class performance : public QDockWidget {
+		Q_OBJECT
+
+		private:
+		QTableWidget* _table;
+		QTimer*       _timer;
+		bool          _owns_instrumentation;
+
+		std::map<void*, streamfx::obs::instrumentation::summary> _previous;
+		std::chrono::steady_clock::time_point                     _previous_time;
+
+		public:
+		performance(QWidget* parent = nullptr);
+		~performance();
+
+		protected:
+		virtual void showEvent(QShowEvent* event) override;
+		virtual void hideEvent(QHideEvent* event) override;
+
+		public slots:
+		; // Not having this breaks some linters.
+		void on_refresh();
+
+		void on_toggled(bool open);
+	};
+} // namespace streamfx::ui
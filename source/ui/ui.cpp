@@ -25,6 +25,11 @@
 #include "obs/obs-tools.hpp"
 #include "plugin.hpp"
 
+#ifdef ENABLE_PROFILING
+#include <ctime>
+#include "util/util-tracer.hpp"
+#endif
+
 #include <obs-frontend-api.h>
 
 // Translation Keys
@@ -38,6 +43,7 @@ constexpr std::string_view _i18n_menu_youtube = "UI.Menu.YouTube";
 constexpr std::string_view _i18n_menu_twitter = "UI.Menu.Twitter";
 constexpr std::string_view _i18n_menu_github  = "UI.Menu.Github";
 constexpr std::string_view _i18n_menu_about   = "UI.Menu.About";
+constexpr std::string_view _i18n_menu_trace   = "UI.Menu.Trace";
 
 // Configuration
 constexpr std::string_view _cfg_have_shown_about = "UI.HaveShownAboutStreamFX";
@@ -78,9 +84,14 @@ streamfx::ui::handler::handler()
 	: QObject(), _menu_action(), _menu(),
 
 	  _action_support(), _action_wiki(), _action_website(), _action_discord(), _action_twitter(), _action_youtube(),
+#ifdef ENABLE_PROFILING
+	  _action_trace(),
+#endif
 
 	  _about_action(), _about_dialog(),
 
+	  _performance(),
+
 	  _translator()
 #ifdef ENABLE_UPDATER
 	  ,
@@ -122,6 +133,10 @@ void streamfx::ui::handler::on_obs_loaded()
 	// Create the 'About StreamFX' dialog.
 	_about_dialog = new streamfx::ui::about();
 
+	// Create the performance dock, which OBS lists in its 'Docks' menu.
+	_performance = new streamfx::ui::performance(reinterpret_cast<QWidget*>(obs_frontend_get_main_window()));
+	obs_frontend_add_dock(_performance);
+
 	{ // Create and build the StreamFX menu
 		_menu = new QMenu(reinterpret_cast<QWidget*>(obs_frontend_get_main_window()));
 
@@ -132,6 +147,8 @@ void streamfx::ui::handler::on_obs_loaded()
 		// Discord
 		// Twitter
 		// YouTube
+		// ---
+		// Record Performance Trace (Profiling only)
 		// <--->
 		// <Updater>
 		// ---
@@ -168,6 +185,16 @@ void streamfx::ui::handler::on_obs_loaded()
 			connect(_action_youtube, &QAction::triggered, this, &streamfx::ui::handler::on_action_youtube);
 		}
 
+#ifdef ENABLE_PROFILING
+		_menu->addSeparator();
+		{
+			_action_trace = _menu->addAction(QString::fromUtf8(D_TRANSLATE(_i18n_menu_trace.data())));
+			_action_trace->setMenuRole(QAction::NoRole);
+			_action_trace->setCheckable(true);
+			connect(_action_trace, &QAction::triggered, this, &streamfx::ui::handler::on_action_trace);
+		}
+#endif
+
 		// Create the updater.
 #ifdef ENABLE_UPDATER
 		_updater = streamfx::ui::updater::instance(_menu);
@@ -250,6 +277,34 @@ void streamfx::ui::handler::on_action_youtube(bool)
 	QDesktopServices::openUrl(QUrl(QString::fromUtf8(_url_youtube.data())));
 }
 
+#ifdef ENABLE_PROFILING
+static void trace_frame(void*, float)
+{
+	streamfx::util::tracer::instant("Frame");
+}
+
+void streamfx::ui::handler::on_action_trace(bool checked)
+{
+	if (checked) {
+		streamfx::util::tracer::start();
+		obs_add_tick_callback(trace_frame, nullptr);
+		return;
+	}
+
+	obs_remove_tick_callback(trace_frame, nullptr);
+	streamfx::util::tracer::stop();
+
+	try {
+		char        name[64];
+		std::time_t time = std::time(nullptr);
+		std::strftime(name, sizeof(name), "traces/%Y-%m-%d %H-%M-%S.json", std::localtime(&time));
+		streamfx::util::tracer::flush(streamfx::config_file_path(name));
+	} catch (std::exception const& ex) {
+		DLOG_ERROR("Failed to write performance trace: %s", ex.what());
+	}
+}
+#endif
+
 void streamfx::ui::handler::on_action_about(bool checked)
 {
 	_about_dialog->show();
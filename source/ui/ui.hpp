@@ -20,6 +20,7 @@
 #pragma once
 #include "ui-about.hpp"
 #include "ui-common.hpp"
+#include "ui-performance.hpp"
 
 #ifdef ENABLE_UPDATER
 #include "ui-updater.hpp"
@@ -40,11 +41,17 @@ namespace streamfx::ui {
 		QAction* _action_discord;
 		QAction* _action_twitter;
 		QAction* _action_youtube;
+#ifdef ENABLE_PROFILING
+		QAction* _action_trace;
+#endif
 
 		// About Dialog
 		QAction*   _about_action;
 		ui::about* _about_dialog;
 
+		// Performance Dock
+		ui::performance* _performance;
+
 		QTranslator* _translator;
 
 #ifdef ENABLE_UPDATER
@@ -73,6 +80,9 @@ namespace streamfx::ui {
 		void on_action_discord(bool);
 		void on_action_twitter(bool);
 		void on_action_youtube(bool);
+#ifdef ENABLE_PROFILING
+		void on_action_trace(bool);
+#endif
 
 		// About
 		void on_action_about(bool);
@@ -0,0 +1,204 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include "util-cpu.hpp"
+#include <cstdlib>
+#include <string_view>
+#include "util/util-logging.hpp"
+
+#ifdef ST_CPU_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::cpu> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+#define ST_ENV_DISABLE "STREAMFX_CPU_DISABLE"
+
+using namespace streamfx::util::cpu;
+
+static constexpr std::pair<feature, std::string_view> feature_names[] = {
+	{feature::SSE2, "SSE2"},         {feature::SSSE3, "SSSE3"},       {feature::SSE4_1, "SSE4.1"},
+	{feature::SSE4_2, "SSE4.2"},     {feature::AVX, "AVX"},           {feature::AVX2, "AVX2"},
+	{feature::FMA, "FMA"},           {feature::AVX512F, "AVX512F"},   {feature::AVX512BW, "AVX512BW"},
+	{feature::AVX512VL, "AVX512VL"}, {feature::NEON, "NEON"},
+};
+
+#ifdef ST_CPU_X86
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#ifdef _MSC_VER
+	int data[4];
+	__cpuidex(data, static_cast<int>(leaf), static_cast<int>(subleaf));
+	for (std::size_t idx = 0; idx < 4; idx++) {
+		regs[idx] = static_cast<uint32_t>(data[idx]);
+	}
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t xgetbv(uint32_t index)
+{
+#ifdef _MSC_VER
+	return _xgetbv(index);
+#else
+	uint32_t eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+	return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+static feature detect()
+{
+	feature result = feature::NONE;
+
+#ifdef ST_CPU_X86
+	uint32_t regs[4] = {0, 0, 0, 0};
+	cpuid(0, 0, regs);
+	uint32_t max_leaf = regs[0];
+	if (max_leaf < 1) {
+		return result;
+	}
+
+	cpuid(1, 0, regs);
+	if (regs[3] & (1u << 26))
+		result = result | feature::SSE2;
+	if (regs[2] & (1u << 9))
+		result = result | feature::SSSE3;
+	if (regs[2] & (1u << 19))
+		result = result | feature::SSE4_1;
+	if (regs[2] & (1u << 20))
+		result = result | feature::SSE4_2;
+
+	// Wider registers are only usable if the operating system saves and restores them on a context switch.
+	uint64_t xcr0 = (regs[2] & (1u << 27)) ? xgetbv(0) : 0;
+	bool     ymm  = (xcr0 & 0x06) == 0x06;
+	bool     zmm  = (xcr0 & 0xE6) == 0xE6;
+	if (ymm && (regs[2] & (1u << 28)))
+		result = result | feature::AVX;
+	if (ymm && (regs[2] & (1u << 12)))
+		result = result | feature::FMA;
+
+	if (max_leaf >= 7) {
+		cpuid(7, 0, regs);
+		if (ymm && (regs[1] & (1u << 5)))
+			result = result | feature::AVX2;
+		if (zmm && (regs[1] & (1u << 16)))
+			result = result | feature::AVX512F;
+		if (zmm && (regs[1] & (1u << 30)))
+			result = result | feature::AVX512BW;
+		if (zmm && (regs[1] & (1u << 31)))
+			result = result | feature::AVX512VL;
+	}
+#endif
+
+#ifdef ST_CPU_NEON
+	// Part of every 64-bit ARM CPU, and otherwise already required by the build itself.
+	result = result | feature::NEON;
+#endif
+
+	// Leave out whatever was asked for, for testing how other machines behave.
+	if (const char* env = getenv(ST_ENV_DISABLE); env) {
+		std::string_view list = env;
+		while (!list.empty()) {
+			std::size_t      end  = list.find(',');
+			std::string_view name = list.substr(0, end);
+			for (auto& kv : feature_names) {
+				if (kv.second == name) {
+					result = static_cast<feature>(static_cast<uint32_t>(result) & ~static_cast<uint32_t>(kv.first));
+				}
+			}
+			list = (end == std::string_view::npos) ? std::string_view() : list.substr(end + 1);
+		}
+	}
+
+	return result;
+}
+
+feature streamfx::util::cpu::features()
+{
+	static feature instance = detect();
+	return instance;
+}
+
+std::string streamfx::util::cpu::to_string(feature value)
+{
+	std::string result;
+	for (auto& kv : feature_names) {
+		if (has(value, kv.first)) {
+			if (!result.empty()) {
+				result.append(", ");
+			}
+			result.append(kv.second);
+		}
+	}
+	return result.empty() ? std::string("None") : result;
+}
+
+void streamfx::util::cpu::initialize()
+{
+	D_LOG_INFO("Detected CPU features: %s", to_string(features()).c_str());
+	for (auto kernel : kernel_info::all()) {
+		D_LOG_INFO("Kernel '%s' uses the '%s' implementation.", kernel->name(), kernel->selected());
+	}
+}
+
+static std::vector<kernel_info*>& kernel_registry()
+{
+	static std::vector<kernel_info*> instance;
+	return instance;
+}
+
+streamfx::util::cpu::kernel_info::kernel_info(const char* name) : _name(name), _selected(nullptr)
+{
+	kernel_registry().push_back(this);
+}
+
+const char* streamfx::util::cpu::kernel_info::name() const
+{
+	return _name;
+}
+
+const char* streamfx::util::cpu::kernel_info::selected() const
+{
+	return _selected;
+}
+
+std::vector<kernel_info*> const& streamfx::util::cpu::kernel_info::all()
+{
+	return kernel_registry();
+}
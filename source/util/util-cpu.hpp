@@ -0,0 +1,143 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#pragma once
+#include "common.hpp"
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// Taken from the compiler instead of the build system, so that builds for multiple architectures at once still work.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ST_CPU_X86
+#endif
+#if defined(_M_ARM64) || defined(__aarch64__) || defined(__ARM_NEON)
+#define ST_CPU_NEON
+#endif
+
+// Allows a single function to use instructions that the rest of the build may not assume. MSVC allows this anywhere.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ST_CPU_TARGET(x)
+#else
+#define ST_CPU_TARGET(x) __attribute__((target(x)))
+#endif
+
+namespace streamfx::util::cpu {
+	enum class feature : uint32_t {
+		NONE     = 0,
+		SSE2     = 1 << 0,
+		SSSE3    = 1 << 1,
+		SSE4_1   = 1 << 2,
+		SSE4_2   = 1 << 3,
+		AVX      = 1 << 4,
+		AVX2     = 1 << 5,
+		FMA      = 1 << 6,
+		AVX512F  = 1 << 7,
+		AVX512BW = 1 << 8,
+		AVX512VL = 1 << 9,
+		NEON     = 1 << 16,
+	};
+
+	/** Features that both the CPU and the operating system support, detected once.
+	 *
+	 * Features listed in the STREAMFX_CPU_DISABLE environment variable, separated by commas, are left out. This
+	 * allows reproducing what happens on older machines without having one at hand.
+	 */
+	feature features();
+
+	std::string to_string(feature value);
+
+	/** Log the detected features, along with the implementation every kernel has chosen. */
+	void initialize();
+
+	/** Name and chosen implementation of a kernel, so that all kernels can be listed. */
+	class kernel_info {
+		protected:
+		const char* _name;
+		const char* _selected;
+
+		kernel_info(const char* name);
+
+		public:
+		const char* name() const;
+
+		const char* selected() const;
+
+		static std::vector<kernel_info*> const& all();
+	};
+
+	/** A function with several implementations, of which the best one for this CPU is picked once.
+	 *
+	 * Implementations are listed from most to least preferred, and the last one must be the plain C++ reference
+	 * that needs no features at all. All others must produce exactly the same output as the reference. Kernels are
+	 * meant to be global, and calling one costs the same as calling through a function pointer.
+	 */
+	template<typename _function>
+	class kernel : public kernel_info {
+		public:
+		struct implementation {
+			const char* name;
+			feature     needs;
+			_function*  function;
+		};
+
+		private:
+		std::vector<implementation> _implementations;
+		_function*                  _active;
+
+		public:
+		kernel(const char* name, std::initializer_list<implementation> implementations)
+			: kernel_info(name), _implementations(implementations), _active(nullptr)
+		{
+			feature available = features();
+			for (auto& impl : _implementations) {
+				if (has(available, impl.needs)) {
+					_active   = impl.function;
+					_selected = impl.name;
+					break;
+				}
+			}
+		}
+
+		template<typename... _args>
+		inline auto operator()(_args&&... args) const
+		{
+			return _active(std::forward<_args>(args)...);
+		}
+
+		/** Every implementation that was compiled in, including those this CPU can't run. */
+		std::vector<implementation> const& implementations() const
+		{
+			return _implementations;
+		}
+
+		implementation const& reference() const
+		{
+			return _implementations.back();
+		}
+
+		static bool is_supported(implementation const& impl)
+		{
+			return has(features(), impl.needs);
+		}
+	};
+} // namespace streamfx::util::cpu
+
+P_ENABLE_BITMASK_OPERATORS(streamfx::util::cpu::feature)
@@ -17,27 +17,185 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+
 #pragma once
 #include "common.hpp"
+#include <atomic>
 #include <functional>
-#include <list>
 #include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace streamfx::util {
+	/** A callable with inline storage for small targets, such as the result of std::bind on a member function.
+	 *
+	 * Unlike std::function, calling it never touches the heap and is a single indirect call. Larger targets still work,
+	 * but are allocated once on construction.
+	 */
+	template<typename... _args>
+	class event_listener {
+		static constexpr std::size_t _capacity = sizeof(void*) * 6;
+
+		enum class operation {
+			COPY,
+			MOVE,
+			DESTROY,
+		};
+
+		typedef void (*invoke_t)(void*, _args&...);
+		typedef void (*manage_t)(operation, void*, void*);
+
+		alignas(std::max_align_t) unsigned char _storage[_capacity];
+		invoke_t _invoke;
+		manage_t _manage;
+
+		template<typename _fn>
+		static constexpr bool is_inline = (sizeof(_fn) <= _capacity) && (alignof(_fn) <= alignof(std::max_align_t))
+										  && std::is_nothrow_move_constructible_v<_fn>;
+
+		template<typename _fn>
+		static _fn* target(void* storage)
+		{
+			if constexpr (is_inline<_fn>) {
+				return std::launder(reinterpret_cast<_fn*>(storage));
+			} else {
+				return *reinterpret_cast<_fn**>(storage);
+			}
+		}
+
+		template<typename _fn>
+		static void invoke(void* storage, _args&... args)
+		{
+			(*target<_fn>(storage))(args...);
+		}
+
+		template<typename _fn>
+		static void manage(operation op, void* self, void* other)
+		{
+			if constexpr (is_inline<_fn>) {
+				switch (op) {
+				case operation::COPY:
+					new (self) _fn(*target<_fn>(other));
+					break;
+				case operation::MOVE:
+					new (self) _fn(std::move(*target<_fn>(other)));
+					target<_fn>(other)->~_fn();
+					break;
+				case operation::DESTROY:
+					target<_fn>(self)->~_fn();
+					break;
+				}
+			} else {
+				switch (op) {
+				case operation::COPY:
+					*reinterpret_cast<_fn**>(self) = new _fn(*target<_fn>(other));
+					break;
+				case operation::MOVE:
+					*reinterpret_cast<_fn**>(self) = target<_fn>(other);
+					break;
+				case operation::DESTROY:
+					delete target<_fn>(self);
+					break;
+				}
+			}
+		}
+
+		public:
+		template<typename _fn, typename = std::enable_if_t<!std::is_same_v<std::decay_t<_fn>, event_listener>>>
+		event_listener(_fn&& fn)
+			: _invoke(&invoke<std::decay_t<_fn>>), _manage(&manage<std::decay_t<_fn>>)
+		{
+			typedef std::decay_t<_fn> fn_t;
+			if constexpr (is_inline<fn_t>) {
+				new (_storage) fn_t(std::forward<_fn>(fn));
+			} else {
+				*reinterpret_cast<fn_t**>(_storage) = new fn_t(std::forward<_fn>(fn));
+			}
+		}
+
+		event_listener(const event_listener& other) : _invoke(other._invoke), _manage(other._manage)
+		{
+			_manage(operation::COPY, _storage, const_cast<unsigned char*>(other._storage));
+		}
+
+		event_listener(event_listener&& other) noexcept : _invoke(other._invoke), _manage(other._manage)
+		{
+			_manage(operation::MOVE, _storage, other._storage);
+			other._manage = nullptr;
+		}
+
+		~event_listener()
+		{
+			if (_manage) {
+				_manage(operation::DESTROY, _storage, nullptr);
+			}
+		}
+
+		event_listener& operator=(const event_listener&) = delete;
+		event_listener& operator=(event_listener&&)      = delete;
+
+		FORCE_INLINE void operator()(_args&... args) const
+		{
+			_invoke(const_cast<unsigned char*>(_storage), args...);
+		}
+	};
+
+	/** Calls made by this thread that are still in progress, see event::synchronize. */
+	struct event_frame {
+		const void*  snapshot;
+		event_frame* previous;
+	};
+	inline thread_local event_frame* _event_frames = nullptr;
+
+	/** A list of listeners that is called without ever waiting on those modifying it.
+	 *
+	 * Listeners are kept in an immutable snapshot that is replaced as a whole whenever one is added or removed, so the
+	 * copy is paid for by the registering thread while calls only load a pointer. Replaced snapshots are released once
+	 * no call can still be using them, which is never done by a call itself, so real-time threads such as the audio
+	 * thread neither block nor free memory here.
+	 *
+	 * Calls from different threads may overlap, so listeners must be safe to call concurrently if the event is called
+	 * from more than one thread. Once remove() or clear() return, the affected listeners are no longer running on any
+	 * other thread. When called from within a listener, they take effect with the next call of the event.
+	 */
 	template<typename... _args>
 	class event {
-		std::list<std::function<void(_args...)>> _listeners;
-		std::recursive_mutex                     _lock;
+		struct entry {
+			std::size_t              id;
+			event_listener<_args...> listener;
+		};
+		struct snapshot_t {
+			std::atomic<std::size_t> readers;
+			std::vector<entry>       listeners;
+
+			snapshot_t() : readers(0), listeners() {}
+			snapshot_t(std::vector<entry> const& other) : readers(0), listeners(other) {}
+		};
+
+		std::atomic<snapshot_t*> _listeners;
+		std::atomic<std::size_t> _calls;
+
+		std::recursive_mutex     _lock;
+		std::vector<snapshot_t*> _retired;
+		std::size_t              _next_id;
 
 		std::function<void()> _cb_fill;
 		std::function<void()> _cb_clear;
 
 		public /* constructor */:
-		event() : _listeners(), _lock(), _cb_fill(), _cb_clear() {}
+		event() : _listeners(nullptr), _calls(0), _lock(), _retired(), _next_id(0), _cb_fill(), _cb_clear() {}
 		virtual ~event()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
 			this->clear();
+
+			std::lock_guard<std::recursive_mutex> lg(_lock);
+			delete _listeners.exchange(nullptr);
+			for (auto snapshot : _retired) {
+				delete snapshot;
+			}
+			_retired.clear();
 		}
 
 		/* Copy Constructor */
@@ -46,12 +204,7 @@ namespace streamfx::util {
 		/* Move Constructor */
 		event(event<_args...>&& other) : event()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			std::lock_guard<std::recursive_mutex> lgo(other._lock);
-
-			_listeners.swap(other._listeners);
-			_cb_fill.swap(other._cb_fill);
-			_cb_clear.swap(other._cb_clear);
+			*this = std::move(other);
 		}
 
 		public /* operators */:
@@ -65,7 +218,10 @@ namespace streamfx::util {
 			std::lock_guard<std::recursive_mutex> lg(_lock);
 			std::lock_guard<std::recursive_mutex> lgo(other._lock);
 
-			_listeners.swap(other._listeners);
+			// Neither side may be called while being moved, so the snapshots can be exchanged directly.
+			_listeners.store(other._listeners.exchange(_listeners.load()));
+			_retired.swap(other._retired);
+			std::swap(_next_id, other._next_id);
 			_cb_fill.swap(other._cb_fill);
 			_cb_clear.swap(other._cb_clear);
 
@@ -74,57 +230,120 @@ namespace streamfx::util {
 
 		/** Call the event, going through all listeners in the order they were registered in.
 		*/
-		template<typename... _largs>
 		inline void operator()(_args... args)
 		{
-			call<_largs...>(args...);
+			call(args...);
 		}
-		template<typename... _largs>
 		inline void call(_args... args)
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			for (auto& l : _listeners) {
-				l(args...);
+			struct guard {
+				event*      self;
+				snapshot_t* snapshot;
+				event_frame frame;
+
+				guard(event* parent) : self(parent), snapshot(nullptr), frame{nullptr, _event_frames}
+				{
+					_event_frames = &frame;
+					self->_calls.fetch_add(1, std::memory_order_seq_cst);
+				}
+				~guard()
+				{
+					if (snapshot) {
+						snapshot->readers.fetch_sub(1, std::memory_order_release);
+					}
+					self->_calls.fetch_sub(1, std::memory_order_release);
+					_event_frames = frame.previous;
+				}
+			} scope(this);
+
+			// synchronize() only waits for the readers it can see, so only use a snapshot that was still current after
+			// registering as one of its readers.
+			auto snapshot = _listeners.load(std::memory_order_seq_cst);
+			while (snapshot) {
+				snapshot->readers.fetch_add(1, std::memory_order_seq_cst);
+				auto current = _listeners.load(std::memory_order_seq_cst);
+				if (current == snapshot) {
+					break;
+				}
+				snapshot->readers.fetch_sub(1, std::memory_order_release);
+				snapshot = current;
+			}
+			if (!snapshot) {
+				return;
+			}
+			scope.snapshot       = snapshot;
+			scope.frame.snapshot = snapshot;
+
+			for (auto& l : snapshot->listeners) {
+				l.listener(args...);
 			}
 		}
 
 		public /* functions: listeners */:
 
 		/** Add a new listener to the event.
-		 * @param listener A listener bound with std::bind or a std::function.
+		 * @param listener Anything callable with the arguments of the event, like a lambda or the result of std::bind.
+		 * @return std::size_t Identifier of the listener, for use with remove().
 		 */
-		inline void add(std::function<void(_args...)> listener)
+		template<typename _fn>
+		inline std::size_t add(_fn&& listener)
 		{
 			std::lock_guard<std::recursive_mutex> lg(_lock);
-			if (_listeners.size() == 0) {
+			auto                                  current = _listeners.load(std::memory_order_relaxed);
+			if (!current || current->listeners.empty()) {
 				if (_cb_fill) {
 					_cb_fill();
 				}
 			}
-			_listeners.push_back(listener);
+
+			auto snapshot = current ? new snapshot_t(current->listeners) : new snapshot_t();
+			snapshot->listeners.push_back(entry{++_next_id, event_listener<_args...>(std::forward<_fn>(listener))});
+			publish(snapshot);
+			return _next_id;
 		}
-		inline event<_args...>& operator+=(std::function<void(_args...)> listener)
+		template<typename _fn>
+		inline event<_args...>& operator+=(_fn&& listener)
 		{
-			this->add(listener);
+			this->add(std::forward<_fn>(listener));
 			return *this;
 		}
 
 		/** Remove an existing listener from the event.
-		 * @param listener A listener bound with std::bind or a std::function.
+		 * @param id Identifier returned by add().
 		 */
-		inline void remove(std::function<void(_args...)> listener)
+		inline void remove(std::size_t id)
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			_listeners.remove(listener);
-			if (_listeners.size() == 0) {
-				if (_cb_clear) {
-					_cb_clear();
+			{
+				std::lock_guard<std::recursive_mutex> lg(_lock);
+				auto                                  current = _listeners.load(std::memory_order_relaxed);
+				if (!current) {
+					return;
+				}
+
+				auto snapshot = new snapshot_t();
+				snapshot->listeners.reserve(current->listeners.size());
+				for (auto& l : current->listeners) {
+					if (l.id != id) {
+						snapshot->listeners.push_back(l);
+					}
+				}
+				if (snapshot->listeners.size() == current->listeners.size()) {
+					delete snapshot;
+					return;
+				}
+				publish(snapshot);
+
+				if (snapshot->listeners.empty()) {
+					if (_cb_clear) {
+						_cb_clear();
+					}
 				}
 			}
+			synchronize();
 		}
-		inline event<_args...>& operator-=(std::function<void(_args...)> listener)
+		inline event<_args...>& operator-=(std::size_t id)
 		{
-			this->remove(listener);
+			this->remove(id);
 			return *this;
 		}
 
@@ -133,8 +352,8 @@ namespace streamfx::util {
 		 */
 		inline bool empty()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			return _listeners.empty();
+			auto snapshot = _listeners.load(std::memory_order_acquire);
+			return !snapshot || snapshot->listeners.empty();
 		}
 		inline operator bool()
 		{
@@ -145,11 +364,14 @@ namespace streamfx::util {
 		 */
 		inline void clear()
 		{
-			std::lock_guard<std::recursive_mutex> lg(_lock);
-			_listeners.clear();
-			if (_cb_clear) {
-				_cb_clear();
+			{
+				std::lock_guard<std::recursive_mutex> lg(_lock);
+				publish(nullptr);
+				if (_cb_clear) {
+					_cb_clear();
+				}
 			}
+			synchronize();
 		}
 		inline event<_args...>& operator=(std::nullptr_t)
 		{
@@ -170,5 +392,60 @@ namespace streamfx::util {
 			std::lock_guard<std::recursive_mutex> lg(_lock);
 			this->_cb_clear = cb;
 		}
+
+		private:
+		// Must be called with _lock held.
+		void publish(snapshot_t* snapshot)
+		{
+			if (auto previous = _listeners.exchange(snapshot, std::memory_order_seq_cst); previous) {
+				_retired.push_back(previous);
+			}
+
+			// Any call that started before the exchange has to be done before its snapshot can be released.
+			if (_calls.load(std::memory_order_seq_cst) == 0) {
+				for (auto retired : _retired) {
+					delete retired;
+				}
+				_retired.clear();
+			}
+		}
+
+		/** Wait for calls on other threads that still use a replaced snapshot.
+		 *
+		 * Calls that started on the current snapshot are not waited for, so a steady stream of calls can not hold this
+		 * up. Replaced snapshots stay allocated while '_calls' is raised, which is done here as well for the duration.
+		 */
+		void synchronize()
+		{
+			std::vector<snapshot_t*> pending;
+			{
+				std::lock_guard<std::recursive_mutex> lg(_lock);
+				if (_retired.empty()) {
+					return;
+				}
+				pending = _retired;
+				_calls.fetch_add(1, std::memory_order_seq_cst);
+			}
+
+			for (auto snapshot : pending) {
+				std::size_t own = 0;
+				for (auto frame = _event_frames; frame; frame = frame->previous) {
+					if (frame->snapshot == snapshot) {
+						own++;
+					}
+				}
+				while (snapshot->readers.load(std::memory_order_acquire) > own) {
+					std::this_thread::yield();
+				}
+			}
+
+			std::lock_guard<std::recursive_mutex> lg(_lock);
+			if (_calls.fetch_sub(1, std::memory_order_seq_cst) == 1) {
+				for (auto retired : _retired) {
+					delete retired;
+				}
+				_retired.clear();
+			}
+		}
 	};
 } // namespace streamfx::util
@@ -19,9 +19,117 @@
 
 #include "util-logging.hpp"
 #include "common.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <stdarg.h>
+#include <thread>
+#include <unordered_map>
 
-void streamfx::util::logging::log(level lvl, const char* format, ...)
+// Amount of messages a single call site may log per window, and the length of a window.
+#define ST_SITE_BURST 10
+#define ST_SITE_WINDOW std::chrono::seconds(1)
+
+// Call sites beyond this are not rate limited, which only happens if something is very wrong.
+#define ST_SITE_COUNT 256
+#define ST_SITE_PROBE 8
+
+// Messages beyond this are dropped instead of growing the queue without bound.
+#define ST_QUEUE_LIMIT 4096
+
+#define ST_DRAIN_INTERVAL std::chrono::milliseconds(100)
+
+using namespace streamfx::util::logging;
+
+namespace {
+	struct message {
+		std::atomic<message*> next;
+		level                 lvl;
+		const char*           site;
+		std::string           text;
+	};
+
+	struct site {
+		std::atomic<const char*> format;
+		std::atomic<int64_t>     window;
+		std::atomic<uint32_t>    count;
+		std::atomic<uint64_t>    suppressed;
+	};
+
+	/** Intrusive multi-producer single-consumer queue.
+	 *
+	 * Producers only ever exchange the head, so pushing never blocks. The consumer may briefly see an empty queue
+	 * while a push is in progress, which is fine since it will pick the message up on the next pass.
+	 */
+	class queue {
+		std::atomic<message*> _head;
+		message*              _tail;
+		message               _stub;
+
+		public:
+		queue() : _head(&_stub), _tail(&_stub), _stub()
+		{
+			_stub.next.store(nullptr);
+		}
+
+		void push(message* msg)
+		{
+			msg->next.store(nullptr, std::memory_order_relaxed);
+			message* prev = _head.exchange(msg, std::memory_order_acq_rel);
+			prev->next.store(msg, std::memory_order_release);
+		}
+
+		message* pop()
+		{
+			message* tail = _tail;
+			message* next = tail->next.load(std::memory_order_acquire);
+
+			if (tail == &_stub) {
+				if (!next) {
+					return nullptr;
+				}
+				_tail = next;
+				tail  = next;
+				next  = next->next.load(std::memory_order_acquire);
+			}
+
+			if (next) {
+				_tail = next;
+				return tail;
+			}
+
+			if (tail != _head.load(std::memory_order_acquire)) {
+				return nullptr;
+			}
+
+			// Put the stub back in so that the last real message can be handed out.
+			push(&_stub);
+			next = tail->next.load(std::memory_order_acquire);
+			if (next) {
+				_tail = next;
+				return tail;
+			}
+
+			return nullptr;
+		}
+	};
+} // namespace
+
+static queue                    _queue;
+static site                     _sites[ST_SITE_COUNT];
+static std::atomic<std::size_t> _queued{0};
+static std::atomic<uint64_t>    _dropped{0};
+static std::atomic<bool>        _running{false};
+static std::atomic<std::size_t> _producers{0};
+static std::thread              _thread;
+static std::mutex               _wake_lock;
+static std::condition_variable  _wake;
+
+// Only ever touched by the thread that drains the queue.
+static std::unordered_map<const char*, std::string> _last_text;
+
+static void write(level lvl, const char* text)
 {
 	const static std::map<level, int32_t> level_map = {
 		{level::LEVEL_DEBUG, LOG_DEBUG},
@@ -29,6 +137,110 @@ void streamfx::util::logging::log(level lvl, const char* format, ...)
 		{level::LEVEL_WARN, LOG_WARNING},
 		{level::LEVEL_ERROR, LOG_ERROR},
 	};
+
+	blog(level_map.at(lvl), "[StreamFX] %s", text);
+}
+
+static int64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+static site* find_site(const char* format)
+{
+	// Formats are almost always string literals, so the address alone identifies the call site.
+	std::size_t hash = (reinterpret_cast<uintptr_t>(format) >> 3) * 11400714819323198485ull;
+	for (std::size_t idx = 0; idx < ST_SITE_PROBE; idx++) {
+		site&       entry   = _sites[(hash + idx) % ST_SITE_COUNT];
+		const char* current = entry.format.load(std::memory_order_acquire);
+		if (current == format) {
+			return &entry;
+		} else if (current == nullptr) {
+			if (entry.format.compare_exchange_strong(current, format, std::memory_order_acq_rel)
+				|| (current == format)) {
+				return &entry;
+			}
+		}
+	}
+	return nullptr;
+}
+
+static bool is_allowed(site* entry)
+{
+	if (!entry) {
+		return true;
+	}
+
+	int64_t time   = now();
+	int64_t window = entry->window.load(std::memory_order_relaxed);
+	if ((time - window) >= std::chrono::duration_cast<std::chrono::nanoseconds>(ST_SITE_WINDOW).count()) {
+		// Whoever wins the exchange starts the new window, everyone else just counts towards it.
+		if (entry->window.compare_exchange_strong(window, time, std::memory_order_relaxed)) {
+			entry->count.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	if (entry->count.fetch_add(1, std::memory_order_relaxed) < ST_SITE_BURST) {
+		return true;
+	}
+
+	entry->suppressed.fetch_add(1, std::memory_order_relaxed);
+	return false;
+}
+
+static void summarize(bool force)
+{
+	int64_t time = now();
+	for (auto& entry : _sites) {
+		const char* format = entry.format.load(std::memory_order_acquire);
+		if (!format) {
+			continue;
+		}
+
+		// Wait for the window to end, so that a storm results in one summary per window instead of one per pass.
+		if (!force
+			&& ((time - entry.window.load(std::memory_order_relaxed))
+				< std::chrono::duration_cast<std::chrono::nanoseconds>(ST_SITE_WINDOW).count())) {
+			continue;
+		}
+
+		if (uint64_t suppressed = entry.suppressed.exchange(0, std::memory_order_relaxed); suppressed > 0) {
+			std::string text = "(repeated " + std::to_string(suppressed) + " times) ";
+			if (auto kv = _last_text.find(format); kv != _last_text.end()) {
+				text.append(kv->second);
+			} else {
+				text.append(format);
+			}
+			write(level::LEVEL_INFO, text.c_str());
+		}
+	}
+
+	if (uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed); dropped > 0) {
+		write(level::LEVEL_WARN, ("Log queue was full, dropped " + std::to_string(dropped) + " messages.").c_str());
+	}
+}
+
+static void drain()
+{
+	while (message* msg = _queue.pop()) {
+		_queued.fetch_sub(1, std::memory_order_relaxed);
+		write(msg->lvl, msg->text.c_str());
+		if (msg->site) {
+			_last_text[msg->site] = std::move(msg->text);
+		}
+		delete msg;
+	}
+}
+
+void streamfx::util::logging::log(level lvl, const char* format, ...)
+{
+	// Counting and dropping happens before formatting, which keeps a logging storm cheap for the caller.
+	site* entry = find_site(format);
+	if (!is_allowed(entry)) {
+		return;
+	}
+
 	thread_local static std::vector<char> buffer;
 
 	va_list vargs;
@@ -43,5 +255,61 @@ void streamfx::util::logging::log(level lvl, const char* format, ...)
 	va_end(vargs);
 	va_end(vargs_copy);
 
-	blog(level_map.at(lvl), "[StreamFX] %s", buffer.data());
+	// Sequentially consistent on purpose, finalize() relies on seeing either the producer or the stop.
+	_producers.fetch_add(1);
+	if (!_running.load()) {
+		_producers.fetch_sub(1);
+		write(lvl, buffer.data());
+		return;
+	}
+
+	if (_queued.fetch_add(1, std::memory_order_relaxed) >= ST_QUEUE_LIMIT) {
+		_queued.fetch_sub(1, std::memory_order_relaxed);
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		auto msg  = new message();
+		msg->lvl  = lvl;
+		msg->site = entry ? format : nullptr;
+		msg->text.assign(buffer.data(), static_cast<std::size_t>(ret));
+		_queue.push(msg);
+	}
+	_producers.fetch_sub(1);
+}
+
+void streamfx::util::logging::initialize()
+{
+	if (_running.exchange(true)) {
+		return;
+	}
+
+	_thread = std::thread([]() {
+		while (_running.load()) {
+			{
+				std::unique_lock<std::mutex> lock(_wake_lock);
+				_wake.wait_for(lock, ST_DRAIN_INTERVAL);
+			}
+			drain();
+			summarize(false);
+		}
+	});
+}
+
+void streamfx::util::logging::finalize()
+{
+	if (!_running.exchange(false)) {
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_wake_lock);
+		_wake.notify_all();
+	}
+	_thread.join();
+
+	// Anyone who saw us running may still be pushing, wait for them before taking over the queue.
+	while (_producers.load() > 0) {
+		std::this_thread::yield();
+	}
+	drain();
+	summarize(true);
 }
@@ -54,5 +54,16 @@ namespace streamfx::util::logging {
 		LEVEL_ERROR, // Errors that must be fixed.
 	};
 
+	/** Format and queue a message for the log.
+	 *
+	 * Messages are written by a background thread once initialize() was called, and directly before that. Each call
+	 * site (identified by 'format') may only log a few messages per second, the rest are counted and summarized.
+	 */
 	void log(level lvl, const char* format, ...);
+
+	/** Start writing messages from a background thread. */
+	void initialize();
+
+	/** Write all queued messages and go back to writing them directly. */
+	void finalize();
 } // namespace streamfx::util::logging
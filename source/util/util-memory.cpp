@@ -18,14 +18,116 @@
 */
 
 #include "util-memory.hpp"
-#include <cstdlib>
-#include <stdexcept>
-#include <stdlib.h>
+#include <atomic>
 
-#if defined(_MSC_VER) && (_MSC_VER <= 2100)
-//#define USE_MSC_ALLOC
-#elif defined(_cplusplus) && (__cplusplus >= 201103L)
-#define USE_STD_ALLOC
-#endif
+static std::atomic<uint64_t> _arena_heap_allocations{0};
+static std::atomic<uint64_t> _arena_heap_bytes{0};
+static std::atomic<uint64_t> _arena_peak_bytes{0};
+static std::atomic<uint64_t> _pool_heap_allocations{0};
+static std::atomic<uint64_t> _pool_heap_bytes{0};
 
-using namespace std;
+streamfx::util::memory::statistics streamfx::util::memory::stats()
+{
+	return {
+		_arena_heap_allocations.load(std::memory_order_relaxed), _arena_heap_bytes.load(std::memory_order_relaxed),
+		_arena_peak_bytes.load(std::memory_order_relaxed),       _pool_heap_allocations.load(std::memory_order_relaxed),
+		_pool_heap_bytes.load(std::memory_order_relaxed),
+	};
+}
+
+void streamfx::util::memory::track_pool_heap(std::size_t bytes)
+{
+	_pool_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	_pool_heap_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+streamfx::util::memory::arena::~arena() {}
+
+streamfx::util::memory::arena::arena(std::size_t size)
+	: _chunks(), _chunk(0), _offset(0), _used(0), _peak(0), _depth(0), _default_size(size)
+{}
+
+void* streamfx::util::memory::arena::allocate(std::size_t size, std::size_t align)
+{
+	// Try the current chunk first, then any chunk that an earlier scope left behind.
+	for (; _chunk < _chunks.size(); _chunk++, _offset = 0) {
+		auto&       current = _chunks[_chunk];
+		uintptr_t   base    = reinterpret_cast<uintptr_t>(current.data.get());
+		std::size_t start   = ((base + _offset + align - 1) & ~(static_cast<uintptr_t>(align) - 1)) - base;
+		if ((start + size) <= current.size) {
+			_used += (start - _offset) + size;
+			_offset = start + size;
+			return current.data.get() + start;
+		}
+	}
+
+	// Out of space, so this frame needs another chunk.
+	std::size_t chunk_size = std::max(_default_size, size + align);
+	_chunks.push_back({std::make_unique<uint8_t[]>(chunk_size), chunk_size});
+	_arena_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	_arena_heap_bytes.fetch_add(chunk_size, std::memory_order_relaxed);
+
+	_chunk  = _chunks.size() - 1;
+	_offset = 0;
+	return allocate(size, align);
+}
+
+std::size_t streamfx::util::memory::arena::used() const
+{
+	return _used;
+}
+
+std::size_t streamfx::util::memory::arena::peak() const
+{
+	return _peak;
+}
+
+void streamfx::util::memory::arena::merge()
+{
+	if (_used > _peak) {
+		_peak = _used;
+
+		uint64_t global = _arena_peak_bytes.load(std::memory_order_relaxed);
+		while ((global < _peak) && !_arena_peak_bytes.compare_exchange_weak(global, _peak)) {
+		}
+	}
+
+	// A single chunk large enough for the busiest frame so far keeps the next frame from allocating.
+	if (_chunks.size() > 1) {
+		std::size_t size = 0;
+		for (auto& current : _chunks) {
+			size += current.size;
+		}
+		_chunks.clear();
+		_chunks.push_back({std::make_unique<uint8_t[]>(size), size});
+		_arena_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+		_arena_heap_bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+}
+
+streamfx::util::memory::arena& streamfx::util::memory::frame_arena()
+{
+	static thread_local arena instance;
+	return instance;
+}
+
+streamfx::util::memory::arena::scope::scope() : scope(frame_arena()) {}
+
+streamfx::util::memory::arena::scope::scope(arena& parent)
+	: _parent(parent), _chunk(parent._chunk), _offset(parent._offset), _used(parent._used)
+{
+	_parent._depth++;
+}
+
+streamfx::util::memory::arena::scope::~scope()
+{
+	_parent._depth--;
+	_parent._chunk  = _chunk;
+	_parent._offset = _offset;
+
+	// Chunks can only be replaced if nothing outside of this scope still points into them.
+	if ((_parent._depth == 0) && (_chunk == 0) && (_offset == 0)) {
+		_parent.merge();
+	}
+	_parent._used = _used;
+}
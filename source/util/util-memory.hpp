@@ -0,0 +1,338 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace streamfx::util::memory {
+	/** Requests that the arenas and pools below had to make to the system allocator.
+	 *
+	 * Once everything has warmed up, none of these should change from one frame to the next. Allocations made outside
+	 * of the arenas and pools are not counted here, the benchmark reports those per iteration.
+	 */
+	struct statistics {
+		uint64_t arena_heap_allocations;
+		uint64_t arena_heap_bytes;
+		uint64_t arena_peak_bytes;
+		uint64_t pool_heap_allocations;
+		uint64_t pool_heap_bytes;
+	};
+
+	statistics stats();
+
+	void track_pool_heap(std::size_t bytes);
+
+	/** Bump allocator for data that does not outlive the current frame.
+	 *
+	 * Allocating moves a pointer forward, and nothing is ever freed on its own. Instead everything allocated within a
+	 * scope is released at once when that scope ends. If a frame needs more than the arena has, another chunk is
+	 * added, and all chunks are merged into one when the outermost scope ends so that the next frame fits again.
+	 *
+	 * Arenas are not thread-safe, frame_arena() returns the one that belongs to the calling thread.
+	 */
+	class arena {
+		struct chunk {
+			std::unique_ptr<uint8_t[]> data;
+			std::size_t                size;
+		};
+
+		std::vector<chunk> _chunks;
+		std::size_t        _chunk;
+		std::size_t        _offset;
+		std::size_t        _used;
+		std::size_t        _peak;
+		std::size_t        _depth;
+		std::size_t        _default_size;
+
+		public:
+		~arena();
+		arena(std::size_t size = 64 * 1024);
+
+		arena(arena const&)            = delete;
+		arena& operator=(arena const&) = delete;
+
+		void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+
+		template<typename T>
+		T* allocate(std::size_t count)
+		{
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		/** Bytes currently handed out, including padding for alignment. */
+		std::size_t used() const;
+
+		/** Highest value used() had when an outermost scope ended. */
+		std::size_t peak() const;
+
+		class scope {
+			arena&      _parent;
+			std::size_t _chunk;
+			std::size_t _offset;
+			std::size_t _used;
+
+			public:
+			scope();
+			scope(arena& parent);
+			~scope();
+
+			scope(scope const&)            = delete;
+			scope& operator=(scope const&) = delete;
+		};
+
+		private:
+		void merge();
+	};
+
+	arena& frame_arena();
+
+	/** Standard allocator on top of an arena, for containers that live no longer than the current scope. */
+	template<typename T>
+	class arena_allocator {
+		template<typename U>
+		friend class arena_allocator;
+
+		arena* _arena;
+
+		public:
+		typedef T value_type;
+
+		arena_allocator() noexcept : _arena(&frame_arena()) {}
+
+		arena_allocator(arena& parent) noexcept : _arena(&parent) {}
+
+		template<typename U>
+		arena_allocator(arena_allocator<U> const& other) noexcept : _arena(other._arena)
+		{}
+
+		T* allocate(std::size_t n)
+		{
+			return _arena->allocate<T>(n);
+		}
+
+		void deallocate(T*, std::size_t) noexcept {}
+
+		template<typename U>
+		bool operator==(arena_allocator<U> const& rhs) const noexcept
+		{
+			return _arena == rhs._arena;
+		}
+
+		template<typename U>
+		bool operator!=(arena_allocator<U> const& rhs) const noexcept
+		{
+			return _arena != rhs._arena;
+		}
+	};
+
+	/** Fixed size blocks, recycled through a cache on each thread.
+	 *
+	 * Threads allocate from and free into their own list of blocks, so neither takes a lock. Only when a thread runs
+	 * out of blocks, or collects too many of them, does it exchange a batch with the shared depot. Blocks are never
+	 * returned to the system, and the depot is intentionally leaked as blocks may still be freed during static
+	 * destruction.
+	 */
+	template<std::size_t _size>
+	class pool {
+		struct node {
+			node* next;
+		};
+
+		static constexpr std::size_t block_size =
+			((std::max(_size, sizeof(node)) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t))
+			* alignof(std::max_align_t);
+		static constexpr std::size_t batch_size = 64;
+
+		struct depot {
+			std::mutex                                 lock;
+			std::vector<std::pair<node*, std::size_t>> batches;
+			std::vector<std::unique_ptr<uint8_t[]>>    chunks;
+		};
+
+		// Trivially destructible, so that it is still safe to touch after the thread started shutting down.
+		struct cache {
+			node*       free;
+			std::size_t count;
+			bool        registered;
+			bool        dead;
+		};
+
+		struct cache_guard {
+			~cache_guard()
+			{
+				cache& local = get_cache();
+				if (local.free) {
+					give(local.free, local.count);
+				}
+				local.free  = nullptr;
+				local.count = 0;
+				local.dead  = true;
+			}
+		};
+
+		static depot& get_depot()
+		{
+			static depot* instance = new depot();
+			return *instance;
+		}
+
+		static cache& get_cache()
+		{
+			static thread_local cache instance = {nullptr, 0, false, false};
+			return instance;
+		}
+
+		static void give(node* list, std::size_t count)
+		{
+			depot&                       shared = get_depot();
+			std::unique_lock<std::mutex> lock(shared.lock);
+			shared.batches.emplace_back(list, count);
+		}
+
+		static void refill(cache& local)
+		{
+			depot&                       shared = get_depot();
+			std::unique_lock<std::mutex> lock(shared.lock);
+			if (!shared.batches.empty()) {
+				local.free  = shared.batches.back().first;
+				local.count = shared.batches.back().second;
+				shared.batches.pop_back();
+				return;
+			}
+
+			auto chunk = std::make_unique<uint8_t[]>(block_size * batch_size);
+			for (std::size_t idx = 0; idx < batch_size; idx++) {
+				auto block  = reinterpret_cast<node*>(chunk.get() + block_size * idx);
+				block->next = local.free;
+				local.free  = block;
+			}
+			local.count = batch_size;
+			shared.chunks.push_back(std::move(chunk));
+			track_pool_heap(block_size * batch_size);
+		}
+
+		static cache& acquire_cache()
+		{
+			cache& local = get_cache();
+			if (!local.registered) {
+				local.registered = true;
+				static thread_local cache_guard guard;
+			}
+			return local;
+		}
+
+		public:
+		static void* allocate()
+		{
+			cache& local = acquire_cache();
+			if (local.dead) {
+				return ::operator new(block_size);
+			}
+
+			if (!local.free) {
+				refill(local);
+			}
+			node* block = local.free;
+			local.free  = block->next;
+			local.count--;
+			return block;
+		}
+
+		static void deallocate(void* ptr)
+		{
+			cache& local = acquire_cache();
+			auto   block = reinterpret_cast<node*>(ptr);
+			if (local.dead) {
+				// Blocks from the system and from chunks look the same, so keep them all.
+				block->next = nullptr;
+				give(block, 1);
+				return;
+			}
+
+			block->next = local.free;
+			local.free  = block;
+			local.count++;
+
+			// Hand a batch back to the depot, so blocks freed on a different thread than they came from don't pile up.
+			if (local.count >= (batch_size * 2)) {
+				node* list = local.free;
+				node* tail = list;
+				for (std::size_t idx = 1; idx < batch_size; idx++) {
+					tail = tail->next;
+				}
+				local.free = tail->next;
+				local.count -= batch_size;
+				tail->next = nullptr;
+				give(list, batch_size);
+			}
+		}
+	};
+
+	/** Standard allocator on top of the pools, for single objects such as the ones std::allocate_shared creates. */
+	template<typename T>
+	class pool_allocator {
+		static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported.");
+
+		public:
+		typedef T value_type;
+
+		pool_allocator() noexcept {}
+
+		template<typename U>
+		pool_allocator(pool_allocator<U> const&) noexcept
+		{}
+
+		T* allocate(std::size_t n)
+		{
+			if (n != 1) {
+				return static_cast<T*>(::operator new(n * sizeof(T)));
+			}
+			return static_cast<T*>(pool<sizeof(T)>::allocate());
+		}
+
+		void deallocate(T* ptr, std::size_t n) noexcept
+		{
+			if (n != 1) {
+				::operator delete(ptr);
+			} else {
+				pool<sizeof(T)>::deallocate(ptr);
+			}
+		}
+
+		template<typename U>
+		bool operator==(pool_allocator<U> const&) const noexcept
+		{
+			return true;
+		}
+
+		template<typename U>
+		bool operator!=(pool_allocator<U> const&) const noexcept
+		{
+			return false;
+		}
+	};
+} // namespace streamfx::util::memory
@@ -40,6 +40,30 @@
 
 #ifdef WIN32
 #include <Windows.h>
+#else
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+std::string streamfx::util::platform::type_name(std::type_info const& type)
+{
+#ifdef WIN32
+	// MSVC already hands out readable names.
+	return std::string(type.name());
+#else
+	int   status = 0;
+	char* name   = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+	if ((status != 0) || !name) {
+		return std::string(type.name());
+	}
+
+	std::string result{name};
+	free(name);
+	return result;
+#endif
+}
+
+#ifdef WIN32
 
 std::string streamfx::util::platform::native_to_utf8(std::wstring const& v)
 {
@@ -24,6 +24,7 @@
 #pragma once
 #include <filesystem>
 #include <string>
+#include <typeinfo>
 
 namespace streamfx::util::platform {
 #ifdef WIN32
@@ -51,4 +52,7 @@ namespace streamfx::util::platform {
 		return std::filesystem::path(v);
 	};
 #endif
+
+	/** Human readable name of a type, as far as the compiler is willing to tell. */
+	std::string type_name(std::type_info const& type);
 } // namespace streamfx::util::platform
@@ -18,11 +18,82 @@
  */
 
 #include "util-profiler.hpp"
-#include <iterator>
+#include <limits>
 
-streamfx::util::profiler::profiler() {}
+// Threads are spread over the shards in the order they first track something.
+static std::atomic<std::size_t> shard_next{0};
+static thread_local std::size_t shard_local = shard_next.fetch_add(1);
 
-streamfx::util::profiler::~profiler() {}
+streamfx::util::profiler::profiler()
+{
+	for (auto& data : _shards) {
+		data.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+streamfx::util::profiler::~profiler()
+{
+	for (auto& data : _shards) {
+		delete data.load(std::memory_order_relaxed);
+	}
+}
+
+std::size_t streamfx::util::profiler::bucket_index(uint64_t value)
+{
+	if (value < sub_bucket_count) {
+		return static_cast<std::size_t>(value);
+	}
+
+	// Find the highest set bit, everything below the top 'sub_bucket_bits' bits is dropped.
+	std::size_t msb = 0;
+	for (uint64_t v = value; v > 1; v >>= 1) {
+		msb++;
+	}
+	if (msb > highest_bit) {
+		return bucket_count - 1;
+	}
+
+	std::size_t shift = msb - (sub_bucket_bits - 1);
+	return shift * sub_bucket_half + static_cast<std::size_t>(value >> shift);
+}
+
+uint64_t streamfx::util::profiler::bucket_value(std::size_t index)
+{
+	if (index < sub_bucket_count) {
+		return index;
+	}
+
+	// Report the middle of the bucket, which halves the worst case error.
+	std::size_t shift = (index / sub_bucket_half) - 1;
+	uint64_t    lower = static_cast<uint64_t>(index - shift * sub_bucket_half) << shift;
+	return lower + ((uint64_t(1) << shift) >> 1);
+}
+
+void streamfx::util::profiler::clear(shard& data)
+{
+	for (auto& bucket : data.buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	data.count.store(0, std::memory_order_relaxed);
+	data.sum.store(0, std::memory_order_relaxed);
+	data.minimum.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+	data.maximum.store(0, std::memory_order_relaxed);
+}
+
+streamfx::util::profiler::shard& streamfx::util::profiler::get_shard(std::size_t index)
+{
+	shard* data = _shards[index].load(std::memory_order_acquire);
+	if (!data) {
+		auto created = std::make_unique<shard>();
+		clear(*created);
+
+		// Another thread may have been faster, in which case ours is simply thrown away again.
+		if (_shards[index].compare_exchange_strong(data, created.get(), std::memory_order_acq_rel)) {
+			data = created.release();
+		}
+	}
+	return *data;
+}
 
 std::shared_ptr<streamfx::util::profiler::instance> streamfx::util::profiler::track()
 {
@@ -31,117 +102,166 @@ std::shared_ptr<streamfx::util::profiler::instance> streamfx::util::profiler::tr
 
 void streamfx::util::profiler::track(std::chrono::nanoseconds duration)
 {
-	std::unique_lock<std::mutex> ul(_timings_lock);
-	auto                         itr = _timings.find(duration);
-	if (itr == _timings.end()) {
-		_timings.emplace(duration, 1u);
-	} else {
-		itr->second++;
+	uint64_t value = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+	auto&    data  = get_shard(shard_local % shard_count);
+
+	data.buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+	data.count.fetch_add(1, std::memory_order_relaxed);
+	data.sum.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t minimum = data.minimum.load(std::memory_order_relaxed);
+	while ((value < minimum) && !data.minimum.compare_exchange_weak(minimum, value, std::memory_order_relaxed)) {
+	}
+	uint64_t maximum = data.maximum.load(std::memory_order_relaxed);
+	while ((value > maximum) && !data.maximum.compare_exchange_weak(maximum, value, std::memory_order_relaxed)) {
 	}
 }
 
-uint64_t streamfx::util::profiler::count()
+streamfx::util::profiler::snapshot streamfx::util::profiler::capture(bool reset)
 {
-	uint64_t count = 0;
+	snapshot result;
+	for (auto& ptr : _shards) {
+		shard* data_ptr = ptr.load(std::memory_order_acquire);
+		if (!data_ptr) {
+			continue;
+		}
 
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
+		auto& data = *data_ptr;
+		if (reset) {
+			for (std::size_t bucket = 0; bucket < bucket_count; bucket++) {
+				result._buckets[bucket] += data.buckets[bucket].exchange(0, std::memory_order_relaxed);
+			}
+			result._count += data.count.exchange(0, std::memory_order_relaxed);
+			result._sum += data.sum.exchange(0, std::memory_order_relaxed);
+			uint64_t minimum = data.minimum.exchange(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+			result._minimum  = std::min(result._minimum, minimum);
+			result._maximum = std::max(result._maximum, data.maximum.exchange(0, std::memory_order_relaxed));
+		} else {
+			for (std::size_t bucket = 0; bucket < bucket_count; bucket++) {
+				result._buckets[bucket] += data.buckets[bucket].load(std::memory_order_relaxed);
+			}
+			result._count += data.count.load(std::memory_order_relaxed);
+			result._sum += data.sum.load(std::memory_order_relaxed);
+			result._minimum = std::min(result._minimum, data.minimum.load(std::memory_order_relaxed));
+			result._maximum = std::max(result._maximum, data.maximum.load(std::memory_order_relaxed));
+		}
 	}
+	return result;
+}
 
-	for (auto kv : copy_timings) {
-		count += kv.second;
+void streamfx::util::profiler::reset()
+{
+	for (auto& ptr : _shards) {
+		if (shard* data = ptr.load(std::memory_order_acquire); data) {
+			clear(*data);
+		}
 	}
+}
 
-	return count;
+uint64_t streamfx::util::profiler::count()
+{
+	uint64_t result = 0;
+	for (auto& ptr : _shards) {
+		if (shard* data = ptr.load(std::memory_order_acquire); data) {
+			result += data->count.load(std::memory_order_relaxed);
+		}
+	}
+	return result;
 }
 
 std::chrono::nanoseconds streamfx::util::profiler::total_duration()
 {
-	std::chrono::nanoseconds duration{0};
-
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
+	uint64_t result = 0;
+	for (auto& ptr : _shards) {
+		if (shard* data = ptr.load(std::memory_order_acquire); data) {
+			result += data->sum.load(std::memory_order_relaxed);
+		}
 	}
+	return std::chrono::nanoseconds(static_cast<int64_t>(result));
+}
 
-	for (auto kv : copy_timings) {
-		duration += kv.first * kv.second;
+double_t streamfx::util::profiler::average_duration()
+{
+	uint64_t samples = count();
+	if (samples == 0) {
+		return 0.;
 	}
-
-	return duration;
+	return double_t(total_duration().count()) / double_t(samples);
 }
 
-double_t streamfx::util::profiler::average_duration()
+std::chrono::nanoseconds streamfx::util::profiler::percentile(double_t percentile, bool by_time)
 {
-	std::chrono::nanoseconds duration{0};
-	uint64_t                 count = 0;
+	return capture().percentile(percentile, by_time);
+}
 
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), std::inserter(copy_timings, copy_timings.end()));
-	}
+streamfx::util::profiler::snapshot::snapshot()
+	: _buckets(bucket_count, 0), _count(0), _sum(0), _minimum(std::numeric_limits<uint64_t>::max()), _maximum(0)
+{}
 
-	for (auto kv : copy_timings) {
-		duration += kv.first * kv.second;
-		count += kv.second;
+void streamfx::util::profiler::snapshot::merge(snapshot const& other)
+{
+	for (std::size_t bucket = 0; bucket < bucket_count; bucket++) {
+		_buckets[bucket] += other._buckets[bucket];
 	}
+	_count += other._count;
+	_sum += other._sum;
+	_minimum = std::min(_minimum, other._minimum);
+	_maximum = std::max(_maximum, other._maximum);
+}
 
-	return double_t(duration.count()) / double_t(count);
+uint64_t streamfx::util::profiler::snapshot::count() const
+{
+	return _count;
 }
 
-template<typename T>
-inline bool is_equal(T a, T b, T c)
+std::chrono::nanoseconds streamfx::util::profiler::snapshot::total_duration() const
 {
-	return (a == b) || ((a >= (b - c)) && (a <= (b + c)));
+	return std::chrono::nanoseconds(static_cast<int64_t>(_sum));
 }
 
-std::chrono::nanoseconds streamfx::util::profiler::percentile(double_t percentile, bool by_time)
+double_t streamfx::util::profiler::snapshot::average_duration() const
 {
-	constexpr double_t edge  = 0.00005;
-	uint64_t           calls = count();
+	if (_count == 0) {
+		return 0.;
+	}
+	return double_t(_sum) / double_t(_count);
+}
 
-	std::map<std::chrono::nanoseconds, size_t> copy_timings;
-	{
-		std::unique_lock<std::mutex> ul(_timings_lock);
-		copy(_timings.begin(), _timings.end(), inserter(copy_timings, copy_timings.end()));
+std::chrono::nanoseconds streamfx::util::profiler::snapshot::percentile(double_t percentile, bool by_time) const
+{
+	if (_count == 0) {
+		return std::chrono::nanoseconds(-1);
+	}
+
+	// The exact extremes are known, so there is no need to guess them from the buckets.
+	if (percentile <= 0.0) {
+		return std::chrono::nanoseconds(static_cast<int64_t>(_minimum));
+	} else if (percentile >= 1.0) {
+		return std::chrono::nanoseconds(static_cast<int64_t>(_maximum));
 	}
+
 	if (by_time) { // Return by time percentile.
-		// Find largest and smallest time.
-		std::chrono::nanoseconds smallest = copy_timings.begin()->first;
-		std::chrono::nanoseconds largest  = copy_timings.rbegin()->first;
-		std::chrono::nanoseconds variance = largest - smallest;
-
-		for (auto kv : copy_timings) {
-			double_t kv_pct = double_t((kv.first - smallest).count()) / double_t(variance.count());
-			if (is_equal<double_t>(kv_pct, percentile, edge) || (kv_pct > percentile)) {
-				return std::chrono::nanoseconds(kv.first);
+		// Find the first sample at or past the given point between the smallest and largest time.
+		uint64_t    threshold = _minimum + static_cast<uint64_t>(double_t(_maximum - _minimum) * percentile);
+		std::size_t first     = bucket_index(threshold);
+		for (std::size_t bucket = first; bucket < bucket_count; bucket++) {
+			if (_buckets[bucket] > 0) {
+				return std::chrono::nanoseconds(static_cast<int64_t>(std::min(bucket_value(bucket), _maximum)));
 			}
 		}
 	} else { // Return by call percentile.
-		if (percentile == 0.0) {
-			return copy_timings.begin()->first;
-		}
-
-		uint64_t accu_calls_now = 0;
-		for (auto kv : copy_timings) {
-			uint64_t accu_calls_last = accu_calls_now;
-			accu_calls_now += kv.second;
-
-			double_t percentile_last = double_t(accu_calls_last) / double_t(calls);
-			double_t percentile_now  = double_t(accu_calls_now) / double_t(calls);
-
-			if (is_equal<double_t>(percentile, percentile_now, edge)
-				|| ((percentile_last < percentile) && (percentile_now > percentile))) {
-				return std::chrono::nanoseconds(kv.first);
+		uint64_t target = static_cast<uint64_t>(std::ceil(double_t(_count) * percentile));
+		uint64_t total  = 0;
+		for (std::size_t bucket = 0; bucket < bucket_count; bucket++) {
+			total += _buckets[bucket];
+			if (total >= target) {
+				uint64_t value = std::max(std::min(bucket_value(bucket), _maximum), _minimum);
+				return std::chrono::nanoseconds(static_cast<int64_t>(value));
 			}
 		}
 	}
 
-	return std::chrono::nanoseconds(-1);
+	return std::chrono::nanoseconds(static_cast<int64_t>(_maximum));
 }
 
 streamfx::util::profiler::instance::instance(std::shared_ptr<streamfx::util::profiler> parent)
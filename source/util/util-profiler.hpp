@@ -19,14 +19,38 @@
 
 #pragma once
 #include "common.hpp"
+#include <atomic>
 #include <chrono>
-#include <map>
-#include <mutex>
+#include <vector>
 
 namespace streamfx::util {
+	/** Duration histogram with fixed memory usage.
+	 *
+	 * Samples are sorted into log-linear buckets, which keep the relative error below 1% across the entire range of
+	 * 1ns to a bit over two minutes. Each thread writes into one of a few shards with plain atomic increments, so
+	 * tracking never blocks and is cheap enough to do for every frame. Shards are only created once a thread tracks
+	 * something, most profilers only ever need one.
+	 *
+	 * count(), total_duration() and average_duration() only read a few counters. percentile() copies the histogram,
+	 * so capture() a snapshot once and query that instead when more than one percentile is needed.
+	 */
 	class profiler : public std::enable_shared_from_this<streamfx::util::profiler> {
-		std::map<std::chrono::nanoseconds, size_t> _timings;
-		std::mutex                                 _timings_lock;
+		static constexpr std::size_t sub_bucket_bits  = 7;
+		static constexpr std::size_t sub_bucket_count = std::size_t(1) << sub_bucket_bits;
+		static constexpr std::size_t sub_bucket_half  = sub_bucket_count / 2;
+		static constexpr std::size_t highest_bit      = 36;
+		static constexpr std::size_t bucket_count     = (highest_bit - sub_bucket_bits + 3) * sub_bucket_half;
+		static constexpr std::size_t shard_count      = 4;
+
+		struct alignas(64) shard {
+			std::atomic<uint64_t> buckets[bucket_count];
+			std::atomic<uint64_t> count;
+			std::atomic<uint64_t> sum;
+			std::atomic<uint64_t> minimum;
+			std::atomic<uint64_t> maximum;
+		};
+
+		std::atomic<shard*> _shards[shard_count];
 
 		public:
 		class instance {
@@ -43,9 +67,41 @@ namespace streamfx::util {
 			void reparent(std::shared_ptr<profiler> parent);
 		};
 
+		/** Point in time copy of a profiler, which can be combined with others. */
+		class snapshot {
+			std::vector<uint64_t> _buckets;
+			uint64_t              _count;
+			uint64_t              _sum;
+			uint64_t              _minimum;
+			uint64_t              _maximum;
+
+			public:
+			snapshot();
+
+			void merge(snapshot const& other);
+
+			uint64_t count() const;
+
+			std::chrono::nanoseconds total_duration() const;
+
+			double_t average_duration() const;
+
+			std::chrono::nanoseconds percentile(double_t percentile, bool by_time = false) const;
+
+			friend class streamfx::util::profiler;
+		};
+
 		private:
 		profiler();
 
+		static std::size_t bucket_index(uint64_t value);
+
+		static uint64_t bucket_value(std::size_t index);
+
+		static void clear(shard& data);
+
+		shard& get_shard(std::size_t index);
+
 		public:
 		~profiler();
 
@@ -53,6 +109,14 @@ namespace streamfx::util {
 
 		void track(std::chrono::nanoseconds duration);
 
+		/** Copy the current state, optionally starting a new window at the same time.
+		 *
+		 * With 'reset' set, every sample ends up in exactly one snapshot even while other threads keep tracking.
+		 */
+		snapshot capture(bool reset = false);
+
+		void reset();
+
 		uint64_t count();
 
 		std::chrono::nanoseconds total_duration();
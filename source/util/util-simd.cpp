@@ -0,0 +1,230 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include "util-simd.hpp"
+
+#ifdef ST_CPU_X86
+#include <immintrin.h>
+#endif
+#ifdef ST_CPU_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace streamfx::util::cpu;
+
+//--------------------------------------------------------------------------------//
+// Deinterleave
+//--------------------------------------------------------------------------------//
+
+static void deinterleave_u8_c(uint8_t const* source, uint8_t* target_a, uint8_t* target_b, std::size_t count)
+{
+	for (std::size_t idx = 0; idx < count; idx++) {
+		target_a[idx] = source[idx * 2];
+		target_b[idx] = source[idx * 2 + 1];
+	}
+}
+
+#ifdef ST_CPU_X86
+ST_CPU_TARGET("sse2")
+static void deinterleave_u8_sse2(uint8_t const* source, uint8_t* target_a, uint8_t* target_b, std::size_t count)
+{
+	__m128i const low = _mm_set1_epi16(0x00FF);
+
+	std::size_t idx = 0;
+	for (; (idx + 16) <= count; idx += 16) {
+		__m128i v0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + idx * 2));
+		__m128i v1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + idx * 2 + 16));
+		__m128i a  = _mm_packus_epi16(_mm_and_si128(v0, low), _mm_and_si128(v1, low));
+		__m128i b  = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(target_a + idx), a);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(target_b + idx), b);
+	}
+	deinterleave_u8_c(source + idx * 2, target_a + idx, target_b + idx, count - idx);
+}
+
+ST_CPU_TARGET("avx2")
+static void deinterleave_u8_avx2(uint8_t const* source, uint8_t* target_a, uint8_t* target_b, std::size_t count)
+{
+	__m256i const low = _mm256_set1_epi16(0x00FF);
+
+	std::size_t idx = 0;
+	for (; (idx + 32) <= count; idx += 32) {
+		__m256i v0 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + idx * 2));
+		__m256i v1 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + idx * 2 + 32));
+		__m256i a  = _mm256_packus_epi16(_mm256_and_si256(v0, low), _mm256_and_si256(v1, low));
+		__m256i b  = _mm256_packus_epi16(_mm256_srli_epi16(v0, 8), _mm256_srli_epi16(v1, 8));
+		// Packing works on each 128-bit lane separately, which leaves the halves of v0 and v1 interleaved.
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(target_a + idx), _mm256_permute4x64_epi64(a, 0xD8));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(target_b + idx), _mm256_permute4x64_epi64(b, 0xD8));
+	}
+	deinterleave_u8_c(source + idx * 2, target_a + idx, target_b + idx, count - idx);
+}
+
+ST_CPU_TARGET("avx512f,avx512bw")
+static void deinterleave_u8_avx512(uint8_t const* source, uint8_t* target_a, uint8_t* target_b, std::size_t count)
+{
+	__m512i const low   = _mm512_set1_epi16(0x00FF);
+	__m512i const order = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+
+	std::size_t idx = 0;
+	for (; (idx + 64) <= count; idx += 64) {
+		__m512i v0 = _mm512_loadu_si512(source + idx * 2);
+		__m512i v1 = _mm512_loadu_si512(source + idx * 2 + 64);
+		__m512i a  = _mm512_packus_epi16(_mm512_and_si512(v0, low), _mm512_and_si512(v1, low));
+		__m512i b  = _mm512_packus_epi16(_mm512_srli_epi16(v0, 8), _mm512_srli_epi16(v1, 8));
+		_mm512_storeu_si512(target_a + idx, _mm512_permutexvar_epi64(order, a));
+		_mm512_storeu_si512(target_b + idx, _mm512_permutexvar_epi64(order, b));
+	}
+	deinterleave_u8_c(source + idx * 2, target_a + idx, target_b + idx, count - idx);
+}
+#endif
+
+#ifdef ST_CPU_NEON
+static void deinterleave_u8_neon(uint8_t const* source, uint8_t* target_a, uint8_t* target_b, std::size_t count)
+{
+	std::size_t idx = 0;
+	for (; (idx + 16) <= count; idx += 16) {
+		uint8x16x2_t v = vld2q_u8(source + idx * 2);
+		vst1q_u8(target_a + idx, v.val[0]);
+		vst1q_u8(target_b + idx, v.val[1]);
+	}
+	deinterleave_u8_c(source + idx * 2, target_a + idx, target_b + idx, count - idx);
+}
+#endif
+
+streamfx::util::cpu::kernel<streamfx::util::simd::deinterleave_u8_t> const streamfx::util::simd::deinterleave_u8{
+	"deinterleave_u8",
+	{
+#ifdef ST_CPU_X86
+		{"AVX512BW", feature::AVX512F | feature::AVX512BW, deinterleave_u8_avx512},
+		{"AVX2", feature::AVX2, deinterleave_u8_avx2},
+		{"SSE2", feature::SSE2, deinterleave_u8_sse2},
+#endif
+#ifdef ST_CPU_NEON
+		{"NEON", feature::NEON, deinterleave_u8_neon},
+#endif
+		{"C", feature::NONE, deinterleave_u8_c},
+	}};
+
+//--------------------------------------------------------------------------------//
+// Widen
+//--------------------------------------------------------------------------------//
+
+static void widen_u8_u16_c(uint8_t const* source, uint16_t* target, std::size_t count, uint32_t shift, uint16_t mask)
+{
+	for (std::size_t idx = 0; idx < count; idx++) {
+		uint32_t value = source[idx];
+		target[idx]    = static_cast<uint16_t>(((value << shift) | (value >> (8 - shift))) & mask);
+	}
+}
+
+#ifdef ST_CPU_X86
+ST_CPU_TARGET("sse2")
+static void widen_u8_u16_sse2(uint8_t const* source, uint16_t* target, std::size_t count, uint32_t shift,
+							  uint16_t mask)
+{
+	__m128i const zero  = _mm_setzero_si128();
+	__m128i const keep  = _mm_set1_epi16(static_cast<short>(mask));
+	__m128i const left  = _mm_cvtsi32_si128(static_cast<int>(shift));
+	__m128i const right = _mm_cvtsi32_si128(static_cast<int>(8 - shift));
+
+	std::size_t idx = 0;
+	for (; (idx + 16) <= count; idx += 16) {
+		__m128i v  = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + idx));
+		__m128i lo = _mm_unpacklo_epi8(v, zero);
+		__m128i hi = _mm_unpackhi_epi8(v, zero);
+		lo         = _mm_and_si128(_mm_or_si128(_mm_sll_epi16(lo, left), _mm_srl_epi16(lo, right)), keep);
+		hi         = _mm_and_si128(_mm_or_si128(_mm_sll_epi16(hi, left), _mm_srl_epi16(hi, right)), keep);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(target + idx), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(target + idx + 8), hi);
+	}
+	widen_u8_u16_c(source + idx, target + idx, count - idx, shift, mask);
+}
+
+ST_CPU_TARGET("avx2")
+static void widen_u8_u16_avx2(uint8_t const* source, uint16_t* target, std::size_t count, uint32_t shift,
+							  uint16_t mask)
+{
+	__m256i const keep  = _mm256_set1_epi16(static_cast<short>(mask));
+	__m128i const left  = _mm_cvtsi32_si128(static_cast<int>(shift));
+	__m128i const right = _mm_cvtsi32_si128(static_cast<int>(8 - shift));
+
+	std::size_t idx = 0;
+	for (; (idx + 16) <= count; idx += 16) {
+		__m256i v = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const*>(source + idx)));
+		v         = _mm256_and_si256(_mm256_or_si256(_mm256_sll_epi16(v, left), _mm256_srl_epi16(v, right)), keep);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + idx), v);
+	}
+	widen_u8_u16_c(source + idx, target + idx, count - idx, shift, mask);
+}
+
+ST_CPU_TARGET("avx512f,avx512bw")
+static void widen_u8_u16_avx512(uint8_t const* source, uint16_t* target, std::size_t count, uint32_t shift,
+								uint16_t mask)
+{
+	__m512i const keep  = _mm512_set1_epi16(static_cast<short>(mask));
+	__m128i const left  = _mm_cvtsi32_si128(static_cast<int>(shift));
+	__m128i const right = _mm_cvtsi32_si128(static_cast<int>(8 - shift));
+
+	std::size_t idx = 0;
+	for (; (idx + 32) <= count; idx += 32) {
+		__m512i v = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + idx)));
+		v         = _mm512_and_si512(_mm512_or_si512(_mm512_sll_epi16(v, left), _mm512_srl_epi16(v, right)), keep);
+		_mm512_storeu_si512(target + idx, v);
+	}
+	widen_u8_u16_c(source + idx, target + idx, count - idx, shift, mask);
+}
+#endif
+
+#ifdef ST_CPU_NEON
+static void widen_u8_u16_neon(uint8_t const* source, uint16_t* target, std::size_t count, uint32_t shift,
+							  uint16_t mask)
+{
+	uint16x8_t const keep  = vdupq_n_u16(mask);
+	int16x8_t const  left  = vdupq_n_s16(static_cast<int16_t>(shift));
+	int16x8_t const  right = vdupq_n_s16(-static_cast<int16_t>(8 - shift)); // Negative shifts go right.
+
+	std::size_t idx = 0;
+	for (; (idx + 16) <= count; idx += 16) {
+		uint8x16_t v  = vld1q_u8(source + idx);
+		uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+		uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+		lo            = vandq_u16(vorrq_u16(vshlq_u16(lo, left), vshlq_u16(lo, right)), keep);
+		hi            = vandq_u16(vorrq_u16(vshlq_u16(hi, left), vshlq_u16(hi, right)), keep);
+		vst1q_u16(target + idx, lo);
+		vst1q_u16(target + idx + 8, hi);
+	}
+	widen_u8_u16_c(source + idx, target + idx, count - idx, shift, mask);
+}
+#endif
+
+streamfx::util::cpu::kernel<streamfx::util::simd::widen_u8_u16_t> const streamfx::util::simd::widen_u8_u16{
+	"widen_u8_u16",
+	{
+#ifdef ST_CPU_X86
+		{"AVX512BW", feature::AVX512F | feature::AVX512BW, widen_u8_u16_avx512},
+		{"AVX2", feature::AVX2, widen_u8_u16_avx2},
+		{"SSE2", feature::SSE2, widen_u8_u16_sse2},
+#endif
+#ifdef ST_CPU_NEON
+		{"NEON", feature::NEON, widen_u8_u16_neon},
+#endif
+		{"C", feature::NONE, widen_u8_u16_c},
+	}};
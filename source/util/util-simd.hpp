@@ -0,0 +1,40 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#pragma once
+#include "common.hpp"
+#include "util-cpu.hpp"
+
+// Plain data kernels with several implementations each, see streamfx::util::cpu::kernel.
+namespace streamfx::util::simd {
+	/** Splits pairs of bytes into two planes, such as the interleaved chroma plane of NV12. */
+	typedef void deinterleave_u8_t(uint8_t const* source, uint8_t* target_a, uint8_t* target_b, std::size_t count);
+	extern streamfx::util::cpu::kernel<deinterleave_u8_t> const deinterleave_u8;
+
+	/** Widens bytes to 16 bits as '((v << shift) | (v >> (8 - shift))) & mask', for a shift of 1 to 8.
+	 *
+	 * The mask decides which bits are kept, and with that whether the top bits are repeated in the new low bits. For
+	 * example 10-bit chroma uses a shift of 2 with 0x3FC, full range 10-bit luma 0x3FF instead, and P010 a shift of 8
+	 * with 0xFF00 or 0xFFC0 respectively.
+	 */
+	typedef void widen_u8_u16_t(uint8_t const* source, uint16_t* target, std::size_t count, uint32_t shift,
+								uint16_t mask);
+	extern streamfx::util::cpu::kernel<widen_u8_u16_t> const widen_u8_u16;
+} // namespace streamfx::util::simd
@@ -19,8 +19,16 @@
 
 #include "util-threadpool.hpp"
 #include "common.hpp"
+#include <chrono>
 #include <cstddef>
 #include "util/util-logging.hpp"
+#include "util/util-memory.hpp"
+#include "util/util-platform.hpp"
+#include "util/util-profiler.hpp"
+
+#ifdef ENABLE_PROFILING
+#include "util/util-tracer.hpp"
+#endif
 
 #ifdef _DEBUG
 #define ST_PREFIX "<%s> "
@@ -39,122 +47,628 @@
 // Most Tasks likely wait for IO, so we can use that time for other tasks.
 #define ST_CONCURRENCY_MULTIPLIER 2
 
+// Workers which are always kept around, so that small amounts of work never wait for a thread to start.
+#define ST_WORKERS_MINIMUM 2
+
+// How long a worker may sleep before it gives its thread back.
+#define ST_WORKER_IDLE_TIMEOUT std::chrono::seconds(30)
+
+// How long tasks must wait without any idle worker before another worker is added.
+#define ST_WORKER_GROW_DELAY std::chrono::milliseconds(10)
+
+// How often the watchdog looks at the pool, and how much history it keeps.
+#define ST_WATCHDOG_INTERVAL std::chrono::milliseconds(250)
+#define ST_WATCHDOG_HISTORY 240
+
+// Tasks running for longer than this are reported as possibly stuck.
+#define ST_WATCHDOG_THRESHOLD std::chrono::seconds(5)
+
+// Set for threads which belong to a pool, so that work they create stays local to them.
+static thread_local streamfx::util::threadpool* local_pool  = nullptr;
+static thread_local std::size_t                 local_index = 0;
+
 streamfx::util::threadpool::threadpool()
-	: _workers(), _worker_stop(false), _worker_idx(0), _tasks(), _tasks_lock(), _tasks_cv()
+	: _workers(), _worker_stop(false), _worker_idx(0), _worker_next(0), _workers_minimum(0), _workers_used(0),
+	  _workers_current(0), _workers_peak(0), _workers_spawned(0), _workers_idle(0), _backlog_since(0), _spawn_lock(),
+	  _pending(), _background_active(0), _background_limit(0), _sleep_lock(), _sleep_cv(), _watchdog(),
+	  _watchdog_lock(), _watchdog_cv(), _history()
 {
 	std::size_t concurrency = static_cast<size_t>(std::thread::hardware_concurrency() * ST_CONCURRENCY_MULTIPLIER);
+	concurrency             = std::max<size_t>(concurrency, 2);
+	for (auto& pending : _pending) {
+		pending.store(0);
+	}
+	for (std::size_t lane = 0; lane < lanes; lane++) {
+		_profiler_wait[lane]    = streamfx::util::profiler::create();
+		_profiler_execute[lane] = streamfx::util::profiler::create();
+	}
+
+	// Always keep some workers free for anything that isn't background work.
+	_background_limit = std::max<size_t>(concurrency / 2, 1);
+
+	// Create all slots up front, as every worker may steal from any other and the list must never change.
+	_workers.reserve(concurrency);
 	for (std::size_t n = 0; n < concurrency; n++) {
-		_workers.emplace_back(std::bind(&streamfx::util::threadpool::work, this));
+		_workers.emplace_back(std::make_unique<worker>());
+		_workers.back()->active.store(false);
 	}
+
+	// Start small, anything more is created once there is a backlog.
+	_workers_minimum = std::min<size_t>(ST_WORKERS_MINIMUM, concurrency);
+	for (std::size_t n = 0; n < _workers_minimum; n++) {
+		spawn();
+	}
+
+	_watchdog = std::thread(std::bind(&streamfx::util::threadpool::watchdog, this));
 }
 
 streamfx::util::threadpool::~threadpool()
 {
-	_worker_stop = true;
-	_tasks_cv.notify_all();
-	for (auto& thread : _workers) {
-		_tasks_cv.notify_all();
-		if (thread.joinable()) {
-			thread.join();
+	{
+		std::unique_lock<std::mutex> lock(_sleep_lock);
+		_worker_stop = true;
+	}
+	_sleep_cv.notify_all();
+	{
+		std::unique_lock<std::mutex> lock(_watchdog_lock);
+	}
+	_watchdog_cv.notify_all();
+	if (_watchdog.joinable()) {
+		_watchdog.join();
+	}
+
+	// Workers may call spawn() on their way out, which needs the lock, so join them only after letting go of it.
+	std::vector<std::thread> threads;
+	{
+		std::unique_lock<std::mutex> lock(_spawn_lock);
+		for (auto& worker : _workers) {
+			if (worker->thread.joinable()) {
+				threads.push_back(std::move(worker->thread));
+			}
 		}
 	}
-}
+	for (auto& thread : threads) {
+		thread.join();
+	}
 
-std::shared_ptr<::streamfx::util::threadpool::task> streamfx::util::threadpool::push(threadpool_callback_t fn,
-																					 threadpool_data_t     data)
-{
-	auto task = std::make_shared<streamfx::util::threadpool::task>(fn, data);
+	D_LOG_DEBUG("Spawned %" PRIuPTR " workers in total, with up to %" PRIuPTR " running at once.",
+				_workers_spawned.load(), _workers_peak.load());
 
-	// Append the task to the queue.
-	std::unique_lock<std::mutex> lock(_tasks_lock);
-	_tasks.emplace_back(task);
-	_tasks_cv.notify_one();
+	// Profiling
+	static constexpr const char* names[lanes] = {"Realtime", "Normal  ", "Backgrnd"};
+	D_LOG_INFO("Timings          | Avg. µs       | 99.9ile µs    | 99.0ile µs    | 95.0ile µs    | Samples  ", "");
+	D_LOG_INFO("-----------------+---------------+---------------+---------------+---------------+----------", "");
+	for (std::size_t lane = 0; lane < lanes; lane++) {
+		auto profilers = {std::make_pair("Wait   ", _profiler_wait[lane]),
+						  std::make_pair("Execute", _profiler_execute[lane])};
+		for (auto& kv : profilers) {
+			if (kv.second->count() == 0) {
+				continue;
+			}
+			auto snap = kv.second->capture();
+			D_LOG_INFO("%s %s | %13.1f | %13" PRId64 " | %13" PRId64 " | %13" PRId64 " | %9" PRIu64, names[lane],
+					   kv.first, snap.average_duration() / 1000.,
+					   std::chrono::duration_cast<std::chrono::microseconds>(snap.percentile(0.999)).count(),
+					   std::chrono::duration_cast<std::chrono::microseconds>(snap.percentile(0.990)).count(),
+					   std::chrono::duration_cast<std::chrono::microseconds>(snap.percentile(0.950)).count(),
+					   snap.count());
+		}
+	}
+}
 
+std::shared_ptr<::streamfx::util::threadpool::task>
+	streamfx::util::threadpool::push(threadpool_callback_t fn, threadpool_data_t data, threadpool_priority priority)
+{
+	auto task = std::allocate_shared<streamfx::util::threadpool::task>(
+		streamfx::util::memory::pool_allocator<streamfx::util::threadpool::task>(), fn, data, priority);
+	enqueue(task);
 	return task;
 }
 
 void streamfx::util::threadpool::pop(std::shared_ptr<::streamfx::util::threadpool::task> work)
 {
-	if (work) {
+	if (!work) {
+		return;
+	}
+
+	// Running tasks only see the token, queued ones are never started.
+	work->_token.cancel();
+
+	uint8_t expected = task::QUEUED;
+	if (work->_status.compare_exchange_strong(expected, task::DONE)) {
+		if (work->_abandon) {
+			work->_abandon();
+		}
 		{
 			std::unique_lock<std::mutex> lock(work->_mutex);
-			work->_is_dead = true;
 		}
 		work->_is_complete.notify_all();
 	}
 }
 
-void streamfx::util::threadpool::work()
+void streamfx::util::threadpool::parallel_for(std::size_t begin, std::size_t end,
+											  std::function<void(std::size_t, std::size_t)> fn, std::size_t grain)
 {
-	std::shared_ptr<streamfx::util::threadpool::task> local_work{};
-	uint32_t                                          local_number = _worker_idx.fetch_add(1);
+	if (end <= begin) {
+		return;
+	}
 
-	while (!_worker_stop) {
-		// Wait for more work, or immediately continue if there is still work to do.
-		{
-			// Lock the tasks mutex to check for work.
-			std::unique_lock<std::mutex> lock(_tasks_lock);
+	// More ranges than workers only adds overhead.
+	grain              = std::max<size_t>(grain, 1);
+	std::size_t ranges = std::min<size_t>((end - begin + grain - 1) / grain, _workers.size());
+	std::size_t step   = (end - begin + ranges - 1) / ranges;
+	ranges             = (end - begin + step - 1) / step;
+
+	struct state {
+		std::atomic<std::size_t> next;
+		std::atomic<std::size_t> done;
+		std::mutex               lock;
+		std::condition_variable  cv;
+		std::exception_ptr       error;
+	};
+	auto status = std::make_shared<state>();
+	status->next.store(0);
+	status->done.store(0);
+
+	auto run = [status, begin, end, step, ranges, fn]() {
+		for (std::size_t idx = status->next.fetch_add(1); idx < ranges; idx = status->next.fetch_add(1)) {
+			std::size_t range_begin = begin + idx * step;
+			std::size_t range_end   = std::min<size_t>(range_begin + step, end);
 
-			// If there are currently no tasks queued, wait on the condition variable.
-			// This temporarily unlocks the mutex until it is woken up.
-			if (_tasks.size() == 0) {
-				_tasks_cv.wait(lock, [this]() { return _worker_stop || _tasks.size() > 0; });
+			try {
+				fn(range_begin, range_end);
+			} catch (...) {
+				std::unique_lock<std::mutex> lock(status->lock);
+				if (!status->error) {
+					status->error = std::current_exception();
+				}
 			}
 
-			// If there is either no tasks or we were asked to stop, skip everything.
-			if (_worker_stop || (_tasks.size() == 0)) {
-				continue;
+			if ((status->done.fetch_add(1) + 1) == ranges) {
+				std::unique_lock<std::mutex> lock(status->lock);
+				status->cv.notify_all();
 			}
+		}
+	};
+
+	// Helpers that start late simply find nothing left to do.
+	for (std::size_t n = 1; n < ranges; n++) {
+		push([run](threadpool_data_t) { run(); }, nullptr, threadpool_priority::REALTIME);
+	}
+	run();
+
+	{
+		std::unique_lock<std::mutex> lock(status->lock);
+		status->cv.wait(lock, [&status, ranges]() { return status->done.load() == ranges; });
+	}
+	if (status->error) {
+		std::rethrow_exception(status->error);
+	}
+}
+
+std::size_t streamfx::util::threadpool::concurrency()
+{
+	return _workers.size();
+}
+
+std::size_t streamfx::util::threadpool::workers_current()
+{
+	return _workers_current.load();
+}
+
+std::size_t streamfx::util::threadpool::workers_peak()
+{
+	return _workers_peak.load();
+}
+
+std::size_t streamfx::util::threadpool::workers_spawned()
+{
+	return _workers_spawned.load();
+}
 
-			// Grab the latest task and immediately remove it from the queue.
-			local_work = _tasks.front();
-			_tasks.pop_front();
+std::vector<streamfx::util::threadpool::queue_sample> streamfx::util::threadpool::queue_history()
+{
+	std::unique_lock<std::mutex> lock(_watchdog_lock);
+	return std::vector<queue_sample>(_history.begin(), _history.end());
+}
+
+std::shared_ptr<streamfx::util::profiler> streamfx::util::threadpool::wait_profiler(threadpool_priority priority)
+{
+	return _profiler_wait[static_cast<size_t>(priority)];
+}
+
+std::shared_ptr<streamfx::util::profiler> streamfx::util::threadpool::execute_profiler(threadpool_priority priority)
+{
+	return _profiler_execute[static_cast<size_t>(priority)];
+}
+
+void streamfx::util::threadpool::enqueue(std::shared_ptr<::streamfx::util::threadpool::task> task)
+{
+	std::size_t lane = static_cast<size_t>(task->_priority);
+
+	// Workers keep what they create, everyone else spreads their tasks out. Idle workers steal either way.
+	std::size_t index = 0;
+	if (local_pool == this) {
+		index = local_index;
+	} else {
+		index = _worker_next.fetch_add(1) % std::max<size_t>(_workers_used.load(), 1);
+	}
+
+	// Count the task before it is visible, so that the counter never drops below the actual amount.
+	task->_enqueued = std::chrono::steady_clock::now();
+	_pending[lane].fetch_add(1);
+	{
+		auto&                        worker = *_workers[index];
+		std::unique_lock<std::mutex> lock(worker.lock);
+		worker.queues[lane].push_back(task);
+	}
+
+	// Wake up a sleeping worker. If there is none, the backlog is noticed by the workers or the watchdog instead, as
+	// creating a thread here would stall whoever is pushing.
+	{
+		std::unique_lock<std::mutex> lock(_sleep_lock);
+	}
+	_sleep_cv.notify_one();
+}
+
+void streamfx::util::threadpool::spawn()
+{
+	// Never wait for the lock during shutdown, the destructor may be holding it.
+	if (_worker_stop) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(_spawn_lock);
+	if (_worker_stop) {
+		return;
+	}
+
+	// Prefer the lowest free slot, which keeps the range that has to be searched for work small.
+	for (std::size_t idx = 0, edx = _workers.size(); idx < edx; idx++) {
+		auto& worker = *_workers[idx];
+		if (worker.active.load()) {
+			continue;
 		}
 
-		// If the task was killed, skip everything again.
-		if (local_work->_is_dead.load()) {
+		// A retired worker may still be on its way out.
+		if (worker.thread.joinable()) {
+			worker.thread.join();
+		}
+
+		worker.active.store(true);
+		std::size_t current = _workers_current.fetch_add(1) + 1;
+		std::size_t peak    = _workers_peak.load();
+		while ((peak < current) && !_workers_peak.compare_exchange_weak(peak, current)) {
+		}
+		if (_workers_used.load() <= idx) {
+			_workers_used.store(idx + 1);
+		}
+		_workers_spawned.fetch_add(1);
+
+		worker.thread = std::thread(std::bind(&streamfx::util::threadpool::work, this, idx));
+		return;
+	}
+}
+
+void streamfx::util::threadpool::grow(std::chrono::steady_clock::time_point now)
+{
+	if ((_workers_idle.load() > 0) || (_workers_current.load() >= _workers.size()) || !has_work()) {
+		_backlog_since.store(0);
+		return;
+	}
+
+	// Short bursts are absorbed by the existing workers, so only a backlog that persists adds one. Unneeded workers
+	// time out again on their own.
+	int64_t ticks = now.time_since_epoch().count();
+	int64_t since = 0;
+	if (_backlog_since.compare_exchange_strong(since, ticks)) {
+		return;
+	}
+	if ((now - std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(since)))
+		< ST_WORKER_GROW_DELAY) {
+		return;
+	}
+	if (_backlog_since.compare_exchange_strong(since, ticks)) {
+		spawn();
+	}
+}
+
+bool streamfx::util::threadpool::has_work()
+{
+	return (_pending[static_cast<size_t>(threadpool_priority::REALTIME)].load() > 0)
+		   || (_pending[static_cast<size_t>(threadpool_priority::NORMAL)].load() > 0)
+		   || ((_pending[static_cast<size_t>(threadpool_priority::BACKGROUND)].load() > 0)
+			   && (_background_active.load() < _background_limit));
+}
+
+std::shared_ptr<::streamfx::util::threadpool::task> streamfx::util::threadpool::acquire(std::size_t index)
+{
+	constexpr std::size_t background = static_cast<size_t>(threadpool_priority::BACKGROUND);
+
+	for (std::size_t lane = 0; lane < lanes; lane++) {
+		if (_pending[lane].load() == 0) {
 			continue;
 		}
 
+		// Reserve a background slot up front, so that we can never exceed the limit.
+		if (lane == background) {
+			std::size_t active = _background_active.load();
+			do {
+				if (active >= _background_limit) {
+					break;
+				}
+			} while (!_background_active.compare_exchange_weak(active, active + 1));
+			if (active >= _background_limit) {
+				continue;
+			}
+		}
+
+		// Check our own queue first, then steal from everyone else.
+		for (std::size_t n = 0, edx = _workers_used.load(); n < edx; n++) {
+			auto&                        worker = *_workers[(index + n) % edx];
+			std::unique_lock<std::mutex> lock(worker.lock);
+			if (!worker.queues[lane].empty()) {
+				auto task = std::move(worker.queues[lane].front());
+				worker.queues[lane].pop_front();
+				_pending[lane].fetch_sub(1);
+				return task;
+			}
+		}
+
+		if (lane == background) {
+			_background_active.fetch_sub(1);
+		}
+	}
+
+	return nullptr;
+}
+
+void streamfx::util::threadpool::execute(std::shared_ptr<::streamfx::util::threadpool::task>& local_work,
+										 std::size_t local_index, uint32_t local_number)
+{
+	// Claim the task, if it was popped in the meantime there is nothing left to do.
+	uint8_t expected = task::QUEUED;
+	if (!local_work->_status.compare_exchange_strong(expected, task::RUNNING)) {
+		return;
+	}
+
+	// Let the watchdog know what we are up to.
+	auto& worker = *_workers[local_index];
+	auto  start  = std::chrono::steady_clock::now();
+	{
+		std::unique_lock<std::mutex> lock(worker.lock);
+		worker.running = local_work;
+		worker.started = start;
+	}
+	_profiler_wait[static_cast<size_t>(local_work->_priority)]->track(start - local_work->_enqueued);
+
+	if (local_work->_token.is_cancelled()) {
+		// Cancelled before it could start, so let anyone waiting on a result know.
+		if (local_work->_abandon) {
+			local_work->_abandon();
+		}
+	} else if (local_work->_callback) {
 		// Try to execute work, but don't crash on catchable exceptions.
-		if (local_work->_callback) {
-			try {
-				local_work->_callback(local_work->_data);
-			} catch (std::exception const& ex) {
-				D_LOG_WARNING("Worker %" PRIx32 " caught exception from task (%" PRIxPTR ", %" PRIxPTR
-							  ") with message: %s",
-							  local_number, reinterpret_cast<ptrdiff_t>(local_work->_callback.target<void>()),
-							  reinterpret_cast<ptrdiff_t>(local_work->_data.get()), ex.what());
-			} catch (...) {
-				D_LOG_WARNING("Worker %" PRIx32 " caught exception of unknown type from task (%" PRIxPTR ", %" PRIxPTR
-							  ").",
-							  local_number, reinterpret_cast<ptrdiff_t>(local_work->_callback.target<void>()),
-							  reinterpret_cast<ptrdiff_t>(local_work->_data.get()));
+		try {
+#ifdef ENABLE_PROFILING
+			streamfx::util::tracer::span trace{"Task"};
+#endif
+			local_work->_callback(local_work->_data);
+		} catch (std::exception const& ex) {
+			D_LOG_WARNING("Worker %" PRIx32 " caught exception from task (%" PRIxPTR ", %" PRIxPTR
+						  ") with message: %s",
+						  local_number, reinterpret_cast<ptrdiff_t>(local_work->_callback.target<void>()),
+						  reinterpret_cast<ptrdiff_t>(local_work->_data.get()), ex.what());
+		} catch (...) {
+			D_LOG_WARNING("Worker %" PRIx32 " caught exception of unknown type from task (%" PRIxPTR ", %" PRIxPTR
+						  ").",
+						  local_number, reinterpret_cast<ptrdiff_t>(local_work->_callback.target<void>()),
+						  reinterpret_cast<ptrdiff_t>(local_work->_data.get()));
+		}
+	}
+
+	auto end      = std::chrono::steady_clock::now();
+	bool reported = false;
+	{
+		std::unique_lock<std::mutex> lock(worker.lock);
+		worker.running.reset();
+		reported = local_work->_reported;
+	}
+	_profiler_execute[static_cast<size_t>(local_work->_priority)]->track(end - start);
+	if (reported) {
+		D_LOG_INFO("Task '%s' on worker %" PRIx32 " finished after %" PRId64 " ms.",
+				   streamfx::util::platform::type_name(local_work->_callback.target_type()).c_str(), local_number,
+				   std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(local_work->_mutex);
+		local_work->_status.store(task::DONE);
+	}
+	local_work->_is_complete.notify_all();
+}
+
+void streamfx::util::threadpool::work(std::size_t index)
+{
+	std::shared_ptr<streamfx::util::threadpool::task> local_work{};
+	uint32_t                                          local_number = _worker_idx.fetch_add(1);
+
+	local_pool  = this;
+	local_index = index;
+
+#ifdef ENABLE_PROFILING
+	{
+		std::string name = "StreamFX Worker " + std::to_string(index);
+		streamfx::util::tracer::name_thread(name.c_str());
+	}
+#endif
+
+	while (!_worker_stop) {
+		local_work = acquire(index);
+		if (!local_work) {
+			// Sleep until there is something we are allowed to pick up.
+			std::unique_lock<std::mutex> lock(_sleep_lock);
+			_workers_idle.fetch_add(1);
+			bool woken =
+				_sleep_cv.wait_for(lock, ST_WORKER_IDLE_TIMEOUT, [this]() { return _worker_stop || has_work(); });
+			_workers_idle.fetch_sub(1);
+
+			// Retire if there was nothing to do for a while, unless that would leave too few workers.
+			if (!woken) {
+				std::size_t current = _workers_current.load();
+				while ((current > _workers_minimum)
+					   && !_workers_current.compare_exchange_weak(current, current - 1)) {
+				}
+				if (current > _workers_minimum) {
+					break;
+				}
 			}
+			continue;
+		}
+
+		// Keep adding workers for as long as tasks pile up faster than they are picked up.
+		grow(std::chrono::steady_clock::now());
+
+		execute(local_work, index, local_number);
+
+		if (local_work->_priority == threadpool_priority::BACKGROUND) {
+			// Free up the slot, and wake up anyone who was waiting for it.
 			{
-				std::unique_lock<std::mutex> lock(local_work->_mutex);
-				local_work->_is_dead.store(true);
+				std::unique_lock<std::mutex> lock(_sleep_lock);
+				_background_active.fetch_sub(1);
 			}
-			local_work->_is_complete.notify_all();
+			_sleep_cv.notify_one();
 		}
 
 		// Remove our reference to the work unit.
 		local_work.reset();
 	}
 
+	local_pool = nullptr;
 	_worker_idx.fetch_sub(1);
+
+	// Anything left in our queues is still found by the others, so the slot can be handed out again right away.
+	_workers[index]->active.store(false);
 }
 
-streamfx::util::threadpool::task::task() {}
+void streamfx::util::threadpool::watchdog()
+{
+	std::unique_lock<std::mutex> lock(_watchdog_lock);
+	while (!_worker_stop) {
+		_watchdog_cv.wait_for(lock, ST_WATCHDOG_INTERVAL, [this]() { return _worker_stop.load(); });
+		auto now = std::chrono::steady_clock::now();
+
+		// Workers only notice a backlog between tasks, which takes a while if all of them run long tasks.
+		grow(now);
+
+		{ // Record the queue depth.
+			queue_sample sample;
+			sample.time = now;
+			for (std::size_t lane = 0; lane < lanes; lane++) {
+				sample.queued[lane] = _pending[lane].load();
+			}
+			sample.workers = _workers_current.load();
 
-streamfx::util::threadpool::task::task(threadpool_callback_t fn, threadpool_data_t dt)
-	: _mutex(), _is_complete(), _is_dead(false), _callback(fn), _data(dt)
+			_history.push_back(sample);
+			while (_history.size() > ST_WATCHDOG_HISTORY) {
+				_history.pop_front();
+			}
+		}
+
+		// Report tasks that have been running for too long, but only once each.
+		for (std::size_t idx = 0, edx = _workers_used.load(); idx < edx; idx++) {
+			auto&                                             worker = *_workers[idx];
+			std::shared_ptr<streamfx::util::threadpool::task> stuck;
+			std::chrono::nanoseconds                          duration;
+			{
+				std::unique_lock<std::mutex> wlock(worker.lock);
+				if (!worker.running || worker.running->_reported || ((now - worker.started) < ST_WATCHDOG_THRESHOLD)) {
+					continue;
+				}
+				worker.running->_reported = true;
+				stuck                     = worker.running;
+				duration                  = now - worker.started;
+			}
+
+			D_LOG_WARNING("Task '%s' has been running for %" PRId64 " ms on worker slot %" PRIuPTR
+						  " and may be stuck. %" PRIuPTR " tasks are waiting.",
+						  streamfx::util::platform::type_name(stuck->_callback.target_type()).c_str(),
+						  std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(), idx,
+						  _pending[0].load() + _pending[1].load() + _pending[2].load());
+		}
+	}
+}
+
+streamfx::util::threadpool::task::task() : _status(QUEUED), _priority(threadpool_priority::NORMAL), _reported(false) {}
+
+streamfx::util::threadpool::task::task(threadpool_callback_t fn, threadpool_data_t dt, threadpool_priority priority)
+	: _mutex(), _is_complete(), _status(QUEUED), _callback(fn), _data(dt), _priority(priority), _token(), _abandon(),
+	  _enqueued(), _reported(false)
 {}
 
 void streamfx::util::threadpool::task::await_completion()
 {
-	if (!_is_dead) {
+	if (_status.load() != DONE) {
 		std::unique_lock<std::mutex> lock(_mutex);
-		_is_complete.wait(lock, [this]() { return this->_is_dead.load(); });
+		_is_complete.wait(lock, [this]() { return this->_status.load() == DONE; });
 	}
 }
+
+streamfx::util::threadpool::cancellation_token::cancellation_token()
+	: _cancelled(
+		std::allocate_shared<std::atomic<bool>>(streamfx::util::memory::pool_allocator<std::atomic<bool>>(), false))
+{}
+
+void streamfx::util::threadpool::cancellation_token::cancel()
+{
+	_cancelled->store(true);
+}
+
+bool streamfx::util::threadpool::cancellation_token::is_cancelled() const
+{
+	return _cancelled->load();
+}
+
+streamfx::util::threadpool::future_state_base::future_state_base(cancellation_token token)
+	: lock(), cv(), ready(false), error(), token(token), continuations()
+{}
+
+void streamfx::util::threadpool::future_state_base::complete()
+{
+	std::vector<std::function<void()>> pending;
+	{
+		std::unique_lock<std::mutex> lk(lock);
+		ready = true;
+		pending.swap(continuations);
+	}
+	cv.notify_all();
+
+	// Continuations only schedule more work, so running them here is cheap.
+	for (auto& fn : pending) {
+		fn();
+	}
+}
+
+void streamfx::util::threadpool::future_state_base::abandon()
+{
+	error = std::make_exception_ptr(cancelled());
+	complete();
+}
+
+void streamfx::util::threadpool::future_state_base::on_complete(std::function<void()> fn)
+{
+	{
+		std::unique_lock<std::mutex> lk(lock);
+		if (!ready) {
+			continuations.push_back(std::move(fn));
+			return;
+		}
+	}
+	fn();
+}
+
+void streamfx::util::threadpool::future_state_base::wait()
+{
+	std::unique_lock<std::mutex> lk(lock);
+	cv.wait(lk, [this]() { return ready; });
+}
@@ -18,56 +18,337 @@
  */
 
 #pragma once
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <thread>
+#include <type_traits>
+#include <vector>
+#include "util-memory.hpp"
 
 namespace streamfx::util {
+	class profiler;
+
 	typedef std::shared_ptr<void>                  threadpool_data_t;
 	typedef std::function<void(threadpool_data_t)> threadpool_callback_t;
 
+	/** Scheduling lanes, higher lanes are always drained before lower ones.
+	 *
+	 * REALTIME is meant for short hand-offs which something is actively waiting on, like audio and video data.
+	 * BACKGROUND is meant for slow work such as file or network IO, and is never allowed to occupy every worker.
+	 */
+	enum class threadpool_priority : uint8_t {
+		REALTIME   = 0,
+		NORMAL     = 1,
+		BACKGROUND = 2,
+	};
+
 	class threadpool {
 		public:
+		/** Shared flag that long running tasks poll to find out if they should give up early. */
+		class cancellation_token {
+			std::shared_ptr<std::atomic<bool>> _cancelled;
+
+			public:
+			cancellation_token();
+
+			void cancel();
+
+			bool is_cancelled() const;
+		};
+
+		/** Reported through future::get() for tasks that were cancelled before they started. */
+		class cancelled : public std::runtime_error {
+			public:
+			cancelled() : std::runtime_error("Task was cancelled.") {}
+		};
+
 		class task {
+			enum : uint8_t {
+				QUEUED,
+				RUNNING,
+				DONE,
+			};
+
 			protected:
 			std::mutex              _mutex;
 			std::condition_variable _is_complete;
-			std::atomic<bool>       _is_dead;
+			std::atomic<uint8_t>    _status;
 			threadpool_callback_t   _callback;
 			threadpool_data_t       _data;
+			threadpool_priority     _priority;
+			cancellation_token      _token;
+			std::function<void()>   _abandon;
+
+			std::chrono::steady_clock::time_point _enqueued;
+			bool                                  _reported;
 
 			public:
 			task();
-			task(threadpool_callback_t callback_function, threadpool_data_t data);
+			task(threadpool_callback_t callback_function, threadpool_data_t data, threadpool_priority priority);
 
 			void await_completion();
 
 			friend class streamfx::util::threadpool;
 		};
 
+		struct future_state_base {
+			std::mutex                         lock;
+			std::condition_variable            cv;
+			bool                               ready;
+			std::exception_ptr                 error;
+			cancellation_token                 token;
+			std::vector<std::function<void()>> continuations;
+
+			future_state_base(cancellation_token token);
+
+			void complete();
+
+			void abandon();
+
+			void on_complete(std::function<void()> fn);
+
+			void wait();
+		};
+
+		template<typename T>
+		struct future_state : public future_state_base {
+			std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+
+			future_state(cancellation_token token) : future_state_base(token), value() {}
+
+			template<typename _fn>
+			void run(_fn& fn)
+			{
+				try {
+					if constexpr (std::is_void_v<T>) {
+						fn(token);
+						value.emplace(true);
+					} else {
+						value.emplace(fn(token));
+					}
+				} catch (...) {
+					error = std::current_exception();
+				}
+				complete();
+			}
+		};
+
+		template<typename T>
+		class future {
+			threadpool*                      _pool;
+			std::shared_ptr<future_state<T>> _state;
+			std::shared_ptr<task>            _task;
+
+			public:
+			future() : _pool(nullptr), _state(), _task() {}
+			future(threadpool* pool, std::shared_ptr<future_state<T>> state, std::shared_ptr<task> task)
+				: _pool(pool), _state(state), _task(task)
+			{}
+
+			bool valid() const
+			{
+				return !!_state;
+			}
+
+			bool is_ready() const
+			{
+				std::unique_lock<std::mutex> lock(_state->lock);
+				return _state->ready;
+			}
+
+			void wait() const
+			{
+				_state->wait();
+			}
+
+			/** Wait for the result, rethrowing anything the task threw. */
+			T get() const
+			{
+				_state->wait();
+				if (_state->error) {
+					std::rethrow_exception(_state->error);
+				}
+				if constexpr (!std::is_void_v<T>) {
+					return *_state->value;
+				}
+			}
+
+			/** Ask the task and all of its continuations to stop.
+			 *
+			 * Tasks that have not started yet are dropped, running tasks have to check their token.
+			 */
+			void cancel()
+			{
+				_state->token.cancel();
+				if (_task) {
+					_pool->pop(_task);
+				}
+			}
+
+			cancellation_token token() const
+			{
+				return _state->token;
+			}
+
+			/** Run 'fn' with this future once it is ready, sharing its cancellation token. */
+			template<typename _fn>
+			auto then(_fn fn, threadpool_priority priority = threadpool_priority::NORMAL)
+				-> future<std::invoke_result_t<_fn, future<T>>>
+			{
+				typedef std::invoke_result_t<_fn, future<T>> result_t;
+
+				auto child = std::allocate_shared<future_state<result_t>>(
+					memory::pool_allocator<future_state<result_t>>(), _state->token);
+				auto pool = _pool;
+				auto self = *this;
+				_state->on_complete([pool, child, self, fn, priority]() {
+					pool->schedule(
+						child, [self, fn](cancellation_token const&) mutable { return fn(self); }, priority);
+				});
+
+				return future<result_t>(_pool, child, nullptr);
+			}
+		};
+
+		/** Snapshot of the queues, taken a few times per second. */
+		struct queue_sample {
+			std::chrono::steady_clock::time_point time;
+			std::size_t                           queued[3]; // By threadpool_priority.
+			std::size_t                           workers;
+		};
+
 		private:
-		std::list<std::thread>                                         _workers;
-		std::atomic<bool>                                              _worker_stop;
-		std::atomic<uint32_t>                                          _worker_idx;
-		std::list<std::shared_ptr<::streamfx::util::threadpool::task>> _tasks;
-		std::mutex                                                     _tasks_lock;
-		std::condition_variable                                        _tasks_cv;
+		static constexpr std::size_t lanes = 3;
+
+		struct worker {
+			std::thread                                                     thread;
+			std::atomic<bool>                                               active;
+			std::mutex                                                      lock;
+			std::deque<std::shared_ptr<::streamfx::util::threadpool::task>> queues[lanes];
+
+			// What the worker is busy with right now, for the watchdog.
+			std::shared_ptr<::streamfx::util::threadpool::task> running;
+			std::chrono::steady_clock::time_point               started;
+		};
+
+		// Slots for the maximum amount of workers, only some of which have a running thread at any time.
+		std::vector<std::unique_ptr<worker>> _workers;
+		std::atomic<bool>                    _worker_stop;
+		std::atomic<uint32_t>                _worker_idx;
+		std::atomic<uint32_t>                _worker_next;
+		std::size_t                          _workers_minimum;
+		std::atomic<std::size_t>             _workers_used;
+		std::atomic<std::size_t>             _workers_current;
+		std::atomic<std::size_t>             _workers_peak;
+		std::atomic<std::size_t>             _workers_spawned;
+		std::atomic<std::size_t>             _workers_idle;
+		std::atomic<int64_t>                 _backlog_since;
+		std::mutex                           _spawn_lock;
+		std::atomic<std::size_t>             _pending[lanes];
+		std::atomic<std::size_t>             _background_active;
+		std::size_t                          _background_limit;
+		std::mutex                           _sleep_lock;
+		std::condition_variable              _sleep_cv;
+
+		std::thread              _watchdog;
+		std::mutex               _watchdog_lock;
+		std::condition_variable  _watchdog_cv;
+		std::deque<queue_sample> _history;
+
+		std::shared_ptr<::streamfx::util::profiler> _profiler_wait[lanes];
+		std::shared_ptr<::streamfx::util::profiler> _profiler_execute[lanes];
 
 		public:
 		threadpool();
 		~threadpool();
 
-		std::shared_ptr<::streamfx::util::threadpool::task> push(threadpool_callback_t callback_function,
-																 threadpool_data_t     data);
+		std::shared_ptr<::streamfx::util::threadpool::task>
+			push(threadpool_callback_t callback_function, threadpool_data_t data,
+				 threadpool_priority priority = threadpool_priority::NORMAL);
 
 		void pop(std::shared_ptr<::streamfx::util::threadpool::task> work);
 
+		/** Run 'fn(token)' on the pool and return a future for its result. */
+		template<typename _fn>
+		auto submit(_fn fn, threadpool_priority priority = threadpool_priority::NORMAL)
+			-> future<std::invoke_result_t<_fn, cancellation_token const&>>
+		{
+			typedef std::invoke_result_t<_fn, cancellation_token const&> result_t;
+
+			auto state = std::allocate_shared<future_state<result_t>>(memory::pool_allocator<future_state<result_t>>(),
+																	  cancellation_token());
+			auto work  = schedule(state, std::move(fn), priority);
+			return future<result_t>(this, state, work);
+		}
+
+		/** Split [begin, end) into ranges of at least 'grain' elements and run them on the pool.
+		 *
+		 * The calling thread takes part in the work and only returns once every range is done, so this is safe to
+		 * call from inside a task. The first exception thrown by 'fn' is rethrown here.
+		 */
+		void parallel_for(std::size_t begin, std::size_t end, std::function<void(std::size_t, std::size_t)> fn,
+						  std::size_t grain = 1);
+
+		/** Maximum amount of workers the pool will grow to. */
+		std::size_t concurrency();
+
+		/** Amount of workers which currently have a thread. */
+		std::size_t workers_current();
+
+		/** Highest amount of workers which had a thread at the same time. */
+		std::size_t workers_peak();
+
+		/** Amount of worker threads created over the lifetime of the pool. */
+		std::size_t workers_spawned();
+
+		/** Queue depth over the last minute, oldest first. */
+		std::vector<queue_sample> queue_history();
+
+		/** Time from push() to the start of execution, for tasks of the given priority. */
+		std::shared_ptr<::streamfx::util::profiler> wait_profiler(threadpool_priority priority);
+
+		/** Time spent executing tasks of the given priority. */
+		std::shared_ptr<::streamfx::util::profiler> execute_profiler(threadpool_priority priority);
+
 		private:
-		void work();
+		template<typename T, typename _fn>
+		std::shared_ptr<task> schedule(std::shared_ptr<future_state<T>> state, _fn fn, threadpool_priority priority)
+		{
+			auto work = std::allocate_shared<task>(
+				memory::pool_allocator<task>(), [state, fn](threadpool_data_t) mutable { state->run(fn); }, nullptr,
+				priority);
+			work->_token   = state->token;
+			work->_abandon = [state]() { state->abandon(); };
+			enqueue(work);
+			return work;
+		}
+
+		void enqueue(std::shared_ptr<::streamfx::util::threadpool::task> work);
+
+		void spawn();
+
+		/** Add a worker if every worker has been busy with more work waiting for a while. */
+		void grow(std::chrono::steady_clock::time_point now);
+
+		void work(std::size_t index);
+
+		bool has_work();
+
+		std::shared_ptr<::streamfx::util::threadpool::task> acquire(std::size_t index);
+
+		void execute(std::shared_ptr<::streamfx::util::threadpool::task>& work, std::size_t index, uint32_t number);
+
+		void watchdog();
 	};
 } // namespace streamfx::util
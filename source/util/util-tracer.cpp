@@ -0,0 +1,279 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "util-tracer.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include "util/util-logging.hpp"
+
+#ifdef _DEBUG
+#define ST_PREFIX "<%s> "
+#define D_LOG_ERROR(x, ...) P_LOG_ERROR(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_WARNING(x, ...) P_LOG_WARN(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_INFO(x, ...) P_LOG_INFO(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#define D_LOG_DEBUG(x, ...) P_LOG_DEBUG(ST_PREFIX##x, __FUNCTION_SIG__, __VA_ARGS__)
+#else
+#define ST_PREFIX "<util::tracer> "
+#define D_LOG_ERROR(...) P_LOG_ERROR(ST_PREFIX __VA_ARGS__)
+#define D_LOG_WARNING(...) P_LOG_WARN(ST_PREFIX __VA_ARGS__)
+#define D_LOG_INFO(...) P_LOG_INFO(ST_PREFIX __VA_ARGS__)
+#define D_LOG_DEBUG(...) P_LOG_DEBUG(ST_PREFIX __VA_ARGS__)
+#endif
+
+// Events kept per thread, older ones are overwritten. 64 bytes each.
+#define ST_EVENTS_PER_THREAD 8192
+
+// Maximum nesting of spans, anything deeper is silently dropped.
+#define ST_MAXIMUM_DEPTH 32
+
+#define ST_NAME_LENGTH 40
+
+namespace streamfx::util::tracer {
+	struct event {
+		char     name[ST_NAME_LENGTH];
+		uint64_t start;
+		uint64_t duration;
+		bool     instant;
+	};
+
+	struct thread_buffer {
+		// Only ever contended while flushing.
+		std::mutex         lock;
+		std::vector<event> events;
+		std::size_t        next;
+		std::size_t        used;
+		uint64_t           generation;
+		uint32_t           id;
+		std::string        name;
+
+		// Open spans, only touched by the owning thread.
+		std::size_t depth;
+		event       stack[ST_MAXIMUM_DEPTH];
+	};
+
+	static std::atomic<bool>                           _enabled{false};
+	static std::atomic<uint64_t>                       _generation{0};
+	static std::chrono::steady_clock::time_point       _epoch = std::chrono::steady_clock::now();
+	static std::mutex                                  _buffers_lock;
+	static std::vector<std::shared_ptr<thread_buffer>> _buffers;
+	static std::atomic<uint32_t>                       _next_id{1};
+	static thread_local std::shared_ptr<thread_buffer> _local;
+	static thread_local std::string                    _local_name;
+
+	static inline uint64_t now()
+	{
+		return static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count());
+	}
+
+	static inline void copy_name(char (&target)[ST_NAME_LENGTH], const char* name)
+	{
+		std::size_t idx = 0;
+		for (; name && name[idx] && (idx < (ST_NAME_LENGTH - 1)); idx++) {
+			target[idx] = name[idx];
+		}
+		target[idx] = 0;
+	}
+
+	static thread_buffer& local_buffer()
+	{
+		if (!_local) {
+			_local = std::make_shared<thread_buffer>();
+			_local->events.resize(ST_EVENTS_PER_THREAD);
+			_local->next       = 0;
+			_local->used       = 0;
+			_local->generation = _generation.load();
+			_local->id         = _next_id.fetch_add(1);
+			_local->depth      = 0;
+			_local->name       = _local_name;
+
+			std::unique_lock<std::mutex> lock(_buffers_lock);
+			_buffers.push_back(_local);
+		}
+
+		// A new recording started since we last looked, so forget the old one.
+		if (uint64_t generation = _generation.load(); _local->generation != generation) {
+			std::unique_lock<std::mutex> lock(_local->lock);
+			_local->next       = 0;
+			_local->used       = 0;
+			_local->depth      = 0;
+			_local->generation = generation;
+		}
+
+		return *_local;
+	}
+
+	static void record(thread_buffer& buffer, event const& ev)
+	{
+		std::unique_lock<std::mutex> lock(buffer.lock);
+		buffer.events[buffer.next] = ev;
+		buffer.next                = (buffer.next + 1) % buffer.events.size();
+		buffer.used                = std::min(buffer.used + 1, buffer.events.size());
+	}
+
+	static void write_escaped(std::ostream& stream, const char* text)
+	{
+		for (; *text; text++) {
+			char chr = *text;
+			if ((chr == '"') || (chr == '\\')) {
+				stream << '\\' << chr;
+			} else if (static_cast<unsigned char>(chr) < 0x20) {
+				stream << ' ';
+			} else {
+				stream << chr;
+			}
+		}
+	}
+} // namespace streamfx::util::tracer
+
+void streamfx::util::tracer::start()
+{
+	_generation.fetch_add(1);
+	{
+		// Drop buffers of threads that no longer exist.
+		std::unique_lock<std::mutex> lock(_buffers_lock);
+		auto is_orphaned = [](std::shared_ptr<thread_buffer> const& buffer) { return buffer.use_count() == 1; };
+		_buffers.erase(std::remove_if(_buffers.begin(), _buffers.end(), is_orphaned), _buffers.end());
+	}
+	_enabled.store(true);
+	D_LOG_INFO("Started recording.", "");
+}
+
+void streamfx::util::tracer::stop()
+{
+	_enabled.store(false);
+	D_LOG_INFO("Stopped recording.", "");
+}
+
+bool streamfx::util::tracer::enabled()
+{
+	return _enabled.load(std::memory_order_relaxed);
+}
+
+void streamfx::util::tracer::begin(const char* name)
+{
+	if (!enabled()) {
+		return;
+	}
+
+	auto& buffer = local_buffer();
+	if (buffer.depth < ST_MAXIMUM_DEPTH) {
+		auto& ev = buffer.stack[buffer.depth];
+		copy_name(ev.name, name);
+		ev.start   = now();
+		ev.instant = false;
+	}
+	buffer.depth++;
+}
+
+void streamfx::util::tracer::end()
+{
+	// Spans opened while not recording have nothing to close.
+	if (!_local || (_local->depth == 0)) {
+		return;
+	}
+
+	auto& buffer = *_local;
+	buffer.depth--;
+	if (!enabled() || (buffer.depth >= ST_MAXIMUM_DEPTH) || (buffer.generation != _generation.load())) {
+		return;
+	}
+
+	auto& ev    = buffer.stack[buffer.depth];
+	ev.duration = now() - ev.start;
+	record(buffer, ev);
+}
+
+void streamfx::util::tracer::instant(const char* name)
+{
+	if (!enabled()) {
+		return;
+	}
+
+	event ev;
+	copy_name(ev.name, name);
+	ev.start    = now();
+	ev.duration = 0;
+	ev.instant  = true;
+	record(local_buffer(), ev);
+}
+
+void streamfx::util::tracer::name_thread(const char* name)
+{
+	// Buffers are only created once something is recorded, so remember the name until then.
+	_local_name = name;
+	if (_local) {
+		std::unique_lock<std::mutex> lock(_local->lock);
+		_local->name = _local_name;
+	}
+}
+
+void streamfx::util::tracer::flush(std::filesystem::path const& path)
+{
+	std::vector<std::shared_ptr<thread_buffer>> buffers;
+	{
+		std::unique_lock<std::mutex> lock(_buffers_lock);
+		buffers = _buffers;
+	}
+
+	std::filesystem::create_directories(path.parent_path());
+	std::ofstream stream(path, std::ios::out | std::ios::trunc);
+	if (!stream.is_open()) {
+		throw std::runtime_error("Failed to open trace file for writing.");
+	}
+
+	std::size_t events     = 0;
+	uint64_t    generation = _generation.load();
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for (auto& buffer : buffers) {
+		std::unique_lock<std::mutex> lock(buffer->lock);
+		if (buffer->generation != generation) {
+			continue;
+		}
+
+		if (!buffer->name.empty()) {
+			stream << (events++ ? ",\n" : "\n") << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+				   << ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+			write_escaped(stream, buffer->name.c_str());
+			stream << "\"}}";
+		}
+
+		// Oldest first, which is what most viewers expect.
+		std::size_t first = (buffer->next + buffer->events.size() - buffer->used) % buffer->events.size();
+		for (std::size_t idx = 0; idx < buffer->used; idx++) {
+			auto& ev = buffer->events[(first + idx) % buffer->events.size()];
+			stream << (events++ ? ",\n" : "\n") << "{\"name\":\"";
+			write_escaped(stream, ev.name);
+			stream << "\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << (ev.start / 1000) << "."
+				   << std::setw(3) << std::setfill('0') << (ev.start % 1000);
+			if (ev.instant) {
+				stream << ",\"ph\":\"i\",\"s\":\"p\"}";
+			} else {
+				stream << ",\"ph\":\"X\",\"dur\":" << (ev.duration / 1000) << "." << std::setw(3)
+					   << std::setfill('0') << (ev.duration % 1000) << "}";
+			}
+		}
+	}
+	stream << "\n]}\n";
+
+	D_LOG_INFO("Wrote %" PRIuPTR " events to '%s'.", events, path.u8string().c_str());
+}
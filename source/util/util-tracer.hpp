@@ -0,0 +1,62 @@
+/*
+ * Modern effects for a modern Streamer
+ * Copyright (C) 2020 Michael Fabian Dirks
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#include "common.hpp"
+#include <filesystem>
+
+namespace streamfx::util::tracer {
+	/** Start recording, discarding anything that was recorded before. */
+	void start();
+
+	/** Stop recording, keeping the recorded events around for flush(). */
+	void stop();
+
+	bool enabled();
+
+	/** Open a span on the current thread, which lasts until the matching end(). */
+	void begin(const char* name);
+
+	void end();
+
+	/** Record a single point in time, like the start of a frame. */
+	void instant(const char* name);
+
+	/** Give the current thread a readable name in the exported trace. */
+	void name_thread(const char* name);
+
+	/** Write all recorded events into a Chrome trace event file.
+	 *
+	 * The format is understood by chrome://tracing, Perfetto and most other timeline viewers.
+	 */
+	void flush(std::filesystem::path const& path);
+
+	class span {
+		public:
+		inline span(const char* name)
+		{
+			begin(name);
+		}
+
+		inline ~span()
+		{
+			end();
+		}
+	};
+} // namespace streamfx::util::tracer